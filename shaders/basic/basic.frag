@@ -71,9 +71,7 @@ void main()
 
 #ifdef HAS_TANGENTS
     if (materials[materialID].hasNormalTex != 0) {
-        vec3 texNormal = texture(uNormalTex, vs_uv).rgb;
-        texNormal.xy = texNormal.xy * 2.0 - 1.0;
-        texNormal = normalize(texNormal);
+        vec3 texNormal = sampleNormalTex(vs_uv);
         //mat3 localToWorld = mat3(vs_tangent, vs_bitangent, vs_normal);
         //normal =  localToWorld * texNormal;
         mat3 localToWorld_T = mat3(
@@ -20,18 +20,11 @@ void main()
 
     outData.materialID = instances[instanceID].materialID;
 
-    uint idx = meshes[meshID].first + gl_VertexID * meshes[meshID].stride;
+    const Vertex vertex = fetchVertex(meshID, gl_VertexID);
 
-    vec3 value;
-    value.x = vertexData[idx++];
-    value.y = vertexData[idx++];
-    value.z = vertexData[idx++];
-
-    gl_Position = modelMatrix * vec4(value, 1.0);
+    gl_Position = modelMatrix * vec4(vertex.position, 1.0);
 
     if ((components & MESH_COMPONENT_TEXCOORD) != 0) {
-        value.x = vertexData[idx++];
-        value.y = vertexData[idx++];
-        outData.uv = value.xy;
+        outData.uv = vertex.uv;
     }
 }
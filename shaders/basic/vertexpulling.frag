@@ -68,9 +68,7 @@ void main()
 
 
     if (materials[materialID].hasNormalTex != 0) {
-        vec3 texNormal = texture(uNormalTex, uv).rgb;
-        texNormal.xy = texNormal.xy * 2.0 - 1.0;
-        texNormal = normalize(texNormal);
+        vec3 texNormal = sampleNormalTex(uv);
 
         mat3 localToWorld_T = mat3(
                 inData.tangent.x, inData.bitangent.x, inData.normal.x,
@@ -26,40 +26,23 @@ void main()
 
     outData.materialID = instances[instanceID].materialID;
 
-    uint idx = meshes[meshID].first + gl_VertexID * meshes[meshID].stride;
+    const Vertex vertex = fetchVertex(meshID, gl_VertexID);
 
-    vec3 value;
-    value.x = vertexData[idx++];
-    value.y = vertexData[idx++];
-    value.z = vertexData[idx++];
-
-    const vec4 worldPos = modelMatrix * vec4(value, 1.0);
+    const vec4 worldPos = modelMatrix * vec4(vertex.position, 1.0);
     outData.wpos = worldPos.xyz;
 
     outData.viewdir = normalize(cam.Position.xyz - worldPos.xyz);
 
     if ((components & MESH_COMPONENT_TEXCOORD) != 0) {
-        value.x = vertexData[idx++];
-        value.y = vertexData[idx++];
-        outData.uv = value.xy;
+        outData.uv = vertex.uv;
     }
     if ((components & MESH_COMPONENT_NORMAL) != 0) {
-        value.x = vertexData[idx++];
-        value.y = vertexData[idx++];
-        value.z = vertexData[idx++];
-        outData.normal = normalize((modelMatrix * vec4(value, 0.0)).xyz);
+        outData.normal = normalize((modelMatrix * vec4(vertex.normal, 0.0)).xyz);
     }
     if ((components & MESH_COMPONENT_TANGENT) != 0) {
-        value.x = vertexData[idx++];
-        value.y = vertexData[idx++];
-        value.z = vertexData[idx++];
-        outData.tangent = normalize((modelMatrix * vec4(value, 0.0)).xyz);
-        value.x = vertexData[idx++];
-        value.y = vertexData[idx++];
-        value.z = vertexData[idx++];
-        outData.bitangent = normalize((modelMatrix * vec4(value, 0.0)).xyz);
-        const float reflect_normal = vertexData[idx++];
-        outData.normal = reflect_normal * normalize(cross(outData.tangent, outData.bitangent));
+        outData.tangent = normalize((modelMatrix * vec4(vertex.tangent, 0.0)).xyz);
+        outData.bitangent = normalize((modelMatrix * vec4(vertex.bitangent, 0.0)).xyz);
+        outData.normal = vertex.reflectNormal * normalize(cross(outData.tangent, outData.bitangent));
     }
     gl_Position = cam.ProjViewMatrix * worldPos;
 }
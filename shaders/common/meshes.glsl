@@ -16,12 +16,15 @@ struct Mesh
     uint    first;
     uint    firstIndex;
     uint    count;
+    float   bboxMin[3];
+    float   bboxExtent[3];
 };
 
 // keep in sync with core/mesh.h: MeshComponents
 #define MESH_COMPONENT_TEXCOORD     0x01
 #define MESH_COMPONENT_NORMAL       0x02
 #define MESH_COMPONENT_TANGENT      0x04
+#define MESH_COMPONENT_QUANTIZED    0x08
 
 layout(std430, binding = MESH_BINDING) restrict readonly buffer MeshBlock
 {
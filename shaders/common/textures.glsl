@@ -30,5 +30,14 @@ layout(binding = AMBIENT_TEX_UNIT) uniform sampler2D uAmbientTex;
 layout(binding = SHADOWMAP_TEX_UNIT) uniform sampler2DArrayShadow uShadowMapTex;
 layout(binding = SHADOWCUBEMAP_TEX_UNIT) uniform samplerCubeArrayShadow uShadowCubeMapTex;
 
+// normal maps may be BC5 compressed (red/green only), z is reconstructed
+vec3 sampleNormalTex(in vec2 uv)
+{
+    vec3 n;
+    n.xy = texture(uNormalTex, uv).rg * 2.0 - 1.0;
+    n.z = sqrt(max(1.0 - dot(n.xy, n.xy), 0.0));
+    return n;
+}
+
 
 #endif // SHADERS_COMMON_TEXTURES_GLSL
@@ -2,6 +2,7 @@
 #define SHADER_COMMON_VERTICES_GLSL
 
 #include "bindings.glsl"
+#include "meshes.glsl"
 
 //!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 //!!                                                 !!
@@ -14,5 +15,92 @@ layout(std430, binding = VERTEX_BINDING) restrict readonly buffer VertexBlock
     float vertexData[];
 };
 
-#endif // SHADER_COMMON_VERTICES_GLSL
+// same buffer, read by meshes with MESH_COMPONENT_QUANTIZED
+layout(std430, binding = VERTEX_BINDING) restrict readonly buffer PackedVertexBlock
+{
+    uint packedVertexData[];
+};
+
+// object space, normal is only valid without tangents:
+// normal = reflectNormal * cross(tangent, bitangent)
+struct Vertex
+{
+    vec3    position;
+    vec2    uv;
+    vec3    normal;
+    vec3    tangent;
+    vec3    bitangent;
+    float   reflectNormal;
+};
+
+vec3 octDecode(in uint packed)
+{
+    const vec2 e = unpackSnorm2x16(packed);
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0) {
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(v);
+}
 
+Vertex fetchVertex(in uint meshID, in uint vertexID)
+{
+    const uint components = meshes[meshID].components;
+    uint idx = meshes[meshID].first + vertexID * meshes[meshID].stride;
+
+    Vertex vertex;
+    vertex.uv = vec2(0.0);
+    vertex.normal = vec3(0.0, 0.0, 1.0);
+    vertex.tangent = vec3(1.0, 0.0, 0.0);
+    vertex.bitangent = vec3(0.0, 1.0, 0.0);
+    vertex.reflectNormal = 1.0;
+
+    if ((components & MESH_COMPONENT_QUANTIZED) != 0) {
+        const vec2 xy = unpackUnorm2x16(packedVertexData[idx++]);
+        const vec2 zw = unpackUnorm2x16(packedVertexData[idx++]);
+        const vec3 bboxMin = vec3(meshes[meshID].bboxMin[0],
+                meshes[meshID].bboxMin[1], meshes[meshID].bboxMin[2]);
+        const vec3 bboxExtent = vec3(meshes[meshID].bboxExtent[0],
+                meshes[meshID].bboxExtent[1], meshes[meshID].bboxExtent[2]);
+        vertex.position = bboxMin + vec3(xy, zw.x) * bboxExtent;
+        vertex.reflectNormal = zw.y * 2.0 - 1.0;
+
+        if ((components & MESH_COMPONENT_TEXCOORD) != 0) {
+            vertex.uv = unpackHalf2x16(packedVertexData[idx++]);
+        }
+        if ((components & MESH_COMPONENT_NORMAL) != 0) {
+            vertex.normal = octDecode(packedVertexData[idx++]);
+        }
+        if ((components & MESH_COMPONENT_TANGENT) != 0) {
+            vertex.tangent = octDecode(packedVertexData[idx++]);
+            vertex.bitangent = octDecode(packedVertexData[idx++]);
+        }
+    } else {
+        vertex.position.x = vertexData[idx++];
+        vertex.position.y = vertexData[idx++];
+        vertex.position.z = vertexData[idx++];
+
+        if ((components & MESH_COMPONENT_TEXCOORD) != 0) {
+            vertex.uv.x = vertexData[idx++];
+            vertex.uv.y = vertexData[idx++];
+        }
+        if ((components & MESH_COMPONENT_NORMAL) != 0) {
+            vertex.normal.x = vertexData[idx++];
+            vertex.normal.y = vertexData[idx++];
+            vertex.normal.z = vertexData[idx++];
+        }
+        if ((components & MESH_COMPONENT_TANGENT) != 0) {
+            vertex.tangent.x = vertexData[idx++];
+            vertex.tangent.y = vertexData[idx++];
+            vertex.tangent.z = vertexData[idx++];
+            vertex.bitangent.x = vertexData[idx++];
+            vertex.bitangent.y = vertexData[idx++];
+            vertex.bitangent.z = vertexData[idx++];
+            vertex.reflectNormal = vertexData[idx++];
+        }
+    }
+
+    return vertex;
+}
+
+#endif // SHADER_COMMON_VERTICES_GLSL
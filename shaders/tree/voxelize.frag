@@ -31,9 +31,7 @@ vec3 m_ambient_color;
 void setNormal() {
 
     if (materials[inData.materialID].hasNormalTex != 0) {
-        vec3 texNormal = texture(uNormalTex, inData.uv).rgb;
-        texNormal.xy = texNormal.xy * 2.0 - 1.0;
-        texNormal = normalize(texNormal);
+        vec3 texNormal = sampleNormalTex(inData.uv);
 
         const mat3 localToWorld_T = mat3(
                 inData.tangent.x, inData.bitangent.x, inData.normal.x,
@@ -0,0 +1,127 @@
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <boost/tokenizer.hpp>
+
+#include "log/log.h"
+#include "log/ostream_sink.h"
+#include "log/relay.h"
+
+#include "framework/vars.h"
+#include "framework/config_file.h"
+
+#include "import/import.h"
+
+// Imports the given scene files without creating a window, so that the
+// scene and texture caches are up to date before grapro is started.
+
+namespace
+{
+bool parseCommandLine(int argc, const char** argv, std::vector<std::string>& files);
+} // anonymous namespace
+
+int main(int argc, const char** argv)
+{
+    logging::Relay::initialize();
+    std::shared_ptr<logging::Sink> sink = std::make_shared<logging::OStreamSink>(std::cerr);
+    logging::Relay::get().registerSink(sink);
+
+    std::vector<std::string> files;
+    if (!parseCommandLine(argc, argv, files)) {
+        logging::Relay::shutdown();
+        return 1;
+    }
+
+    // without any files on the command line, bake what grapro would load
+    if (files.empty()) {
+        boost::char_separator<char> sep(",");
+        boost::tokenizer<boost::char_separator<char>> tokens(vars.scene_files, sep);
+        files.assign(tokens.begin(), tokens.end());
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // importSceneFile() writes the caches, the scenes themselves are not needed
+    std::vector<std::future<bool>> imports;
+    imports.reserve(files.size());
+    for (const auto& file : files) {
+        imports.emplace_back(std::async(std::launch::async, [file] () {
+                    return static_cast<bool>(import::importSceneFile(file));
+                }));
+    }
+
+    int num_failed = 0;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        bool success = false;
+        try {
+            success = imports[i].get();
+            if (!success)
+                LOG_ERROR(logtag::Import, "Failed to bake ", files[i]);
+        } catch (const std::exception& e) {
+            LOG_ERROR(logtag::Import, "Failed to bake ", files[i], ": ", e.what());
+        }
+        if (!success)
+            ++num_failed;
+    }
+
+    const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    LOG_INFO(logtag::Import, "Baked ", files.size() - static_cast<std::size_t>(num_failed),
+            " of ", files.size(), " scene files in ", time.count(), " s");
+
+    logging::Relay::shutdown();
+
+    return num_failed == 0 ? 0 : 1;
+}
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////
+
+bool parseCommandLine(const int argc, const char** argv, std::vector<std::string>& files)
+{
+    using namespace boost::program_options;
+    bool result = true;
+
+    try {
+        options_description desc("Accepted options");
+        desc.add_options()
+            ("config,c", value<std::string>(), "config file")
+            ("help,h", "print help")
+        ;
+        options_description hidden;
+        hidden.add_options()
+            ("scene", value<std::vector<std::string>>(&files), "scene file")
+        ;
+        options_description all;
+        all.add(desc).add(hidden);
+        positional_options_description positional;
+        positional.add("scene", -1);
+
+        variables_map vm;
+        store(command_line_parser(argc, argv).options(all).positional(positional).run(), vm);
+        notify(vm);
+
+        if (vm.count("help") > 0) {
+            std::cout << "./grapro-bake <options> [scene files]" << std::endl;
+            std::cout << desc;
+            std::exit(0);
+        }
+
+        if (vm.count("config")) {
+            framework::ConfigFile cfg(vm["config"].as<std::string>());
+            vars.load(cfg);
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        result = false;
+    }
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
@@ -0,0 +1,201 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/dirty_bits.h"
+#include "core/frame_ring.h"
+
+// Per-frame cost of updating moved instances and flushing them into a
+// triple-buffered pool: 12k instances, 1% of them move every frame. The
+// pool copies the ranges with the same FrameRing and copyRanges() as
+// BufferStoragePool::flush(), but counts the flush calls instead of
+// issuing them. The modified instances are found with the DirtyBits of
+// InstanceManager::update().
+
+namespace
+{
+
+constexpr std::size_t NUM_INSTANCES = 12000;
+constexpr std::size_t NUM_MOVING = NUM_INSTANCES / 100;
+constexpr unsigned int NUM_REGIONS = 3;
+constexpr int NUM_FRAMES = 2000;
+
+//////////////////////////////////////////////////////////////////////////
+
+// same size as shader::InstanceStruct
+struct Element
+{
+    float           model[16];
+    float           bbox_min[3];
+    std::uint32_t   mesh;
+    float           bbox_max[3];
+    std::uint32_t   material;
+};
+static_assert(sizeof(Element) == 96, "");
+
+//////////////////////////////////////////////////////////////////////////
+
+class NoFences
+  : public core::FrameRing::Backend
+{
+public:
+    virtual void fence(unsigned int) override {}
+    virtual void wait(unsigned int) override {}
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+class StubPool
+{
+public:
+    StubPool()
+      : m_shadow(NUM_INSTANCES),
+        m_regions(NUM_REGIONS * NUM_INSTANCES),
+        m_ring(NUM_REGIONS, m_fences),
+        m_flush_calls{0},
+        m_flush_bytes{0}
+    {
+    }
+
+    Element* get(const std::uint32_t index)
+    {
+        m_ring.markDirty(index);
+        return &m_shadow[index];
+    }
+
+    void flush()
+    {
+        const auto& ranges = m_ring.advance();
+        Element* dst = &m_regions[0] + m_ring.getCurrent() * NUM_INSTANCES;
+        copyRanges(ranges, m_shadow.data(), dst,
+                [this] (const std::size_t, const std::size_t size)
+                {
+                    ++m_flush_calls;
+                    m_flush_bytes += size;
+                });
+    }
+
+    std::size_t getFlushCalls() const {return m_flush_calls;}
+    std::size_t getFlushBytes() const {return m_flush_bytes;}
+
+private:
+    std::vector<Element>    m_shadow;
+    std::vector<Element>    m_regions;
+    NoFences                m_fences;
+    core::FrameRing         m_ring;
+    std::size_t             m_flush_calls;
+    std::size_t             m_flush_bytes;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+struct Instance
+{
+    float           position[3];
+    std::uint32_t   index;
+    bool            modified;
+
+    // one write, like Instance::update()
+    void update(StubPool& pool)
+    {
+        Element element;
+        std::memset(&element, 0, sizeof(element));
+        element.model[0] = element.model[5] = element.model[10] = element.model[15] = 1.f;
+        for (int i = 0; i < 3; ++i) {
+            element.model[12 + i] = position[i];
+            element.bbox_min[i] = position[i] - 1.f;
+            element.bbox_max[i] = position[i] + 1.f;
+        }
+        *pool.get(index) = element;
+        modified = false;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+enum class Update
+{
+    FullWalk,   // every instance, whenever one was modified
+    DirtyBits   // InstanceManager
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+void run(const char* name, const Update mode)
+{
+    StubPool pool;
+    std::unordered_map<std::string, std::unique_ptr<Instance>> instances;
+    std::vector<Instance*> by_index;
+    for (std::size_t i = 0; i < NUM_INSTANCES; ++i) {
+        std::unique_ptr<Instance> instance(new Instance{{0.f, 0.f, 0.f},
+                static_cast<std::uint32_t>(i), false});
+        instance->update(pool);
+        by_index.push_back(instance.get());
+        instances.emplace("instance" + std::to_string(i), std::move(instance));
+    }
+    for (unsigned int i = 0; i < NUM_REGIONS; ++i) {
+        pool.flush();
+    }
+    const auto initial_calls = pool.getFlushCalls();
+    const auto initial_bytes = pool.getFlushBytes();
+
+    core::DirtyBits modified;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<std::size_t> pick(0, NUM_INSTANCES - 1);
+    std::chrono::duration<double, std::micro> update_time(0);
+    std::chrono::duration<double, std::micro> flush_time(0);
+
+    for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+        for (std::size_t i = 0; i < NUM_MOVING; ++i) {
+            Instance* instance = by_index[pick(rng)];
+            instance->position[0] += 1.f;
+            instance->modified = true;
+            if (mode == Update::DirtyBits)
+                modified.set(instance->index);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        if (mode == Update::FullWalk) {
+            for (const auto& instance : instances) {
+                if (instance.second->modified)
+                    instance.second->update(pool);
+            }
+        } else {
+            modified.consume([&by_index, &pool] (const std::size_t index)
+                    {
+                        by_index[index]->update(pool);
+                    });
+        }
+        const auto updated = std::chrono::steady_clock::now();
+        pool.flush();
+        const auto flushed = std::chrono::steady_clock::now();
+
+        update_time += updated - start;
+        flush_time += flushed - updated;
+    }
+
+    const auto calls = static_cast<double>(pool.getFlushCalls() - initial_calls) / NUM_FRAMES;
+    const auto kib = static_cast<double>(pool.getFlushBytes() - initial_bytes) / NUM_FRAMES / 1024.;
+    std::printf("%-28s update %7.1f us  flush %6.1f us  %6.1f flush calls  %6.1f KiB\n",
+            name, update_time.count() / NUM_FRAMES, flush_time.count() / NUM_FRAMES, calls, kib);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
+
+int main()
+{
+    std::printf("%zu instances, %zu moving, %u regions, %d frames, per frame:\n",
+            NUM_INSTANCES, NUM_MOVING, NUM_REGIONS, NUM_FRAMES);
+    run("full walk", Update::FullWalk);
+    run("dirty bits", Update::DirtyBits);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "core/mesh_packer.h"
+#include "import/mesh.h"
+
+// Packing speed of core::packMesh() for the float and the quantized vertex
+// layout: synthetic height field grids with texture coordinates and
+// normals or tangents, with 8, 16 and 32 bit indices and a LOD of half the
+// triangles. Speed is in MB of packed output per second, the best of a few
+// batches of about 64 MB each.
+
+namespace
+{
+
+constexpr std::size_t BATCH_SIZE = 64 * 1024 * 1024;
+constexpr int NUM_BATCHES = 5;
+
+//////////////////////////////////////////////////////////////////////////
+
+// owns the arrays import::Mesh points to
+struct Grid
+{
+    std::vector<glm::vec3>      vertices;
+    std::vector<glm::vec3>      normals;
+    std::vector<glm::vec3>      tangents;
+    std::vector<glm::vec3>      bitangents;
+    std::vector<glm::vec2>      texcoords;
+    std::vector<std::uint32_t>  indices;
+    import::Mesh                mesh;
+
+    Grid(const std::uint32_t side, const bool with_tangents)
+    {
+        for (std::uint32_t y = 0; y < side; ++y) {
+            for (std::uint32_t x = 0; x < side; ++x) {
+                const float u = static_cast<float>(x) / static_cast<float>(side - 1);
+                const float v = static_cast<float>(y) / static_cast<float>(side - 1);
+                const float dx = .3f * std::cos(10.f * u);
+                const float dy = -.2f * std::sin(7.f * v);
+                vertices.emplace_back(u, v, .03f * std::sin(10.f * u) + .03f * std::cos(7.f * v));
+                texcoords.emplace_back(u, v);
+                tangents.push_back(glm::normalize(glm::vec3(1.f, 0.f, dx)));
+                bitangents.push_back(glm::normalize(glm::vec3(0.f, 1.f, dy)));
+                normals.push_back(glm::normalize(glm::cross(tangents.back(), bitangents.back())));
+            }
+        }
+        for (std::uint32_t y = 0; y + 1 < side; ++y) {
+            for (std::uint32_t x = 0; x + 1 < side; ++x) {
+                const std::uint32_t i = y * side + x;
+                for (const std::uint32_t corner : {i, i + 1, i + side, i + 1, i + side + 1, i + side}) {
+                    indices.push_back(corner);
+                }
+            }
+        }
+
+        mesh = import::Mesh();
+        mesh.indices = indices.data();
+        mesh.vertices = vertices.data();
+        mesh.normals = normals.data();
+        mesh.tangents = with_tangents ? tangents.data() : nullptr;
+        mesh.bitangents = with_tangents ? bitangents.data() : nullptr;
+        mesh.texcoords = texcoords.data();
+        // the first half of the triangles stands in for a LOD
+        mesh.lod_indices = indices.data();
+        mesh.bbox = core::AABB(vertices.front());
+        for (const auto& v : vertices) {
+            mesh.bbox.expandBy(v);
+        }
+        mesh.num_vertices = static_cast<std::uint32_t>(vertices.size());
+        mesh.num_indices = static_cast<std::uint32_t>(indices.size());
+        mesh.num_lod_indices = mesh.num_indices / 6 * 3;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+void run(const std::uint32_t side, const bool with_tangents, const bool quantize)
+{
+    const Grid grid(side, with_tangents);
+    const core::PackedMeshLayout layout = core::getPackedMeshLayout(&grid.mesh, quantize);
+    // packMesh() wants 4 byte alignment
+    std::vector<std::uint32_t> buffer((layout.size + 3) / 4);
+    auto* const dst = reinterpret_cast<std::uint8_t*>(buffer.data());
+    const std::size_t runs = std::max<std::size_t>(1, BATCH_SIZE / layout.size);
+
+    double best = 0.;
+    for (int batch = 0; batch < NUM_BATCHES; ++batch) {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < runs; ++i) {
+            core::packMesh(&grid.mesh, layout, dst);
+        }
+        const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+        best = batch == 0 ? time.count() : std::min(best, time.count());
+    }
+
+    const double mb = static_cast<double>(layout.size * runs) / (1024. * 1024.);
+    std::printf("%-9s %-8s %6u vertices  %2zu bit indices  %3zu bytes/vertex  %7.1f MB/s\n",
+            quantize ? "quantized" : "float", with_tangents ? "tangents" : "normals",
+            grid.mesh.num_vertices, 8 * layout.per_index_size, layout.per_vertex_size,
+            mb / best);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
+
+int main()
+{
+    // 8, 16 and 32 bit indices
+    const std::uint32_t sides[] = {15, 200, 400};
+    for (const bool quantize : {false, true}) {
+        for (const bool with_tangents : {false, true}) {
+            for (const auto side : sides) {
+                run(side, with_tangents, quantize);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -70,6 +70,19 @@ struct AABB
         return .5f * (pmin + pmax);
     }
 
+    // bounds of the box transformed by the affine 'm' (Arvo)
+    AABB transformed(const glm::mat4& m) const noexcept
+    {
+        const glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.f));
+        const glm::vec3 e = .5f * (pmax - pmin);
+        const glm::vec3 extent = glm::abs(glm::vec3(m[0])) * e.x +
+            glm::abs(glm::vec3(m[1])) * e.y + glm::abs(glm::vec3(m[2])) * e.z;
+        AABB result;
+        result.pmin = c - extent;
+        result.pmax = c + extent;
+        return result;
+    }
+
 };
 
 } // namespace core
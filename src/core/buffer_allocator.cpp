@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cassert>
+
+#include "buffer_allocator.h"
+#include "log/log.h"
+
+namespace core
+{
+
+/****************************************************************************/
+
+constexpr std::size_t BufferAllocator::INVALID_OFFSET;
+constexpr unsigned int BufferAllocator::SL_LOG2;
+constexpr unsigned int BufferAllocator::SL_COUNT;
+constexpr unsigned int BufferAllocator::FL_COUNT;
+constexpr std::uint32_t BufferAllocator::NO_BLOCK;
+
+/****************************************************************************/
+
+namespace
+{
+
+unsigned int log2(const std::size_t x)
+{
+    assert(x > 0);
+    return 63u - static_cast<unsigned int>(__builtin_clzll(static_cast<unsigned long long>(x)));
+}
+
+/****************************************************************************/
+
+// first level: power of two, second level: linear steps in between
+void mapping(const std::size_t size, const unsigned int sl_log2,
+        unsigned int& fl, unsigned int& sl)
+{
+    if (size < (std::size_t(1) << sl_log2)) {
+        fl = 0;
+        sl = static_cast<unsigned int>(size);
+    } else {
+        const unsigned int f = log2(size);
+        fl = f - sl_log2 + 1;
+        sl = static_cast<unsigned int>(size >> (f - sl_log2)) - (1u << sl_log2);
+    }
+}
+
+} // anonymous namespace
+
+/****************************************************************************/
+
+BufferAllocator::BufferAllocator(const std::size_t size)
+  : m_size{size}
+{
+    clear();
+}
+
+/****************************************************************************/
+
+BufferAllocator::~BufferAllocator() = default;
+
+/****************************************************************************/
+
+std::size_t BufferAllocator::alloc(std::size_t size, const std::size_t alignment)
+{
+    assert(alignment > 0);
+    size = std::max(size, std::size_t(1));
+
+    // every block in the list is large enough, even if it's misaligned
+    std::uint32_t block = findFree(size + alignment - 1);
+    if (block == NO_BLOCK) {
+        // good fit, the rounding in findFree() skips some blocks that fit
+        unsigned int fl, sl;
+        mapping(size, SL_LOG2, fl, sl);
+        for (auto b = m_free_lists[fl][sl]; b != NO_BLOCK; b = m_blocks[b].next_free) {
+            const auto& candidate = m_blocks[b];
+            const auto aligned = (candidate.offset + alignment - 1) / alignment * alignment;
+            if (aligned + size <= candidate.offset + candidate.size) {
+                block = b;
+                break;
+            }
+        }
+        if (block == NO_BLOCK)
+            return INVALID_OFFSET;
+    }
+    removeFree(block);
+
+    const auto offset = m_blocks[block].offset;
+    const auto aligned = (offset + alignment - 1) / alignment * alignment;
+    if (aligned > offset) {
+        const auto tail = split(block, aligned - offset);
+        insertFree(block);
+        block = tail;
+    }
+    if (m_blocks[block].size > size) {
+        insertFree(split(block, size));
+    }
+    m_blocks[block].free = false;
+    m_used.emplace(aligned, block);
+
+    m_free_size -= size;
+    m_high_water_mark = std::max(m_high_water_mark, aligned + size);
+
+    return aligned;
+}
+
+/****************************************************************************/
+
+void BufferAllocator::free(const std::size_t offset)
+{
+    auto it = m_used.find(offset);
+    if (it == m_used.end()) {
+        LOG_ERROR("BufferAllocator: unknown offset ", offset);
+        return;
+    }
+    std::uint32_t block = it->second;
+    m_used.erase(it);
+    m_free_size += m_blocks[block].size;
+
+    // merge with free neighbours
+    const auto prev = m_blocks[block].prev;
+    if (prev != NO_BLOCK && m_blocks[prev].free) {
+        removeFree(prev);
+        m_blocks[prev].size += m_blocks[block].size;
+        m_blocks[prev].next = m_blocks[block].next;
+        if (m_blocks[block].next != NO_BLOCK)
+            m_blocks[m_blocks[block].next].prev = prev;
+        deleteBlock(block);
+        block = prev;
+    }
+    const auto next = m_blocks[block].next;
+    if (next != NO_BLOCK && m_blocks[next].free) {
+        removeFree(next);
+        m_blocks[block].size += m_blocks[next].size;
+        m_blocks[block].next = m_blocks[next].next;
+        if (m_blocks[next].next != NO_BLOCK)
+            m_blocks[m_blocks[next].next].prev = block;
+        deleteBlock(next);
+    }
+    insertFree(block);
+}
+
+/****************************************************************************/
+
+void BufferAllocator::clear()
+{
+    m_free_size = m_size;
+    m_high_water_mark = 0;
+    m_fl_bitmap = 0;
+    std::fill_n(m_sl_bitmaps, FL_COUNT, 0u);
+    std::fill_n(&m_free_lists[0][0], FL_COUNT * SL_COUNT, NO_BLOCK);
+    m_blocks.clear();
+    m_unused_blocks.clear();
+    m_used.clear();
+
+    if (m_size > 0)
+        insertFree(newBlock(0, m_size));
+}
+
+/****************************************************************************/
+
+std::size_t BufferAllocator::getSize() const
+{
+    return m_size;
+}
+
+/****************************************************************************/
+
+std::size_t BufferAllocator::getFreeSize() const
+{
+    return m_free_size;
+}
+
+/****************************************************************************/
+
+// the largest block is in the highest non-empty list
+std::size_t BufferAllocator::getLargestFreeBlock() const
+{
+    if (m_fl_bitmap == 0)
+        return 0;
+    const auto fl = log2(static_cast<std::size_t>(m_fl_bitmap));
+    const auto sl = log2(m_sl_bitmaps[fl]);
+    std::size_t result = 0;
+    for (auto b = m_free_lists[fl][sl]; b != NO_BLOCK; b = m_blocks[b].next_free) {
+        result = std::max(result, m_blocks[b].size);
+    }
+    return result;
+}
+
+/****************************************************************************/
+
+std::size_t BufferAllocator::getHighWaterMark() const
+{
+    return m_high_water_mark;
+}
+
+/****************************************************************************/
+
+float BufferAllocator::getFragmentation() const
+{
+    if (m_free_size == 0)
+        return .0f;
+    return 1.f - static_cast<float>(getLargestFreeBlock()) / static_cast<float>(m_free_size);
+}
+
+/****************************************************************************/
+
+std::uint32_t BufferAllocator::newBlock(const std::size_t offset, const std::size_t size)
+{
+    std::uint32_t block;
+    if (m_unused_blocks.empty()) {
+        block = static_cast<std::uint32_t>(m_blocks.size());
+        m_blocks.emplace_back();
+    } else {
+        block = m_unused_blocks.back();
+        m_unused_blocks.pop_back();
+    }
+    m_blocks[block] = Block{offset, size, NO_BLOCK, NO_BLOCK, NO_BLOCK, NO_BLOCK, true};
+    return block;
+}
+
+/****************************************************************************/
+
+void BufferAllocator::deleteBlock(const std::uint32_t block)
+{
+    m_unused_blocks.push_back(block);
+}
+
+/****************************************************************************/
+
+void BufferAllocator::insertFree(const std::uint32_t block)
+{
+    unsigned int fl, sl;
+    mapping(m_blocks[block].size, SL_LOG2, fl, sl);
+
+    auto& b = m_blocks[block];
+    const auto head = m_free_lists[fl][sl];
+    b.free = true;
+    b.prev_free = NO_BLOCK;
+    b.next_free = head;
+    if (head != NO_BLOCK)
+        m_blocks[head].prev_free = block;
+    m_free_lists[fl][sl] = block;
+
+    m_fl_bitmap |= std::uint64_t(1) << fl;
+    m_sl_bitmaps[fl] |= 1u << sl;
+}
+
+/****************************************************************************/
+
+void BufferAllocator::removeFree(const std::uint32_t block)
+{
+    unsigned int fl, sl;
+    mapping(m_blocks[block].size, SL_LOG2, fl, sl);
+
+    const auto& b = m_blocks[block];
+    if (b.prev_free != NO_BLOCK)
+        m_blocks[b.prev_free].next_free = b.next_free;
+    if (b.next_free != NO_BLOCK)
+        m_blocks[b.next_free].prev_free = b.prev_free;
+    if (m_free_lists[fl][sl] == block) {
+        m_free_lists[fl][sl] = b.next_free;
+        if (b.next_free == NO_BLOCK) {
+            m_sl_bitmaps[fl] &= ~(1u << sl);
+            if (m_sl_bitmaps[fl] == 0)
+                m_fl_bitmap &= ~(std::uint64_t(1) << fl);
+        }
+    }
+}
+
+/****************************************************************************/
+
+// a block from the first list whose smallest size is >= 'size'
+std::uint32_t BufferAllocator::findFree(std::size_t size) const
+{
+    if (size >= SL_COUNT) {
+        const auto round = (std::size_t(1) << (log2(size) - SL_LOG2)) - 1;
+        if (size > static_cast<std::size_t>(-1) - round)
+            return NO_BLOCK;
+        size += round;
+    }
+    unsigned int fl, sl;
+    mapping(size, SL_LOG2, fl, sl);
+
+    std::uint32_t sl_map = m_sl_bitmaps[fl] & (~0u << sl);
+    if (sl_map == 0) {
+        if (fl + 1 >= FL_COUNT)
+            return NO_BLOCK;
+        const std::uint64_t fl_map = m_fl_bitmap & (~std::uint64_t(0) << (fl + 1));
+        if (fl_map == 0)
+            return NO_BLOCK;
+        fl = static_cast<unsigned int>(__builtin_ctzll(fl_map));
+        sl_map = m_sl_bitmaps[fl];
+    }
+    sl = static_cast<unsigned int>(__builtin_ctz(sl_map));
+    return m_free_lists[fl][sl];
+}
+
+/****************************************************************************/
+
+std::uint32_t BufferAllocator::split(const std::uint32_t block, const std::size_t size)
+{
+    assert(size < m_blocks[block].size);
+    const auto tail = newBlock(m_blocks[block].offset + size, m_blocks[block].size - size);
+
+    auto& b = m_blocks[block];
+    auto& t = m_blocks[tail];
+    t.prev = block;
+    t.next = b.next;
+    if (b.next != NO_BLOCK)
+        m_blocks[b.next].prev = tail;
+    b.next = tail;
+    b.size = size;
+
+    return tail;
+}
+
+/****************************************************************************/
+
+} // namespace core
@@ -0,0 +1,79 @@
+#ifndef CORE_BUFFER_ALLOCATOR_H
+#define CORE_BUFFER_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+
+/*
+ * Two-level segregated fit allocator (TLSF, Masmano et al.) for ranges of
+ * a buffer that lives elsewhere, e.g. on the GPU. The first level splits
+ * the sizes into powers of two, the second one into SL_COUNT linear steps,
+ * bitmaps find a large enough free block in constant time. Neighbouring
+ * free blocks are merged right away. No OpenGL in here.
+ */
+class BufferAllocator
+{
+public:
+    static constexpr std::size_t INVALID_OFFSET = static_cast<std::size_t>(-1);
+
+    explicit BufferAllocator(std::size_t size);
+    ~BufferAllocator();
+
+    // any alignment > 0, returns INVALID_OFFSET if there's no space
+    std::size_t alloc(std::size_t size, std::size_t alignment = 1);
+    void free(std::size_t offset);
+    void clear();
+
+    std::size_t getSize() const;
+    std::size_t getFreeSize() const;
+    std::size_t getLargestFreeBlock() const;
+    // the highest end of an allocation so far
+    std::size_t getHighWaterMark() const;
+    // 0: all free space is one block, close to 1: lots of small blocks
+    float getFragmentation() const;
+
+private:
+    static constexpr unsigned int SL_LOG2 = 4;
+    static constexpr unsigned int SL_COUNT = 1u << SL_LOG2;
+    static constexpr unsigned int FL_COUNT = 64 - SL_LOG2 + 1;
+    static constexpr std::uint32_t NO_BLOCK = 0xFFFFFFFF;
+
+    struct Block
+    {
+        std::size_t     offset;
+        std::size_t     size;
+        std::uint32_t   prev;       // by offset
+        std::uint32_t   next;
+        std::uint32_t   prev_free;  // in the same free list
+        std::uint32_t   next_free;
+        bool            free;
+    };
+
+    std::uint32_t newBlock(std::size_t offset, std::size_t size);
+    void deleteBlock(std::uint32_t block);
+    void insertFree(std::uint32_t block);
+    void removeFree(std::uint32_t block);
+    std::uint32_t findFree(std::size_t size) const;
+    // shrinks 'block' to 'size', returns the rest as a new block
+    // that isn't in a free list yet
+    std::uint32_t split(std::uint32_t block, std::size_t size);
+
+    std::size_t                 m_size;
+    std::size_t                 m_free_size;
+    std::size_t                 m_high_water_mark;
+    std::uint64_t               m_fl_bitmap;
+    std::uint32_t               m_sl_bitmaps[FL_COUNT];
+    std::uint32_t               m_free_lists[FL_COUNT][SL_COUNT];
+    std::vector<Block>          m_blocks;
+    std::vector<std::uint32_t>  m_unused_blocks;
+    std::unordered_map<std::size_t, std::uint32_t> m_used;  // by offset
+};
+
+} // namespace core
+
+#endif // CORE_BUFFER_ALLOCATOR_H
@@ -2,8 +2,7 @@
 #define CORE_BUFFER_STORAGE_H
 
 #include "gl/gl_objects.h"
-#include <cstddef>
-#include <vector>
+#include "buffer_allocator.h"
 
 namespace core
 {
@@ -14,23 +13,20 @@ public:
     BufferStorage(GLenum target, GLsizeiptr size);
     ~BufferStorage();
 
+    // returns -1 if there's no space left
     GLintptr alloc(GLsizeiptr size, GLsizei alignment);
     void free(GLintptr offset);
 
     void clear();
 
     const gl::Buffer& buffer() const;
+    const BufferAllocator& allocator() const;
 
 private:
-    struct Segment;
-
     gl::Buffer              m_buffer;
-    GLsizeiptr              m_size;
-    std::vector<Segment>    m_freelist;
-    std::vector<Segment>    m_used;
+    BufferAllocator         m_allocator;
 };
 
 } // namespace core
 
 #endif // CORE_BUFFER_STORAGE_H
-
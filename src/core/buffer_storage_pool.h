@@ -3,84 +3,233 @@
 
 #include "gl/gl_objects.h"
 #include "log/log.h"
+#include "framework/vars.h"
+#include "frame_ring.h"
+#include "gl_fences.h"
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <vector>
-#include <utility>
 
 namespace core
 {
 
+/*
+ * Array of T for the shaders, which see
+ *     int count; T elements[];
+ * where 'count' is one past the last element ever used. Free elements are
+ * zeroed and reused first, compact() removes the holes. The elements are
+ * addressed by generational handles, which stay valid when the pool grows
+ * into a new buffer or is compacted; pointers and indices don't.
+ *
+ * The CPU writes a copy of the array. The buffer is persistently mapped
+ * and holds vars.frames_in_flight regions, flush() copies the changes into
+ * the next region once the GPU is done with it (see FrameRing) and bind()
+ * selects it.
+ */
 template <typename T>
 class BufferStoragePool
 {
 private:
     static constexpr int first_offset() {return (4 > T::alignment()) ? 4 : T::alignment();}
+    static constexpr std::uint32_t NO_ELEMENT = 0xFFFFFFFF;
+    static constexpr std::uint32_t NO_SLOT = 0xFFFFFFFF;
+    // bytes, see FrameRing; a larger gap only pays off if a flush costs
+    // more than copying it, which hasn't been measured with real GL calls
+    static constexpr std::size_t MAX_FLUSH_GAP = 0;
 
 public:
-    BufferStoragePool(GLenum target, std::size_t cap)
-      : m_capacity{cap},
-        m_size{0}
+    static constexpr GLuint INVALID_INDEX = 0xFFFFFFFF;
+
+    struct Handle
     {
-        static_assert((sizeof(T) % T::alignment()) == 0, "");
+        std::uint32_t   slot;
+        std::uint32_t   generation;
+    };
 
-        auto buffer_size = m_capacity * sizeof(T);
+    // Handle plus pool, for the objects that write their own element.
+    class Ref
+    {
+    public:
+        Ref(BufferStoragePool* pool, const Handle handle)
+          : m_pool{pool}, m_handle(handle) {}
 
-        // first 4 bytes are for the counter
-        m_freelist.emplace_back(first_offset(), buffer_size);
+        T* get() const {return m_pool->get(m_handle);}
+        T* operator->() const {return get();}
+        T& operator*() const {return *get();}
+        GLuint index() const {return m_pool->index(m_handle);}
+        Handle handle() const {return m_handle;}
 
-        glBindBuffer(target, m_buffer);
+    private:
+        BufferStoragePool*  m_pool;
+        Handle              m_handle;
+    };
 
-        glBufferStorage(target, buffer_size, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT);
-        m_data = glMapBufferRange(target, 0, buffer_size,
-                GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    // grows beyond 'cap' if necessary
+    BufferStoragePool(GLenum target, std::size_t cap)
+      : m_target{target},
+        m_capacity{std::max(cap, std::size_t(1))},
+        m_region_size{0},
+        m_region_alignment{0},
+        m_data{nullptr},
+        m_size{0},
+        m_end{0},
+        m_shadow(m_capacity),
+        m_fences(numRegions()),
+        m_ring(numRegions(), m_fences, MAX_FLUSH_GAP / sizeof(T))
+    {
+        static_assert((sizeof(T) % T::alignment()) == 0, "");
+
+        // glBindBufferRange() requires aligned offsets
+        GLint alignment;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        m_region_alignment = std::max<GLsizeiptr>(alignment, T::alignment());
+
+        createBuffer();
     }
 
-    GLintptr alloc()
+    Handle alloc()
     {
-        if (m_freelist.empty()) {
-            LOG_ERROR("BufferStoragePool is full");
-            abort();
+        std::uint32_t element;
+        if (!m_free_elements.empty()) {
+            element = m_free_elements.back();
+            m_free_elements.pop_back();
+        } else {
+            if (m_end == m_capacity)
+                grow();
+            element = static_cast<std::uint32_t>(m_end++);
+            m_owners.push_back(NO_SLOT);
+        }
+
+        std::uint32_t slot;
+        if (!m_free_slots.empty()) {
+            slot = m_free_slots.back();
+            m_free_slots.pop_back();
+        } else {
+            slot = static_cast<std::uint32_t>(m_slots.size());
+            m_slots.push_back(Slot{NO_ELEMENT, 0});
         }
-        auto& seg = m_freelist.back();
-        const auto res = seg.first;
-        seg.first += sizeof(T);
-        if (seg.first == seg.second)
-            m_freelist.pop_back();
+        m_slots[slot].element = element;
+        m_owners[element] = slot;
         m_size++;
-        *static_cast<int*>(m_data) = static_cast<int>(m_size);
-        return res;
+        m_ring.markDirty(element);
+
+        return Handle{slot, m_slots[slot].generation};
     }
 
-    void free(GLintptr offset)
+    Ref ref(const Handle handle)
     {
-        // TODO
-        m_freelist.emplace_back(offset, offset + sizeof(T));
+        assert(isValid(handle));
+        return Ref(this, handle);
+    }
+
+    void free(const Handle handle)
+    {
+        if (!isValid(handle)) {
+            LOG_ERROR("BufferStoragePool: invalid handle");
+            return;
+        }
+        auto& slot = m_slots[handle.slot];
+        std::memset(static_cast<void*>(&m_shadow[slot.element]), 0, sizeof(T));
+        m_ring.markDirty(slot.element);
+        m_owners[slot.element] = NO_SLOT;
+        m_free_elements.push_back(slot.element);
+        slot.element = NO_ELEMENT;
+        slot.generation++;
+        m_free_slots.push_back(handle.slot);
         m_size--;
-        *static_cast<int*>(m_data) = static_cast<int>(m_size);
     }
 
+    // Moves the elements to the front, keeping their order. Returns the new
+    // index for every old one (INVALID_INDEX for free elements), indices
+    // stored elsewhere have to be remapped with it.
+    std::vector<GLuint> compact()
+    {
+        std::vector<GLuint> remap(m_end, INVALID_INDEX);
+        std::uint32_t next = 0;
+        for (std::uint32_t e = 0; e < m_end; ++e) {
+            const auto slot = m_owners[e];
+            if (slot == NO_SLOT)
+                continue;
+            if (e != next) {
+                m_shadow[next] = m_shadow[e];
+                m_owners[next] = slot;
+                m_slots[slot].element = next;
+            }
+            remap[e] = next++;
+        }
+        if (next < m_end) {
+            std::memset(static_cast<void*>(&m_shadow[next]), 0, (m_end - next) * sizeof(T));
+        }
+        m_ring.markDirty(0, static_cast<std::uint32_t>(m_end));
+
+        m_owners.resize(next);
+        m_free_elements.clear();
+        m_end = next;
+
+        return remap;
+    }
+
+    // Once per frame, after the CPU is done writing: fences the region
+    // of the last frame and copies the changes into the next one.
+    void flush()
+    {
+        const auto& ranges = m_ring.advance();
+        const auto region = static_cast<GLintptr>(m_ring.getCurrent()) * m_region_size;
+        char* dst = static_cast<char*>(m_data) + region;
+
+        *reinterpret_cast<int*>(dst) = static_cast<int>(m_end);
+        glFlushMappedNamedBufferRangeEXT(m_buffer, region, sizeof(int));
+
+        const auto elements = region + first_offset();
+        copyRanges(ranges, m_shadow.data(), dst + first_offset(),
+                [this, elements] (const std::size_t offset, const std::size_t size)
+                {
+                    glFlushMappedNamedBufferRangeEXT(m_buffer,
+                            elements + static_cast<GLintptr>(offset),
+                            static_cast<GLsizeiptr>(size));
+                });
+    }
+
+    // the current region
+    void bind(const GLenum target, const GLuint binding) const
+    {
+        glBindBufferRange(target, binding, m_buffer,
+                static_cast<GLintptr>(m_ring.getCurrent()) * m_region_size,
+                first_offset() + static_cast<GLsizeiptr>(m_capacity * sizeof(T)));
+    }
 
-    T* offsetToPointer(const GLintptr offset) const
+    // a single element of the current region, e.g. for a uniform block
+    void bind(const GLenum target, const GLuint binding, const Handle handle) const
     {
-        const auto tmp = static_cast<char*>(m_data);
-        return reinterpret_cast<T*>(tmp + offset);
+        glBindBufferRange(target, binding, m_buffer,
+                static_cast<GLintptr>(m_ring.getCurrent()) * m_region_size + first_offset() +
+                static_cast<GLintptr>(index(handle) * sizeof(T)),
+                sizeof(T));
     }
 
-    GLuint offsetToIndex(const GLintptr offset) const
+    bool isValid(const Handle handle) const
     {
-        return static_cast<GLuint>(offset - first_offset()) /
-                static_cast<GLuint>(sizeof(T));
+        return handle.slot < m_slots.size() &&
+            m_slots[handle.slot].generation == handle.generation &&
+            m_slots[handle.slot].element != NO_ELEMENT;
     }
 
-    GLintptr pointerToOffset(const T* const ptr) const
+    // for writing, invalidated by grow() and compact()
+    T* get(const Handle handle)
     {
-        return reinterpret_cast<const char*>(ptr) - static_cast<const char*>(m_data);
+        assert(isValid(handle));
+        const auto element = m_slots[handle.slot].element;
+        m_ring.markDirty(element);
+        return &m_shadow[element];
     }
 
-    GLintptr indexToOffset(const GLuint index) const
+    // in the shader's array, changed by compact()
+    GLuint index(const Handle handle) const
     {
-        return (static_cast<GLintptr>(index) * static_cast<GLintptr>(sizeof(T)))
-            + first_offset();
+        assert(isValid(handle));
+        return m_slots[handle.slot].element;
     }
 
     std::size_t capacity() const
@@ -93,25 +242,84 @@ public:
         return m_size;
     }
 
-    const gl::Buffer& buffer() const
+/****************************************************************************/
+
+private:
+    struct Slot
+    {
+        std::uint32_t   element;
+        std::uint32_t   generation;
+    };
+
+    static unsigned int numRegions()
     {
-        return m_buffer;
+        return static_cast<unsigned int>(std::max(vars.frames_in_flight, 1));
     }
 
-/****************************************************************************/
+    // every region gets the whole array
+    void createBuffer()
+    {
+        const auto size = first_offset() + static_cast<GLsizeiptr>(m_capacity * sizeof(T));
+        m_region_size = (size + m_region_alignment - 1) / m_region_alignment *
+            m_region_alignment;
+        const auto buffer_size = m_region_size * m_ring.getNumRegions();
 
-private:
+        gl::Buffer buffer;
+        glBindBuffer(m_target, buffer);
+        glBufferStorage(m_target, buffer_size, nullptr,
+                GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT);
+        m_data = glMapBufferRange(m_target, 0, buffer_size,
+                GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+        // deleting the old buffer unmaps it
+        m_buffer = std::move(buffer);
+
+        for (unsigned int region = 0; region < m_ring.getNumRegions(); ++region) {
+            char* dst = static_cast<char*>(m_data) + region * m_region_size;
+            *reinterpret_cast<int*>(dst) = static_cast<int>(m_end);
+            if (m_end > 0)
+                std::memcpy(dst + first_offset(), m_shadow.data(), m_end * sizeof(T));
+        }
+        glFlushMappedNamedBufferRangeEXT(m_buffer, 0, buffer_size);
+    }
+
+    // No need to wait for the fences, the GPU may still read the old buffer.
+    void grow()
+    {
+        const auto capacity = 2 * m_capacity;
+        LOG_INFO("BufferStoragePool: growing from ", m_capacity, " to ", capacity,
+                " elements");
+
+        m_capacity = capacity;
+        m_shadow.resize(m_capacity);
+        createBuffer();
+    }
 
     gl::Buffer      m_buffer;
+    GLenum          m_target;
     std::size_t     m_capacity;
+    GLsizeiptr      m_region_size;
+    GLsizeiptr      m_region_alignment;
     void*           m_data;
     std::size_t     m_size;
+    std::size_t     m_end;
 
-    std::vector<std::pair<GLintptr, GLintptr>>    m_freelist;
+    std::vector<T>              m_shadow;
+    std::vector<Slot>           m_slots;
+    std::vector<std::uint32_t>  m_owners;           // slot of each element
+    std::vector<std::uint32_t>  m_free_slots;
+    std::vector<std::uint32_t>  m_free_elements;
 
+    GLFences        m_fences;
+    FrameRing       m_ring;
 };
 
+template <typename T>
+constexpr std::uint32_t BufferStoragePool<T>::NO_ELEMENT;
+template <typename T>
+constexpr std::uint32_t BufferStoragePool<T>::NO_SLOT;
+template <typename T>
+constexpr GLuint BufferStoragePool<T>::INVALID_INDEX;
+
 } // namespace core
 
 #endif // CORE_BUFFER_STORAGE_POOL_H
-
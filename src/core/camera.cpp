@@ -24,13 +24,13 @@ namespace core
 //////////////////////////////////////////////////////////////////////////
 
 Camera::Camera(const glm::dvec3& pos, const glm::dvec3& center,
-        const CameraType camtype, shader::CameraStruct* const ptr)
+        const CameraType camtype, const CameraData ptr)
   : m_modified{true},
     m_useFixedYawAxis{false},
     m_type{camtype},
     m_position{pos},
     m_orientation{},
-    m_data{ptr}
+    m_data(ptr)
 {
     lookAt(center);
 
@@ -270,7 +270,7 @@ void Camera::update() const
     data.ProjViewMatrix = glm::mat4(m_projviewmat);
     data.CameraPosition = glm::vec4(m_position, 1.f);
 
-    std::memcpy(m_data, &data, sizeof(shader::CameraStruct));
+    std::memcpy(m_data.get(), &data, sizeof(shader::CameraStruct));
 
     m_modified = false;
 }
@@ -286,7 +286,7 @@ void Camera::update() const
 PerspectiveCamera::PerspectiveCamera(const glm::dvec3& pos,
         const glm::dvec3& center, const double fovy,
         const double aspect_ratio, const double near,
-        shader::CameraStruct* ptr)
+        CameraData ptr)
   : PerspectiveCamera(pos, center, fovy, aspect_ratio,
             near, std::numeric_limits<double>::infinity(), ptr)
 {
@@ -297,7 +297,7 @@ PerspectiveCamera::PerspectiveCamera(const glm::dvec3& pos,
 PerspectiveCamera::PerspectiveCamera(const glm::dvec3& pos,
         const glm::dvec3& center, const double fovy,
         const double aspect_ratio, const double near,
-        const double far, shader::CameraStruct* ptr)
+        const double far, CameraData ptr)
   : Camera(pos, center, CameraType::PERSPECTIVE, ptr),
     m_fovy{fovy},
     m_aspect_ratio{aspect_ratio},
@@ -470,7 +470,7 @@ bool PerspectiveCamera::inFrustum(const AABB& bbox) const
 OrthogonalCamera::OrthogonalCamera(const glm::dvec3& pos,
         const glm::dvec3& center, const double left, const double right,
         const double bottom, const double top, const double zNear,
-        const double zFar, shader::CameraStruct* ptr)
+        const double zFar, CameraData ptr)
   : Camera(pos, center, CameraType::ORTHOGONAL, ptr),
     m_left{left},
     m_right{right},
@@ -4,6 +4,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include "buffer_storage_pool.h"
+
 namespace core
 {
 
@@ -14,6 +16,8 @@ namespace shader
 struct CameraStruct;
 } // namespace shader
 
+using CameraData = BufferStoragePool<shader::CameraStruct>::Ref;
+
 enum class CameraType : unsigned char
 {
     PERSPECTIVE = 0x01,
@@ -78,7 +82,7 @@ public:
 
 protected:
     Camera(const glm::dvec3& pos, const glm::dvec3& center,
-            CameraType type, shader::CameraStruct* ptr);
+            CameraType type, CameraData ptr);
 
     virtual void updateProjMat() const = 0;
     void invalidate();
@@ -96,7 +100,7 @@ private:
     glm::dvec3              m_fixedYawAxis;
     mutable glm::dmat4      m_viewmat;
     mutable glm::dmat4      m_projviewmat;
-    shader::CameraStruct*   m_data;
+    CameraData              m_data;
 };
 
 /*************************************************************************
@@ -129,11 +133,11 @@ public:
 protected:
     PerspectiveCamera(const glm::dvec3& pos, const glm::dvec3& center,
             double fovy, double aspect_ratio, double near,
-            shader::CameraStruct* ptr);
+            CameraData ptr);
 
     PerspectiveCamera(const glm::dvec3& pos, const glm::dvec3& center,
             double fovy, double aspect_ratio, double near,
-            double far, shader::CameraStruct* ptr);
+            double far, CameraData ptr);
 
 private:
     friend class CameraManager;
@@ -184,7 +188,7 @@ public:
 protected:
     OrthogonalCamera(const glm::dvec3& pos, const glm::dvec3& center,
             double left, double right, double bottom, double top,
-            double zNear, double zFar, shader::CameraStruct* ptr);
+            double zNear, double zFar, CameraData ptr);
 
 private:
     friend class CameraManager;
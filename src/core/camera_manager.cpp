@@ -9,10 +9,10 @@ namespace core
 
 /****************************************************************************/
 
-static constexpr int MAX_CAMERAS = 1024;
+static constexpr int INITIAL_NUM_CAMERAS = 1024;
 
 CameraManager::CameraManager()
-  : m_camera_buffer(GL_SHADER_STORAGE_BUFFER, MAX_CAMERAS),
+  : m_camera_buffer(GL_SHADER_STORAGE_BUFFER, INITIAL_NUM_CAMERAS),
     m_default_cam{nullptr},
     m_isModified{true}
 {
@@ -26,17 +26,12 @@ PerspectiveCamera* CameraManager::createPerspectiveCam(const std::string& name,
         const double fovy, const double aspect_ratio,
         const double near, const double far)
 {
-    if (m_cameras.size() == MAX_CAMERAS) {
-        LOG_ERROR("Maximum number of cameras reached!");
-        abort();
-    }
     if (m_camera_names.find(name) != m_camera_names.end()) {
         LOG_ERROR("Camera already exists: ", name);
         abort();
     }
 
-    const auto offset = m_camera_buffer.alloc();
-    auto* const ptr = m_camera_buffer.offsetToPointer(offset);
+    const auto ptr = m_camera_buffer.ref(m_camera_buffer.alloc());
 
     m_cameras.emplace_back(new PerspectiveCamera(pos, center, fovy, aspect_ratio, near, far, ptr));
     m_camera_names.emplace(name, m_cameras.size());
@@ -57,17 +52,12 @@ OrthogonalCamera* CameraManager::createOrthogonalCam(const std::string& name,
             const double bottom, const double top,
             const double zNear, const double zFar)
 {
-    if (m_cameras.size() == MAX_CAMERAS) {
-        LOG_ERROR("Maximum number of cameras reached!");
-        abort();
-    }
     if (m_camera_names.find(name) != m_camera_names.end()) {
         LOG_ERROR("Camera already exists: ", name);
         abort();
     }
 
-    const auto offset = m_camera_buffer.alloc();
-    auto* const ptr = m_camera_buffer.offsetToPointer(offset);
+    const auto ptr = m_camera_buffer.ref(m_camera_buffer.alloc());
 
     m_cameras.emplace_back(new OrthogonalCamera(pos, center, left, right, bottom, top, zNear, zFar, ptr));
     m_camera_names.emplace(name, m_cameras.size());
@@ -107,10 +97,8 @@ void CameraManager::makeDefault(const Camera* cam)
         return;
     m_default_cam = const_cast<Camera*>(cam);
     if (m_default_cam != nullptr) {
-        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, bindings::CAMERA,
-                m_camera_buffer.buffer(),
-                m_camera_buffer.pointerToOffset(cam->m_data),
-                sizeof(shader::CameraStruct));
+        m_camera_buffer.bind(GL_SHADER_STORAGE_BUFFER, bindings::CAMERA,
+                cam->m_data.handle());
     }
 }
 
@@ -157,4 +145,13 @@ bool CameraManager::update()
 
 /****************************************************************************/
 
+// the default camera is bound in the new region
+void CameraManager::flush()
+{
+    m_camera_buffer.flush();
+    makeDefault(m_default_cam);
+}
+
+/****************************************************************************/
+
 } // namespace core
@@ -44,6 +44,8 @@ public:
     bool isModified() const;
     void setModified();
     bool update();
+    // once per frame, see BufferStoragePool::flush()
+    void flush();
 
 private:
     using CameraMap = std::unordered_map<std::string, std::size_t>;
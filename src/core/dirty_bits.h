@@ -0,0 +1,58 @@
+#ifndef CORE_DIRTY_BITS_H
+#define CORE_DIRTY_BITS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace core
+{
+
+// One bit per index, e.g. per element of a BufferStoragePool, visited in
+// index order. No OpenGL in here.
+class DirtyBits
+{
+public:
+    DirtyBits()
+      : m_any{false}
+    {
+    }
+
+    void set(const std::size_t index)
+    {
+        if (index / 64 >= m_words.size())
+            m_words.resize(index / 64 + 1, 0);
+        m_words[index / 64] |= std::uint64_t(1) << (index % 64);
+        m_any = true;
+    }
+
+    bool any() const
+    {
+        return m_any;
+    }
+
+    // calls f(index) for every set bit, in increasing order, and clears them
+    template <typename F>
+    void consume(F f)
+    {
+        if (!m_any)
+            return;
+        for (std::size_t word = 0; word < m_words.size(); ++word) {
+            std::uint64_t bits = m_words[word];
+            m_words[word] = 0;
+            while (bits != 0) {
+                f(64 * word + static_cast<std::size_t>(__builtin_ctzll(bits)));
+                bits &= bits - 1;
+            }
+        }
+        m_any = false;
+    }
+
+private:
+    std::vector<std::uint64_t>  m_words;
+    bool                        m_any;
+};
+
+} // namespace core
+
+#endif // CORE_DIRTY_BITS_H
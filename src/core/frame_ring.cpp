@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cassert>
+
+#include "frame_ring.h"
+
+namespace core
+{
+
+/****************************************************************************/
+
+FrameRing::FrameRing(const unsigned int num_regions, Backend& backend,
+        const std::size_t max_gap)
+  : m_backend(backend),
+    m_max_gap{max_gap},
+    m_current{0},
+    m_frame{0},
+    m_fenced(num_regions, false),
+    m_dirty(num_regions)
+{
+    assert(num_regions > 0);
+}
+
+/****************************************************************************/
+
+FrameRing::~FrameRing() = default;
+
+/****************************************************************************/
+
+void FrameRing::markDirty(const std::uint32_t element)
+{
+    if (element >= m_marked.size())
+        m_marked.resize(std::max<std::size_t>(element + 1, 2 * m_marked.size()), 0);
+    // once per frame
+    if (m_marked[element] == m_frame + 1)
+        return;
+    m_marked[element] = m_frame + 1;
+    m_dirty[m_frame % m_dirty.size()].push_back(element);
+}
+
+/****************************************************************************/
+
+void FrameRing::markDirty(const std::uint32_t begin, const std::uint32_t end)
+{
+    for (std::uint32_t element = begin; element < end; ++element) {
+        markDirty(element);
+    }
+}
+
+/****************************************************************************/
+
+const std::vector<FrameRing::Range>& FrameRing::advance()
+{
+    const auto num_regions = static_cast<unsigned int>(m_dirty.size());
+
+    m_backend.fence(m_current);
+    m_fenced[m_current] = true;
+    m_current = (m_current + 1) % num_regions;
+    if (m_fenced[m_current]) {
+        m_backend.wait(m_current);
+        m_fenced[m_current] = false;
+    }
+
+    // the region was written 'num_regions' frames ago, it misses the
+    // changes of all frames in the ring
+    m_elements.clear();
+    for (const auto& dirty : m_dirty) {
+        m_elements.insert(m_elements.end(), dirty.begin(), dirty.end());
+    }
+    std::sort(m_elements.begin(), m_elements.end());
+    m_elements.erase(std::unique(m_elements.begin(), m_elements.end()), m_elements.end());
+
+    m_ranges.clear();
+    for (const auto element : m_elements) {
+        if (!m_ranges.empty() && element - m_ranges.back().end <= m_max_gap) {
+            m_ranges.back().end = element + std::size_t(1);
+        } else {
+            m_ranges.push_back(Range{element, element + std::size_t(1)});
+        }
+    }
+
+    // the oldest frame has reached every region
+    ++m_frame;
+    m_dirty[m_frame % num_regions].clear();
+
+    return m_ranges;
+}
+
+/****************************************************************************/
+
+unsigned int FrameRing::getCurrent() const
+{
+    return m_current;
+}
+
+/****************************************************************************/
+
+unsigned int FrameRing::getNumRegions() const
+{
+    return static_cast<unsigned int>(m_dirty.size());
+}
+
+/****************************************************************************/
+
+} // namespace core
@@ -0,0 +1,85 @@
+#ifndef CORE_FRAME_RING_H
+#define CORE_FRAME_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace core
+{
+
+/*
+ * Bookkeeping for data that is written by the CPU every frame and read by
+ * the GPU: the buffer holds one region per frame in flight, the CPU writes
+ * the next region while the GPU still reads the previous ones. A region is
+ * fenced when the ring moves on and waited for before it is written again.
+ * Changes are tracked per element, advance() returns the ranges that the
+ * new region misses. Fences are left to the Backend, so nothing in here
+ * touches OpenGL.
+ */
+class FrameRing
+{
+public:
+    struct Range
+    {
+        std::size_t begin;      // elements
+        std::size_t end;
+    };
+
+    class Backend
+    {
+    public:
+        virtual ~Backend() = default;
+        // after the commands that read 'region'
+        virtual void fence(unsigned int region) = 0;
+        // blocks until they're done and drops the fence
+        virtual void wait(unsigned int region) = 0;
+    };
+
+    // ranges with at most 'max_gap' unchanged elements in between are merged,
+    // copying a few elements is cheaper than another flush
+    FrameRing(unsigned int num_regions, Backend& backend, std::size_t max_gap = 0);
+    ~FrameRing();
+
+    void markDirty(std::uint32_t element);
+    void markDirty(std::uint32_t begin, std::uint32_t end);
+
+    // Fences the current region, moves on to the next one and waits until
+    // the GPU is done with it. Returns the sorted, coalesced ranges that
+    // were changed since it was written.
+    const std::vector<Range>& advance();
+
+    unsigned int getCurrent() const;
+    unsigned int getNumRegions() const;
+
+private:
+    Backend&                                m_backend;
+    std::size_t                             m_max_gap;
+    unsigned int                            m_current;
+    std::uint64_t                           m_frame;
+    std::vector<bool>                       m_fenced;
+    std::vector<std::vector<std::uint32_t>> m_dirty;        // per frame in the ring
+    std::vector<std::uint64_t>              m_marked;       // per element, frame + 1
+    std::vector<std::uint32_t>              m_elements;
+    std::vector<Range>                      m_ranges;
+};
+
+/****************************************************************************/
+
+// Copies the elements in 'ranges' from 'src' to the same elements of 'dst'
+// and calls flush(offset, size), in bytes relative to 'dst', for each range.
+template <typename T, typename F>
+void copyRanges(const std::vector<FrameRing::Range>& ranges, const T* src, void* dst, F flush)
+{
+    for (const auto& range : ranges) {
+        const auto offset = range.begin * sizeof(T);
+        const auto size = (range.end - range.begin) * sizeof(T);
+        std::memcpy(static_cast<char*>(dst) + offset, src + range.begin, size);
+        flush(offset, size);
+    }
+}
+
+} // namespace core
+
+#endif // CORE_FRAME_RING_H
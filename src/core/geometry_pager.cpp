@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cassert>
+
+#include "geometry_pager.h"
+
+namespace core
+{
+
+/****************************************************************************/
+
+constexpr std::size_t GeometryPager::NO_PAGE;
+
+/****************************************************************************/
+
+GeometryPager::GeometryPager(const std::size_t num_pages, const std::size_t page_size,
+        Backend& backend)
+  : m_backend(backend),
+    m_page_size{page_size},
+    m_frame{1},
+    m_pages(num_pages)
+{
+    assert(page_size > 0);
+}
+
+/****************************************************************************/
+
+GeometryPager::~GeometryPager() = default;
+
+/****************************************************************************/
+
+GeometryPager::Id GeometryPager::addResource(const std::size_t size)
+{
+    const auto id = static_cast<Id>(m_resources.size());
+    m_resources.push_back(Resource{(size + m_page_size - 1) / m_page_size,
+            NO_PAGE, 0, 0, .0f, false});
+    return id;
+}
+
+/****************************************************************************/
+
+bool GeometryPager::load(const Id id)
+{
+    if (m_resources[id].first_page != NO_PAGE)
+        return true;
+    return place(id);
+}
+
+/****************************************************************************/
+
+void GeometryPager::request(const Id id, const float distance, const bool visible)
+{
+    auto& resource = m_resources[id];
+    if (resource.requested != m_frame) {
+        resource.requested = m_frame;
+        resource.distance = distance;
+        resource.visible = visible;
+        m_requests.push_back(id);
+    } else {
+        resource.distance = std::min(resource.distance, distance);
+        resource.visible |= visible;
+    }
+}
+
+/****************************************************************************/
+
+bool GeometryPager::update(const std::size_t max_pages)
+{
+    for (const Id id : m_requests) {
+        auto& resource = m_resources[id];
+        if (resource.visible)
+            resource.last_visible = m_frame;
+    }
+
+    // visible ones first, nearest first
+    std::sort(m_requests.begin(), m_requests.end(),
+            [this] (const Id id0, const Id id1) -> bool
+            {
+                const auto& r0 = m_resources[id0];
+                const auto& r1 = m_resources[id1];
+                if (r0.visible != r1.visible)
+                    return r0.visible;
+                return r0.distance < r1.distance;
+            });
+
+    std::vector<Id> victims;
+    bool changed = false;
+    // uploaded and evicted
+    std::size_t pages = 0;
+    for (const Id id : m_requests) {
+        const auto& resource = m_resources[id];
+        if (resource.first_page != NO_PAGE || resource.num_pages > m_pages.getSize())
+            continue;
+        if (pages > 0 && pages + resource.num_pages > max_pages)
+            break;
+
+        bool placed = place(id);
+        if (!placed && resource.visible && findVictims(resource.num_pages, victims)) {
+            std::size_t evicted = 0;
+            for (const Id victim : victims) {
+                evicted += m_resources[victim].num_pages;
+            }
+            if (pages > 0 && pages + evicted + resource.num_pages > max_pages)
+                break;
+            for (const Id victim : victims) {
+                evict(victim);
+            }
+            pages += evicted;
+            changed = true;
+            // the victims and the free pages around them are one block now
+            placed = place(id);
+            assert(placed);
+        }
+        if (!placed)
+            continue;
+
+        pages += resource.num_pages;
+        changed = true;
+    }
+
+    m_requests.clear();
+    ++m_frame;
+
+    return changed;
+}
+
+/****************************************************************************/
+
+bool GeometryPager::isResident(const Id id) const
+{
+    return m_resources[id].first_page != NO_PAGE;
+}
+
+/****************************************************************************/
+
+std::size_t GeometryPager::getFirstPage(const Id id) const
+{
+    return m_resources[id].first_page;
+}
+
+/****************************************************************************/
+
+std::size_t GeometryPager::getNumPages() const
+{
+    return m_pages.getSize();
+}
+
+/****************************************************************************/
+
+std::size_t GeometryPager::getNumFreePages() const
+{
+    return m_pages.getFreeSize();
+}
+
+/****************************************************************************/
+
+std::size_t GeometryPager::getPageSize() const
+{
+    return m_page_size;
+}
+
+const BufferAllocator& GeometryPager::getAllocator() const
+{
+    return m_pages;
+}
+
+/****************************************************************************/
+
+bool GeometryPager::place(const Id id)
+{
+    auto& resource = m_resources[id];
+    if (resource.num_pages > m_pages.getFreeSize())
+        return false;
+    const auto first_page = m_pages.alloc(resource.num_pages);
+    if (first_page == BufferAllocator::INVALID_OFFSET)
+        return false;
+    resource.first_page = first_page;
+    m_backend.upload(id, first_page);
+    return true;
+}
+
+/****************************************************************************/
+
+// The contiguous run of free pages and resources that weren't visible this
+// frame with the oldest newest victim, then with the fewest evicted pages.
+// Runs start at a resource or a free block, shifting them to the right
+// never saves a victim.
+bool GeometryPager::findVictims(const std::size_t num_pages, std::vector<Id>& victims) const
+{
+    struct Segment
+    {
+        std::size_t     begin;
+        std::size_t     end;
+        Id              id;         // NO_ID: free
+        bool            evictable;
+    };
+    constexpr Id NO_ID = static_cast<Id>(-1);
+
+    std::vector<Id> residents;
+    for (Id i = 0; i < m_resources.size(); ++i) {
+        if (m_resources[i].first_page != NO_PAGE)
+            residents.push_back(i);
+    }
+    std::sort(residents.begin(), residents.end(),
+            [this] (const Id id0, const Id id1) -> bool
+            {
+                return m_resources[id0].first_page < m_resources[id1].first_page;
+            });
+
+    std::vector<Segment> segments;
+    std::size_t end = 0;
+    for (const Id i : residents) {
+        const auto& r = m_resources[i];
+        if (r.first_page > end)
+            segments.push_back(Segment{end, r.first_page, NO_ID, true});
+        end = r.first_page + r.num_pages;
+        segments.push_back(Segment{r.first_page, end, i, r.last_visible != m_frame});
+    }
+    if (m_pages.getSize() > end)
+        segments.push_back(Segment{end, m_pages.getSize(), NO_ID, true});
+
+    bool found = false;
+    std::size_t best_begin = 0;
+    std::size_t best_end = 0;
+    std::uint64_t best_newest = 0;
+    std::size_t best_evicted = 0;
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        std::uint64_t newest = 0;
+        std::size_t evicted = 0;
+        for (std::size_t j = i; j < segments.size() && segments[j].evictable; ++j) {
+            const auto& segment = segments[j];
+            if (segment.id != NO_ID) {
+                newest = std::max(newest, m_resources[segment.id].last_visible);
+                evicted += segment.end - segment.begin;
+            }
+            if (segment.end - segments[i].begin < num_pages)
+                continue;
+            if (!found || newest < best_newest ||
+                    (newest == best_newest && evicted < best_evicted))
+            {
+                found = true;
+                best_begin = i;
+                best_end = j + 1;
+                best_newest = newest;
+                best_evicted = evicted;
+            }
+            break;
+        }
+    }
+
+    victims.clear();
+    for (std::size_t i = best_begin; i < best_end; ++i) {
+        if (segments[i].id != NO_ID)
+            victims.push_back(segments[i].id);
+    }
+    return found;
+}
+
+/****************************************************************************/
+
+void GeometryPager::evict(const Id id)
+{
+    auto& resource = m_resources[id];
+    m_pages.free(resource.first_page);
+    resource.first_page = NO_PAGE;
+    m_backend.evict(id);
+}
+
+/****************************************************************************/
+
+} // namespace core
@@ -0,0 +1,85 @@
+#ifndef CORE_GEOMETRY_PAGER_H
+#define CORE_GEOMETRY_PAGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "buffer_allocator.h"
+
+namespace core
+{
+
+/*
+ * Residency of resources (meshes) in a pool of fixed-size pages. A resident
+ * resource occupies a contiguous run of pages, placed by a BufferAllocator
+ * in page units. Every frame the resources are requested with their
+ * distance to the camera: visible ones are loaded nearest first and evict
+ * the least recently visible ones that make room for them, invisible ones
+ * only use free pages. Copying the data is left to the Backend, so nothing
+ * in here touches OpenGL.
+ */
+class GeometryPager
+{
+public:
+    using Id = std::uint32_t;
+    static constexpr std::size_t NO_PAGE = static_cast<std::size_t>(-1);
+
+    class Backend
+    {
+    public:
+        virtual ~Backend() = default;
+        // copies the resource into the pool, starting at 'first_page'
+        virtual void upload(Id id, std::size_t first_page) = 0;
+        virtual void evict(Id id) = 0;
+    };
+
+    GeometryPager(std::size_t num_pages, std::size_t page_size, Backend& backend);
+    ~GeometryPager();
+
+    Id addResource(std::size_t size);
+    // only uses free pages, returns true if the resource is resident
+    bool load(Id id);
+
+    // the smallest distance per resource and frame counts
+    void request(Id id, float distance, bool visible);
+    // uploads and evicts up to 'max_pages' (at least one resource) and
+    // starts a new frame, returns true if anything was uploaded or evicted
+    bool update(std::size_t max_pages);
+
+    bool isResident(Id id) const;
+    std::size_t getFirstPage(Id id) const;
+    std::size_t getNumPages() const;
+    std::size_t getNumFreePages() const;
+    std::size_t getPageSize() const;
+    const BufferAllocator& getAllocator() const;
+
+private:
+    struct Resource
+    {
+        std::size_t     num_pages;
+        std::size_t     first_page;
+        std::uint64_t   last_visible;   // frame, 0: never
+        std::uint64_t   requested;      // frame
+        float           distance;
+        bool            visible;
+    };
+
+    // returns false if there's no free run of pages
+    bool place(Id id);
+    // resident resources whose pages, with the free ones around them, hold
+    // 'num_pages' in one run; returns false if there are none
+    bool findVictims(std::size_t num_pages, std::vector<Id>& victims) const;
+    void evict(Id id);
+
+    Backend&                m_backend;
+    std::size_t             m_page_size;
+    std::uint64_t           m_frame;
+    BufferAllocator         m_pages;
+    std::vector<Resource>   m_resources;
+    std::vector<Id>         m_requests;
+};
+
+} // namespace core
+
+#endif // CORE_GEOMETRY_PAGER_H
@@ -0,0 +1,68 @@
+#include "gl_fences.h"
+#include "log/log.h"
+
+namespace core
+{
+
+/****************************************************************************/
+
+namespace
+{
+
+constexpr GLuint64 WAIT_TIMEOUT = 1000000000; // 1s
+
+} // anonymous namespace
+
+/****************************************************************************/
+
+GLFences::GLFences(const unsigned int num_regions)
+  : m_fences(num_regions, nullptr)
+{
+}
+
+/****************************************************************************/
+
+GLFences::~GLFences()
+{
+    for (auto fence : m_fences) {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+    }
+}
+
+/****************************************************************************/
+
+void GLFences::fence(const unsigned int region)
+{
+    if (m_fences[region] != nullptr)
+        glDeleteSync(m_fences[region]);
+    m_fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/****************************************************************************/
+
+void GLFences::wait(const unsigned int region)
+{
+    GLsync fence = m_fences[region];
+    if (fence == nullptr)
+        return;
+
+    // the first wait flushes, so the fence is guaranteed to signal
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    for (;;) {
+        const GLenum result = glClientWaitSync(fence, flags, WAIT_TIMEOUT);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+            break;
+        if (result == GL_WAIT_FAILED) {
+            LOG_ERROR("glClientWaitSync failed");
+            break;
+        }
+        flags = 0;
+    }
+    glDeleteSync(fence);
+    m_fences[region] = nullptr;
+}
+
+/****************************************************************************/
+
+} // namespace core
@@ -0,0 +1,29 @@
+#ifndef CORE_GL_FENCES_H
+#define CORE_GL_FENCES_H
+
+#include <vector>
+
+#include "gl/gl_sys.h"
+#include "frame_ring.h"
+
+namespace core
+{
+
+// FrameRing::Backend with glFenceSync(), one sync object per region.
+class GLFences
+  : public FrameRing::Backend
+{
+public:
+    explicit GLFences(unsigned int num_regions);
+    virtual ~GLFences();
+
+    virtual void fence(unsigned int region) override final;
+    virtual void wait(unsigned int region) override final;
+
+private:
+    std::vector<GLsync>     m_fences;
+};
+
+} // namespace core
+
+#endif // CORE_GL_FENCES_H
@@ -2,6 +2,7 @@
 #include "mesh.h"
 #include "material.h"
 #include "instance_manager.h"
+#include "scene_graph.h"
 #include "aabb.h"
 
 namespace core
@@ -10,30 +11,35 @@ namespace core
 /****************************************************************************/
 
 Instance::Instance(const Mesh* mesh, const Material* material,
-        const GLuint index, shader::InstanceStruct* data)
+        const InstanceData data, TransformStore& transforms)
   : m_update_members{true},
-    m_transformation{},
-    m_bbox{},
-    m_position{.0f},
-    m_scale{1.f},
-    m_orientation{},
+    m_transforms(transforms),
+    m_transform{transforms.add()},
     m_fixedYawAxis{false},
     m_hasFixedYawAxis{},
-    m_modified{true},
+    m_modified{false},
     m_mesh{mesh},
     m_material{material},
-    m_index{index},
-    m_data{data}
+    m_data(data),
+    m_node{NO_NODE}
 {
+    m_transforms.setBounds(m_transform, m_mesh->bbox());
     setModified();
 }
 
 /****************************************************************************/
 
+Instance::~Instance()
+{
+    m_transforms.remove(m_transform);
+}
+
+/****************************************************************************/
+
 const glm::mat4& Instance::getTransformationMatrix() const
 {
     updateMembers();
-    return m_transformation;
+    return m_transforms.getWorld(m_transform);
 }
 
 /****************************************************************************/
@@ -41,14 +47,28 @@ const glm::mat4& Instance::getTransformationMatrix() const
 const AABB& Instance::getBoundingBox() const
 {
     updateMembers();
-    return m_bbox;
+    return m_transforms.getWorldBounds(m_transform);
+}
+
+/****************************************************************************/
+
+glm::mat4 Instance::getLocalTransformation() const
+{
+    return m_transforms.getLocalTransformation(m_transform);
+}
+
+/****************************************************************************/
+
+NodeId Instance::getNode() const
+{
+    return m_node;
 }
 
 /****************************************************************************/
 
 void Instance::move(const glm::vec3& dir)
 {
-    m_position += dir;
+    m_transforms.setPosition(m_transform, getPosition() + dir);
     setModified();
 }
 
@@ -56,51 +76,51 @@ void Instance::move(const glm::vec3& dir)
 
 void Instance::setPosition(const glm::vec3& pos)
 {
-    m_position = pos;
+    m_transforms.setPosition(m_transform, pos);
     setModified();
 }
 
 /****************************************************************************/
 
-const glm::vec3& Instance::getPosition() const
+glm::vec3 Instance::getPosition() const
 {
-    return m_position;
+    return m_transforms.getPosition(m_transform);
 }
 
 /****************************************************************************/
 
 void Instance::setOrientation(const glm::quat& orientation)
 {
-    m_orientation = glm::normalize(orientation);
+    m_transforms.setOrientation(m_transform, glm::normalize(orientation));
     setModified();
 }
 
 /****************************************************************************/
 
-const glm::quat& Instance::getOrientation() const
+glm::quat Instance::getOrientation() const
 {
-    return m_orientation;
+    return m_transforms.getOrientation(m_transform);
 }
 
 /****************************************************************************/
 
 glm::vec3 Instance::getForward() const
 {
-    return m_orientation * glm::vec3(.0f, .0f, 1.f);
+    return getOrientation() * glm::vec3(.0f, .0f, 1.f);
 }
 
 /****************************************************************************/
 
 glm::vec3 Instance::getRight() const
 {
-    return m_orientation * glm::vec3(1.f, .0f, .0f);
+    return getOrientation() * glm::vec3(1.f, .0f, .0f);
 }
 
 /****************************************************************************/
 
 glm::vec3 Instance::getUp() const
 {
-    return m_orientation * glm::vec3(.0f, 1.f, .0f);
+    return getOrientation() * glm::vec3(.0f, 1.f, .0f);
 }
 
 /****************************************************************************/
@@ -108,8 +128,7 @@ glm::vec3 Instance::getUp() const
 void Instance::rotate(const glm::vec3& axis, float angle)
 {
     glm::quat q = glm::angleAxis(angle, glm::normalize(axis));
-    m_orientation = glm::normalize(m_orientation * q);
-    setModified();
+    setOrientation(getOrientation() * q);
 }
 
 /****************************************************************************/
@@ -117,41 +136,38 @@ void Instance::rotate(const glm::vec3& axis, float angle)
 void Instance::yaw(float angle)
 {
     if (m_hasFixedYawAxis) {
-        m_orientation = glm::normalize(glm::angleAxis(angle, m_fixedYawAxis) * m_orientation);
+        setOrientation(glm::angleAxis(angle, m_fixedYawAxis) * getOrientation());
     } else {
-        m_orientation = glm::normalize(m_orientation * glm::angleAxis(angle, glm::vec3(.0f, 1.f, .0f)));
+        setOrientation(getOrientation() * glm::angleAxis(angle, glm::vec3(.0f, 1.f, .0f)));
     }
-    setModified();
 }
 
 /****************************************************************************/
 
 void Instance::roll(float angle)
 {
-    m_orientation = glm::normalize(m_orientation * glm::angleAxis(angle, glm::vec3(.0f, .0f, 1.f)));
-    setModified();
+    setOrientation(getOrientation() * glm::angleAxis(angle, glm::vec3(.0f, .0f, 1.f)));
 }
 
 /****************************************************************************/
 
 void Instance::pitch(float angle)
 {
-    m_orientation = glm::normalize(m_orientation * glm::angleAxis(angle, glm::vec3(1.f, .0f, .0f)));
-    setModified();
+    setOrientation(getOrientation() * glm::angleAxis(angle, glm::vec3(1.f, .0f, .0f)));
 }
 
 /****************************************************************************/
 
-const glm::vec3& Instance::getScale() const
+glm::vec3 Instance::getScale() const
 {
-    return m_scale;
+    return m_transforms.getScale(m_transform);
 }
 
 /****************************************************************************/
 
 void Instance::setScale(const glm::vec3& scale)
 {
-    m_scale = scale;
+    m_transforms.setScale(m_transform, scale);
     setModified();
 }
 
@@ -192,9 +208,13 @@ bool Instance::modified() const
 
 void Instance::setModified()
 {
-    m_modified = true;
     m_update_members = true;
-    res::instances->setModified();
+    if (!m_modified) {
+        m_modified = true;
+        res::instances->setModified(this);
+    }
+    if (m_node != NO_NODE)
+        res::scene_graph->setModified(m_node);
 }
 
 /****************************************************************************/
@@ -206,15 +226,20 @@ void Instance::update()
 
         update_impl();
 
-        m_data->ModelMatrix = m_transformation;
-        m_data->MeshID = m_mesh->index();
-        m_data->MaterialID = m_material->getIndex();
-        m_data->BBox_min[0] = m_bbox.pmin.x;
-        m_data->BBox_min[1] = m_bbox.pmin.y;
-        m_data->BBox_min[2] = m_bbox.pmin.z;
-        m_data->BBox_max[0] = m_bbox.pmax.x;
-        m_data->BBox_max[1] = m_bbox.pmax.y;
-        m_data->BBox_max[2] = m_bbox.pmax.z;
+        const auto& bbox = m_transforms.getWorldBounds(m_transform);
+
+        // one write, the pool tracks the element once
+        shader::InstanceStruct data;
+        data.ModelMatrix = m_transforms.getWorld(m_transform);
+        data.MeshID = m_mesh->index();
+        data.MaterialID = m_material->getIndex();
+        data.BBox_min[0] = bbox.pmin.x;
+        data.BBox_min[1] = bbox.pmin.y;
+        data.BBox_min[2] = bbox.pmin.z;
+        data.BBox_max[0] = bbox.pmax.x;
+        data.BBox_max[1] = bbox.pmax.y;
+        data.BBox_max[2] = bbox.pmax.z;
+        *m_data = data;
 
         m_modified = false;
     }
@@ -230,7 +255,7 @@ void Instance::update_impl()
 
 GLuint Instance::getIndex() const
 {
-    return m_index;
+    return m_data.index();
 }
 
 /****************************************************************************/
@@ -245,6 +270,7 @@ const Mesh* Instance::getMesh() const
 void Instance::setMesh(const Mesh* mesh)
 {
     m_mesh = mesh;
+    m_transforms.setBounds(m_transform, m_mesh->bbox());
     setModified();
 }
 
@@ -265,40 +291,30 @@ void Instance::setMaterial(const Material* material)
 
 /****************************************************************************/
 
+// instances in the scene graph are updated by SceneGraph::update(), the
+// others in a batch by InstanceManager::update()
 void Instance::updateMembers() const
 {
-    if (!m_update_members) {
+    if (!m_update_members || m_node != NO_NODE) {
         return;
     }
-    // transformation matrix
-    glm::mat4 translation;
-    translation[3] = glm::vec4(m_position, 1.f);
-    m_transformation = translation * glm::mat4_cast(m_orientation);
-    m_transformation[0] *= m_scale.x;
-    m_transformation[1] *= m_scale.y;
-    m_transformation[2] *= m_scale.z;
-
-    // bounding box
-    AABB bbox = m_mesh->bbox();
-    bbox.pmin *= m_scale;
-    bbox.pmax *= m_scale;
-
-    m_bbox = AABB();
-    for (int i = 0; i < 8; ++i) {
-        glm::vec3 p{glm::ctor::uninitialize};
-        p[0] = (i & 0x01) ? bbox.pmin[0] : bbox.pmax[0];
-        p[1] = (i & 0x02) ? bbox.pmin[1] : bbox.pmax[1];
-        p[2] = (i & 0x04) ? bbox.pmin[2] : bbox.pmax[2];
-
-        m_bbox.expandBy(m_orientation * p);
-    }
-    m_bbox.pmin += m_position;
-    m_bbox.pmax += m_position;
+    m_transforms.compose(&m_transform, 1);
 
     m_update_members = false;
 }
 
 /****************************************************************************/
 
+void Instance::worldModified()
+{
+    m_update_members = false;
+    if (!m_modified) {
+        m_modified = true;
+        res::instances->setModified(this);
+    }
+}
+
+/****************************************************************************/
+
 } // namespace core
 
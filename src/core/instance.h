@@ -7,6 +7,9 @@
 #include "gl/gl_sys.h"
 #include "aabb.h"
 #include "shader_interface.h"
+#include "buffer_storage_pool.h"
+#include "scene_graph.h"
+#include "transform_store.h"
 
 namespace core
 {
@@ -14,21 +17,30 @@ namespace core
 class Mesh;
 class Material;
 
+using InstanceData = BufferStoragePool<shader::InstanceStruct>::Ref;
+
+// The transformation lives in the manager's TransformStore.
 class Instance
 {
 public:
-    virtual ~Instance() = default;
+    virtual ~Instance();
 
+    // World space; for instances in the scene graph, both are valid after
+    // SceneGraph::update().
     const glm::mat4& getTransformationMatrix() const;
     const AABB& getBoundingBox() const;
 
+    // position, orientation and scale, relative to the parent node
+    glm::mat4 getLocalTransformation() const;
+    NodeId getNode() const;
+
     void move(const glm::vec3& dir);
 
     void setPosition(const glm::vec3& pos);
-    const glm::vec3& getPosition() const;
+    glm::vec3 getPosition() const;
 
     void setOrientation(const glm::quat& orientation);
-    const glm::quat& getOrientation() const;
+    glm::quat getOrientation() const;
 
     glm::vec3 getForward() const;
     glm::vec3 getRight() const;
@@ -43,7 +55,7 @@ public:
     bool hasFixedYawAxis() const;
     const glm::vec3& getFixedYawAxis() const;
 
-    const glm::vec3& getScale() const;
+    glm::vec3 getScale() const;
     void setScale(const glm::vec3& scale);
 
     bool modified() const;
@@ -61,30 +73,30 @@ public:
 
 protected:
     friend class InstanceManager;
-    Instance(const Mesh* mesh, const Material* material, GLuint index,
-            shader::InstanceStruct* data);
+    friend class SceneGraph;
+    Instance(const Mesh* mesh, const Material* material, InstanceData data,
+            TransformStore& transforms);
 
     virtual void update_impl();
 
 
 private:
     void updateMembers() const;
+    // after SceneGraph::update() composed the transformation
+    void worldModified();
 
-    mutable bool            m_update_members;
-    mutable glm::mat4       m_transformation;
-    mutable AABB            m_bbox;
+    mutable bool    m_update_members;
+    TransformStore& m_transforms;
+    TransformId     m_transform;
 
-    glm::vec3       m_position;
-    glm::vec3       m_scale;
-    glm::quat       m_orientation;
     glm::vec3       m_fixedYawAxis;
     bool            m_hasFixedYawAxis;
     bool            m_modified;
     const Mesh*     m_mesh;
     const Material* m_material;
 
-    GLuint                      m_index;
-    shader::InstanceStruct*     m_data;
+    InstanceData    m_data;
+    NodeId          m_node;
 };
 
 } // namespace core
@@ -6,10 +6,9 @@ namespace core
 
 /****************************************************************************/
 
-constexpr int MAX_NUM_INSTANCES = 12000;
+constexpr int INITIAL_NUM_INSTANCES = 12000;
 InstanceManager::InstanceManager()
-  : m_instance_buffer(GL_SHADER_STORAGE_BUFFER, MAX_NUM_INSTANCES),
-    m_isModified{true}
+  : m_instance_buffer(GL_SHADER_STORAGE_BUFFER, INITIAL_NUM_INSTANCES)
 {
 }
 
@@ -31,13 +30,11 @@ Instance* InstanceManager::addInstance(const std::string& name,
         return inst;
     }
 
-    const GLintptr offset = m_instance_buffer.alloc();
-    const GLuint index = m_instance_buffer.offsetToIndex(offset); 
-    auto* const ptr = m_instance_buffer.offsetToPointer(offset);
+    const auto data = m_instance_buffer.ref(m_instance_buffer.alloc());
 
     auto res = m_instances.emplace(name,
-            std::unique_ptr<Instance>(new Instance(mesh, material,
-                    index, static_cast<shader::InstanceStruct*>(ptr))));
+            std::unique_ptr<Instance>(new Instance(mesh, material, data, m_transforms)));
+    m_ordered.push_back(res.first->second.get());
     return res.first->second.get();
 }
 
@@ -89,36 +86,82 @@ std::vector<const Instance*> InstanceManager::getInstances() const
 
 /****************************************************************************/
 
+std::vector<const Instance*> InstanceManager::getInstancesSince(const std::size_t first) const
+{
+    if (first >= m_ordered.size())
+        return {};
+    return std::vector<const Instance*>(m_ordered.begin() + static_cast<long>(first),
+            m_ordered.end());
+}
+
+/****************************************************************************/
+
+std::size_t InstanceManager::getNumInstances() const
+{
+    return m_ordered.size();
+}
+
+/****************************************************************************/
+
 bool InstanceManager::isModified() const
 {
-    return m_isModified;
+    return m_modified.any();
 }
 
 /****************************************************************************/
 
-void InstanceManager::setModified()
+void InstanceManager::setModified(Instance* const instance)
 {
-    m_isModified = true;
+    const auto index = static_cast<std::size_t>(instance->getIndex());
+    if (index >= m_by_index.size())
+        m_by_index.resize(index + 1, nullptr);
+    m_by_index[index] = instance;
+    m_modified.set(index);
 }
 
 /****************************************************************************/
 
 bool InstanceManager::update()
 {
-    if (!m_isModified)
+    if (!m_modified.any())
         return false;
-    for (auto& instance : m_instances) {
-        instance.second->update();
+
+    // in buffer order, so the pool writes few contiguous ranges
+    m_updates.clear();
+    m_modified.consume([this] (const std::size_t index)
+            {
+                m_updates.push_back(m_by_index[index]);
+            });
+
+    // the scene graph has done the instances in it
+    m_batch.clear();
+    for (const auto* instance : m_updates) {
+        if (instance->m_update_members && instance->m_node == NO_NODE) {
+            m_batch.push_back(instance->m_transform);
+            instance->m_update_members = false;
+        }
+    }
+    m_transforms.compose(m_batch.data(), m_batch.size());
+
+    for (auto* instance : m_updates) {
+        instance->update();
     }
+
     return true;
 }
 
 /****************************************************************************/
 
+void InstanceManager::flush()
+{
+    m_instance_buffer.flush();
+}
+
+/****************************************************************************/
+
 void InstanceManager::bind() const
 {
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindings::INSTANCE,
-            m_instance_buffer.buffer());
+    m_instance_buffer.bind(GL_SHADER_STORAGE_BUFFER, bindings::INSTANCE);
 }
 
 /****************************************************************************/
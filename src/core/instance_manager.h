@@ -1,6 +1,7 @@
 #ifndef CORE_INSTANCE_MANAGER_H
 #define CORE_INSTANCE_MANAGER_H
 
+#include <cstdint>
 #include <unordered_map>
 #include <string>
 #include <memory>
@@ -9,7 +10,9 @@
 #include "managers.h"
 #include "instance.h"
 #include "buffer_storage_pool.h"
+#include "dirty_bits.h"
 #include "shader_interface.h"
+#include "transform_store.h"
 
 namespace core
 {
@@ -30,19 +33,31 @@ public:
 
     std::vector<Instance*> getInstances();
     std::vector<const Instance*> getInstances() const;
+    // the instances added after the first 'first' ones
+    std::vector<const Instance*> getInstancesSince(std::size_t first) const;
+    std::size_t getNumInstances() const;
 
     bool isModified() const;
-    void setModified();
+    // called by the instance, once until the next update()
+    void setModified(Instance* instance);
+    // only updates the modified instances
     bool update();
+    // once per frame, see BufferStoragePool::flush()
+    void flush();
     void bind() const;
 
 private:
     using InstanceMap = std::unordered_map<std::string, std::unique_ptr<Instance>>;
     using InstancePool = BufferStoragePool<shader::InstanceStruct>;
 
-    InstancePool        m_instance_buffer;
-    InstanceMap         m_instances;
-    bool                m_isModified;
+    InstancePool               m_instance_buffer;
+    TransformStore             m_transforms;
+    InstanceMap                m_instances;
+    std::vector<Instance*>     m_ordered;      // in the order of addInstance()
+    std::vector<Instance*>     m_by_index;     // by buffer index
+    DirtyBits                  m_modified;     // by buffer index
+    std::vector<Instance*>     m_updates;      // see update()
+    std::vector<TransformId>   m_batch;
 };
 
 } // namespace core
@@ -18,9 +18,9 @@ namespace core
  *
  ****************************************************************************/
 
-Light::Light(shader::LightStruct* const data, const LightType type,
+Light::Light(const LightData data, const LightType type,
         const int depthTex)
-  : m_data{data},
+  : m_data(data),
     m_position{.0f},
     m_intensity{.0f},
     m_constant_attenuation{.0f},
@@ -186,7 +186,7 @@ bool Light::isShadowcasting() const
  *
  ****************************************************************************/
 
-SpotLight::SpotLight(shader::LightStruct* const data, const int depthTex)
+SpotLight::SpotLight(const LightData data, const int depthTex)
   : Light(data, LightType::SPOT, depthTex),
     m_direction{.0f, -1.f, .0f},
     m_angle_inner_cone{glm::pi<float>() / 2.f},
@@ -277,7 +277,7 @@ void SpotLight::updateMatrix()
  *
  ****************************************************************************/
 
-DirectionalLight::DirectionalLight(shader::LightStruct* const data,
+DirectionalLight::DirectionalLight(const LightData data,
         const int depthTex)
   : Light(data, LightType::DIRECTIONAL, depthTex),
     m_direction{.0f, -1.f, .0f},
@@ -368,7 +368,7 @@ void DirectionalLight::updateMatrix()
  *
  ****************************************************************************/
 
-PointLight::PointLight(shader::LightStruct* const data, const int depthTex)
+PointLight::PointLight(const LightData data, const int depthTex)
   : Light(data, LightType::POINT, depthTex)
 {
     updateMatrix();
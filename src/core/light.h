@@ -3,6 +3,8 @@
 
 #include <glm/vec3.hpp>
 
+#include "buffer_storage_pool.h"
+
 namespace core
 {
 
@@ -13,6 +15,8 @@ namespace shader
 struct LightStruct;
 } // namespace shader
 
+using LightData = BufferStoragePool<shader::LightStruct>::Ref;
+
 /****************************************************************************/
 
 enum class LightType : char
@@ -54,8 +58,8 @@ public:
     void setQuadraticAttenuation(float attenuation);
 
 protected:
-    Light(shader::LightStruct* data, LightType type, int depthTex);
-    shader::LightStruct*    m_data;
+    Light(LightData data, LightType type, int depthTex);
+    LightData               m_data;
 
     virtual void updateMatrix() = 0;
 
@@ -85,7 +89,7 @@ public:
 
 protected:
     friend class LightManager;
-    SpotLight(shader::LightStruct* data, int depthTex);
+    SpotLight(LightData data, int depthTex);
 
     virtual void updateMatrix() override;
 
@@ -112,7 +116,7 @@ public:
 
 protected:
     friend class LightManager;
-    DirectionalLight(shader::LightStruct* data, int depthTex);
+    DirectionalLight(LightData data, int depthTex);
 
     virtual void updateMatrix() override;
 
@@ -131,7 +135,7 @@ public:
 
 protected:
     friend class LightManager;
-    PointLight(shader::LightStruct* data, int depthTex);
+    PointLight(LightData data, int depthTex);
 
     virtual void updateMatrix() override;
 
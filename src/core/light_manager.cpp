@@ -95,9 +95,8 @@ LightManager::~LightManager() = default;
 
 SpotLight* LightManager::createSpotlight(const bool isShadowcasting)
 {
-    const auto offset = m_light_buffer.alloc();
-    auto* const data = m_light_buffer.offsetToPointer(offset);
-    const auto index = m_light_buffer.offsetToIndex(offset);
+    const auto data = m_light_buffer.ref(m_light_buffer.alloc());
+    const auto index = data.index();
 
     int depthTex = -1;
     if (isShadowcasting) {
@@ -128,9 +127,8 @@ SpotLight* LightManager::createSpotlight(const bool isShadowcasting)
 
 DirectionalLight* LightManager::createDirectionalLight(const bool isShadowcasting)
 {
-    const auto offset = m_light_buffer.alloc();
-    auto* const data = m_light_buffer.offsetToPointer(offset);
-    const auto index = m_light_buffer.offsetToIndex(offset);
+    const auto data = m_light_buffer.ref(m_light_buffer.alloc());
+    const auto index = data.index();
 
     int depthTex = -1;
     if (isShadowcasting) {
@@ -162,9 +160,8 @@ DirectionalLight* LightManager::createDirectionalLight(const bool isShadowcastin
 
 PointLight* LightManager::createPointLight(const bool isShadowcasting)
 {
-    const auto offset = m_light_buffer.alloc();
-    auto* const data = m_light_buffer.offsetToPointer(offset);
-    const auto index = m_light_buffer.offsetToIndex(offset);
+    const auto data = m_light_buffer.ref(m_light_buffer.alloc());
+    const auto index = data.index();
 
     int depthTex = -1;
     if (isShadowcasting) {
@@ -200,10 +197,16 @@ const LightManager::LightList& LightManager::getLights() const
 
 /****************************************************************************/
 
+void LightManager::flush()
+{
+    m_light_buffer.flush();
+}
+
+/****************************************************************************/
+
 void LightManager::bind() const
 {
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindings::LIGHT,
-            m_light_buffer.buffer());
+    m_light_buffer.bind(GL_SHADER_STORAGE_BUFFER, bindings::LIGHT);
 
     glActiveTexture(GL_TEXTURE0 + bindings::DIR_LIGHT_TEX_UNIT);
     glBindTexture(GL_TEXTURE_2D_ARRAY, m_shadowmaps);
@@ -25,6 +25,8 @@ public:
     PointLight* createPointLight(bool isShadowcasting);
 
     const LightList& getLights() const;
+    // once per frame, see BufferStoragePool::flush()
+    void flush();
     void bind() const;
 
     void setupForShadowMapRendering();
@@ -1,16 +1,24 @@
 #include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
 #include <boost/tokenizer.hpp>
 
 #include "loader.h"
 #include "import/import.h"
+#include "import/mesh_batch.h"
 #include "camera_manager.h"
 #include "texture_manager.h"
 #include "material_manager.h"
 #include "mesh_manager.h"
 #include "instance_manager.h"
 #include "light_manager.h"
-#include "aabb.h"
+#include "scene_graph.h"
 #include "framework/vars.h"
 
 #include "log/log.h"
@@ -20,103 +28,223 @@ namespace core
 
 /****************************************************************************/
 
-bool loadScenefiles(const std::string& scenefiles)
+namespace
 {
-    constexpr double FAR_PLANE = std::numeric_limits<double>::infinity();
 
-    AABB scene_bbox;
-    bool result = true;
-    boost::char_separator<char> sep(",");
-    boost::tokenizer<boost::char_separator<char>> tokens(scenefiles, sep);
-    for (const auto& file : tokens) {
-        auto scene = import::importSceneFile(file);
-        if (!scene) {
-            result = false;
-            continue;
-        }
+constexpr double FAR_PLANE = std::numeric_limits<double>::infinity();
 
-        for (unsigned int i = 0; i < scene->num_textures; ++i) {
-            const auto* tex = scene->textures[i];
-            res::textures->addTexture(tex->name, *tex->image);
-        }
-        for (unsigned int i = 0; i < scene->num_materials; ++i) {
-            const auto* mat = scene->materials[i];
-            res::materials->addMaterial(mat->name, mat, scene->textures);
-        }
-        for (unsigned int i = 0; i < scene->num_meshes; ++i) {
-            const auto* mesh = scene->meshes[i];
-            res::meshes->addMesh(mesh);
-        }
+// meshes packed and uploaded at once
+constexpr std::size_t MESHES_PER_JOB = 64;
 
-        for (unsigned int i = 0; i < scene->num_nodes; ++i) {
-            const auto* node = scene->nodes[i];
-            const auto* mesh = scene->meshes[node->mesh_index];
-            const auto* mat = scene->materials[mesh->material_index];
-            auto* inst = res::instances->addInstance(node->name,
-                    res::meshes->getMesh(mesh->name),
-                    res::materials->getMaterial(mat->name));
-            inst->move(node->position);
-            inst->setScale(node->scale);
-            inst->setOrientation(node->rotation);
-            scene_bbox.expandBy(inst->getBoundingBox());
-        }
+/****************************************************************************/
 
-        for (unsigned int i = 0; i < scene->num_cameras; i++) {
-            const auto* cam = scene->cameras[i];
-            res::cameras->createPerspectiveCam(cam->name, cam->position,
-                    cam->position + cam->direction,
-                    2.0 * glm::atan(glm::tan(glm::radians(cam->hfov) / 2.0) / cam->aspect_ratio),
-                    cam->aspect_ratio, vars.cam_nearplane, FAR_PLANE);
-        }
+long peakResidentMemoryKiB()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+    return usage.ru_maxrss;
+}
 
-        for (unsigned int i = 0; i < scene->num_lights; ++i) {
-            Light* newLight = nullptr;
-            const auto* light = scene->lights[i];
-            // name starts with "scl_" -> shadowcasting
-            const bool isShadowcasting = (std::strncmp(light->name, "scl_", 4) == 0);
-            switch (light->type) {
-            case import::LightType::SPOT:
-            {
-                auto* l = core::res::lights->createSpotlight(isShadowcasting);
-                l->setDirection(light->direction);
-                l->setAngleInnerCone(light->angle_inner_cone);
-                l->setAngleOuterCone(light->angle_outer_cone);
-                newLight = l;
-                break;
-            }
-            case import::LightType::DIRECTIONAL:
-            {
-                auto* l = core::res::lights->createDirectionalLight(isShadowcasting);
-                l->setDirection(light->direction);
-                l->setSize(1000.f); // TODO
-                l->setRotation(.0f); // TODO
-                newLight = l;
-                break;
-            }
-            case import::LightType::POINT:
-            {
-                auto* l = core::res::lights->createPointLight(isShadowcasting);
-                newLight = l;
-                break;
-            }
-            default:
-                break;
-            }
-            if (newLight != nullptr) {
-                newLight->setPosition(light->position);
-                newLight->setIntensity(light->color);
-                //newLight->setMaxDistance(light->max_distance);
-                newLight->setMaxDistance(2000.f); // TODO
-                newLight->setLinearAttenuation(light->linear_attenuation);
-                newLight->setConstantAttenuation(light->constant_attenuation);
-                newLight->setQuadraticAttenuation(light->quadratic_attenuation);
-            } else {
-                LOG_WARNING("Unsupported light type for light'",
-                        light->name, '\'');
-            }
-        }
+/****************************************************************************/
+
+// shared by the jobs of a scene file, freed with the last one
+struct LoadedScene
+{
+    using BatchKey = std::pair<std::uint32_t, std::uint32_t>; // material, vertex layout
+    using BatchMap = std::map<BatchKey, std::unique_ptr<import::MeshBatch>>;
+    using SceneRef = std::shared_ptr<import::Scene>;
+
+    std::string                file;
+    SceneRef                   scene;          // see meshSource()
+    std::vector<Mesh*>         meshes;         // by import mesh index
+    std::vector<bool>          used_meshes;
+    std::vector<std::uint32_t> num_references; // by import mesh index
+    std::vector<std::uint32_t> mesh_nodes;     // a node that references the mesh
+    std::vector<NodeId>        node_ids;
+    std::vector<glm::mat4>     world;          // by node
+    BatchMap                   batches;
+    std::size_t                num_batches;
+    std::size_t                num_draws;      // without static batching
+    std::size_t                num_instances;
+    bool                       success;
+};
+
+/****************************************************************************/
+
+// A cached scene can give the meshes back after their packed copy is
+// dropped, for a fresh import that's the larger copy.
+MeshManager::SceneRef meshSource(const LoadedScene& loaded)
+{
+    if (loaded.scene->storage == nullptr)
+        return nullptr;
+    return loaded.scene;
+}
+
+/****************************************************************************/
+
+void flushBatch(LoadedScene& loaded, import::MeshBatch& batch)
+{
+    const auto* mesh = batch.getMesh();
+    const auto* mat = loaded.scene->materials[mesh->material_index];
+    // not part of the scene graph, batches don't move
+    res::instances->addInstance(mesh->name, res::meshes->addBatch(batch),
+            res::materials->getMaterial(mat->name));
+    ++loaded.num_instances;
+}
+
+/****************************************************************************/
+
+void addToBatch(LoadedScene& loaded, const import::Mesh* mesh,
+        const glm::mat4& transformation, bool& added_instance)
+{
+    auto& batch = loaded.batches[LoadedScene::BatchKey(mesh->material_index,
+            import::vertexLayout(mesh))];
+    if (batch && !batch->add(mesh, transformation)) {
+        flushBatch(loaded, *batch);
+        batch.reset();
+        added_instance = true;
+    }
+    if (!batch) {
+        batch.reset(new import::MeshBatch(loaded.file + ":batch" +
+                    std::to_string(loaded.num_batches++)));
+        batch->add(mesh, transformation);
+    }
+}
+
+/****************************************************************************/
+
+// Only small meshes of nodes that are marked static (name starts with
+// "static_") and that aren't shared with other nodes: a batch is in world
+// space, it can't move and it doesn't share geometry.
+bool isBatched(const LoadedScene& loaded, const std::uint32_t mesh_index,
+        const import::Mesh* mesh)
+{
+    const auto max_vertices = std::min(import::MAX_BATCH_VERTICES,
+            static_cast<std::uint32_t>(std::max(vars.static_batching_max_vertices, 0)));
+    const auto* node = loaded.scene->nodes[loaded.mesh_nodes[mesh_index]];
+    return max_vertices > 0 && mesh->num_vertices <= max_vertices &&
+        loaded.num_references[mesh_index] == 1 &&
+        std::strncmp(node->name, "static_", 7) == 0;
+}
+
+/****************************************************************************/
+
+// returns false, if the node's mesh can't be loaded
+bool addNode(LoadedScene& loaded, const std::uint32_t idx, bool& added_instance)
+{
+    const import::Scene* scene = loaded.scene.get();
+    const auto* node = scene->nodes[idx];
+    const NodeId parent = node->parent_index == import::Node::NO_PARENT ?
+        NO_NODE : loaded.node_ids[node->parent_index];
+    loaded.world[idx] = node->parent_index == import::Node::NO_PARENT ?
+        node->transformation : loaded.world[node->parent_index] * node->transformation;
+
+    // the nodes are stored depth-first, just like the scene graph wants them
+    const auto* mesh = node->mesh_index == import::Node::NO_MESH ?
+        nullptr : loaded.scene->getMesh(node->mesh_index);
+    if (mesh == nullptr) {
+        loaded.node_ids[idx] = res::scene_graph->addNode(parent, node->transformation);
+        return node->mesh_index == import::Node::NO_MESH;
     }
+    loaded.used_meshes[node->mesh_index] = true;
+    ++loaded.num_draws;
 
+    // the node stays in the scene graph, without an instance
+    if (isBatched(loaded, node->mesh_index, mesh)) {
+        loaded.node_ids[idx] = res::scene_graph->addNode(parent, node->transformation);
+        addToBatch(loaded, mesh, loaded.world[idx], added_instance);
+        return true;
+    }
+
+    auto*& core_mesh = loaded.meshes[node->mesh_index];
+    if (core_mesh == nullptr) {
+        core_mesh = res::meshes->addMesh(mesh, meshSource(loaded));
+    }
+    const auto* mat = scene->materials[mesh->material_index];
+    auto* inst = res::instances->addInstance(node->name, core_mesh,
+            res::materials->getMaterial(mat->name));
+    inst->setPosition(node->position);
+    inst->setScale(node->scale);
+    inst->setOrientation(node->rotation);
+    loaded.node_ids[idx] = res::scene_graph->addNode(parent, node->transformation, inst);
+    ++loaded.num_instances;
+    added_instance = true;
+    return true;
+}
+
+/****************************************************************************/
+
+void addLight(const import::Light* light)
+{
+    Light* newLight = nullptr;
+    // name starts with "scl_" -> shadowcasting
+    const bool isShadowcasting = (std::strncmp(light->name, "scl_", 4) == 0);
+    switch (light->type) {
+    case import::LightType::SPOT:
+    {
+        auto* l = core::res::lights->createSpotlight(isShadowcasting);
+        l->setDirection(light->direction);
+        l->setAngleInnerCone(light->angle_inner_cone);
+        l->setAngleOuterCone(light->angle_outer_cone);
+        newLight = l;
+        break;
+    }
+    case import::LightType::DIRECTIONAL:
+    {
+        auto* l = core::res::lights->createDirectionalLight(isShadowcasting);
+        l->setDirection(light->direction);
+        l->setSize(1000.f); // TODO
+        l->setRotation(.0f); // TODO
+        newLight = l;
+        break;
+    }
+    case import::LightType::POINT:
+    {
+        auto* l = core::res::lights->createPointLight(isShadowcasting);
+        newLight = l;
+        break;
+    }
+    default:
+        break;
+    }
+    if (newLight != nullptr) {
+        newLight->setPosition(light->position);
+        newLight->setIntensity(light->color);
+        //newLight->setMaxDistance(light->max_distance);
+        newLight->setMaxDistance(2000.f); // TODO
+        newLight->setLinearAttenuation(light->linear_attenuation);
+        newLight->setConstantAttenuation(light->constant_attenuation);
+        newLight->setQuadraticAttenuation(light->quadratic_attenuation);
+    } else {
+        LOG_WARNING("Unsupported light type for light'",
+                light->name, '\'');
+    }
+}
+
+} // anonymous namespace
+
+/****************************************************************************/
+
+SceneLoader::SceneLoader(const std::string& scenefiles)
+  : m_next_import{0},
+    m_placeholder_cam{nullptr},
+    m_success{true},
+    m_start{std::chrono::steady_clock::now()}
+{
+    boost::char_separator<char> sep(",");
+    boost::tokenizer<boost::char_separator<char>> tokens(scenefiles, sep);
+    m_files.assign(tokens.begin(), tokens.end());
+
+    // import all files concurrently, they are registered with the
+    // (GL) managers by update()
+    m_imports.reserve(m_files.size());
+    for (const auto& file : m_files) {
+        m_imports.emplace_back(std::async(std::launch::async,
+                    import::importSceneFile, file));
+    }
+
+    // something to look through until the scene's cameras are loaded
     if (res::cameras->getDefaultCam() == nullptr) {
         auto* cam = res::cameras->createPerspectiveCam("default_cam", glm::dvec3(-800.0, 100.0, 0.0),
                 glm::dvec3(1.0, 0.0, 0.0), glm::radians(45.0), 4.0 / 3.0,
@@ -125,12 +253,222 @@ bool loadScenefiles(const std::string& scenefiles)
         cam->setFixedYawAxis(true, up);
         cam->lookAt(glm::dvec3(0.0));
         res::cameras->makeDefault(cam);
+        m_placeholder_cam = cam;
+    }
+}
+
+/****************************************************************************/
+
+// waits for the imports that are still running
+SceneLoader::~SceneLoader() = default;
+
+/****************************************************************************/
+
+bool SceneLoader::update(const double budget_ms)
+{
+    if (done())
+        return false;
+
+    const auto start = std::chrono::steady_clock::now();
+    pollImports();
+
+    bool added_instances = false;
+    while (!m_jobs.empty()) {
+        added_instances |= m_jobs.front()();
+        m_jobs.pop_front();
+
+        const std::chrono::duration<double, std::milli> time =
+            std::chrono::steady_clock::now() - start;
+        if (time.count() >= budget_ms)
+            break;
+    }
+    if (added_instances) {
+        // the bounding boxes are needed right away
+        res::scene_graph->update();
+    }
+
+    if (done()) {
+        const std::chrono::duration<double, std::milli> time =
+            std::chrono::steady_clock::now() - m_start;
+        LOG_INFO("Loaded scene files in ", time.count(), " ms (scene cache ",
+                (vars.scene_cache_mmap ? "mapped" : "read"), "), peak resident memory: ",
+                peakResidentMemoryKiB() / 1024, " MiB");
     }
 
-    return result;
+    return added_instances;
 }
 
 /****************************************************************************/
 
-} // namespace core
+void SceneLoader::finish()
+{
+    while (!done()) {
+        if (m_jobs.empty())
+            m_imports[m_next_import].wait();
+        update(std::numeric_limits<double>::infinity());
+    }
+}
+
+/****************************************************************************/
+
+bool SceneLoader::done() const
+{
+    return m_next_import == m_imports.size() && m_jobs.empty();
+}
 
+/****************************************************************************/
+
+bool SceneLoader::succeeded() const
+{
+    return m_success;
+}
+
+/****************************************************************************/
+
+// in order, a slow file holds back the ones behind it
+void SceneLoader::pollImports()
+{
+    while (m_next_import < m_imports.size()) {
+        auto& pending = m_imports[m_next_import];
+        if (pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+        auto scene = pending.get();
+        if (scene) {
+            addJobs(std::move(scene), m_files[m_next_import]);
+        } else {
+            m_success = false;
+        }
+        ++m_next_import;
+    }
+}
+
+/****************************************************************************/
+
+void SceneLoader::addJobs(import::ScenePtr imported, const std::string& file)
+{
+    auto loaded = std::make_shared<LoadedScene>();
+    loaded->file = file;
+    loaded->scene = std::move(imported);
+    const import::Scene* s = loaded->scene.get();
+    loaded->meshes.resize(s->num_meshes, nullptr);
+    loaded->used_meshes.resize(s->num_meshes, false);
+    loaded->num_references.resize(s->num_meshes, 0);
+    loaded->mesh_nodes.resize(s->num_meshes, 0);
+    loaded->node_ids.resize(s->num_nodes, NO_NODE);
+    loaded->world.resize(s->num_nodes);
+    loaded->num_batches = 0;
+    loaded->num_draws = 0;
+    loaded->num_instances = 0;
+    loaded->success = true;
+
+    // only meshes that are referenced by a node are loaded
+    std::vector<std::uint32_t> referenced;
+    for (std::uint32_t i = 0; i < s->num_nodes; ++i) {
+        const auto mesh_index = s->nodes[i]->mesh_index;
+        if (mesh_index == import::Node::NO_MESH)
+            continue;
+        loaded->mesh_nodes[mesh_index] = i;
+        if (loaded->num_references[mesh_index]++ > 0)
+            continue;
+        referenced.push_back(mesh_index);
+        loaded->scene->prefetchMesh(mesh_index);
+    }
+
+    for (unsigned int i = 0; i < s->num_textures; ++i) {
+        m_jobs.emplace_back([loaded, i] () {
+                auto* tex = loaded->scene->textures[i];
+                res::textures->addTexture(tex->name, *tex->data);
+                // MeshManager may keep the scene for its meshes
+                delete tex->data;
+                tex->data = nullptr;
+                return false;
+            });
+    }
+    m_jobs.emplace_back([loaded] () {
+            const import::Scene* scene = loaded->scene.get();
+            for (unsigned int i = 0; i < scene->num_materials; ++i) {
+                const auto* mat = scene->materials[i];
+                res::materials->addMaterial(mat->name, mat, scene->textures);
+            }
+            return false;
+        });
+    // packed in parallel, see MeshManager::addMeshes()
+    for (std::size_t first = 0; first < referenced.size(); first += MESHES_PER_JOB) {
+        const auto last = std::min(first + MESHES_PER_JOB, referenced.size());
+        std::vector<std::uint32_t> indices(referenced.begin() + static_cast<long>(first),
+                referenced.begin() + static_cast<long>(last));
+        m_jobs.emplace_back([loaded, indices] () {
+                std::vector<std::uint32_t> added_indices;
+                std::vector<const import::Mesh*> meshes;
+                for (const auto idx : indices) {
+                    const auto* mesh = loaded->scene->getMesh(idx);
+                    if (mesh == nullptr || isBatched(*loaded, idx, mesh))
+                        continue;
+                    added_indices.push_back(idx);
+                    meshes.push_back(mesh);
+                }
+                const auto added = res::meshes->addMeshes(meshes, meshSource(*loaded));
+                for (std::size_t i = 0; i < added.size(); ++i) {
+                    loaded->meshes[added_indices[i]] = added[i];
+                }
+                return false;
+            });
+    }
+    for (std::uint32_t i = 0; i < s->num_nodes; ++i) {
+        m_jobs.emplace_back([loaded, i] () {
+                bool added_instance = false;
+                if (!addNode(*loaded, i, added_instance))
+                    loaded->success = false;
+                return added_instance;
+            });
+    }
+    m_jobs.emplace_back([this, loaded] () {
+            for (auto& batch : loaded->batches) {
+                flushBatch(*loaded, *batch.second);
+            }
+            const bool added_instances = !loaded->batches.empty();
+            loaded->batches.clear();
+            if (loaded->num_batches > 0) {
+                LOG_INFO(logtag::Import, "Static batching: ", loaded->num_draws,
+                        " draws in ", loaded->file, " down to ", loaded->num_instances);
+            }
+
+            const import::Scene* scene = loaded->scene.get();
+            addCameras(scene);
+            for (unsigned int i = 0; i < scene->num_lights; ++i) {
+                addLight(scene->lights[i]);
+            }
+
+            const auto skipped = std::count(loaded->used_meshes.begin(),
+                    loaded->used_meshes.end(), false);
+            if (skipped > 0) {
+                LOG_INFO(logtag::Import, "Skipped ", skipped, " of ", loaded->meshes.size(),
+                        " meshes without instances in ", loaded->file);
+            }
+            if (!loaded->success)
+                m_success = false;
+            return added_instances;
+        });
+}
+
+/****************************************************************************/
+
+void SceneLoader::addCameras(const import::Scene* scene)
+{
+    for (unsigned int i = 0; i < scene->num_cameras; i++) {
+        const auto* cam = scene->cameras[i];
+        auto* new_cam = res::cameras->createPerspectiveCam(cam->name, cam->position,
+                cam->position + cam->direction,
+                2.0 * glm::atan(glm::tan(glm::radians(cam->hfov) / 2.0) / cam->aspect_ratio),
+                cam->aspect_ratio, vars.cam_nearplane, FAR_PLANE);
+        // the scene's first camera replaces the placeholder
+        if (m_placeholder_cam != nullptr && res::cameras->getDefaultCam() == m_placeholder_cam) {
+            res::cameras->makeDefault(new_cam);
+            m_placeholder_cam = nullptr;
+        }
+    }
+}
+
+/****************************************************************************/
+
+} // namespace core
@@ -1,14 +1,56 @@
 #ifndef CORE_LOADER_H
 #define CORE_LOADER_H
 
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
 #include <string>
+#include <vector>
+
+#include "import/scene.h"
 
 namespace core
 {
 
-bool loadScenefiles(const std::string& scenefiles);
+class Camera;
+
+/*
+ * Imports scene files in the background. Finished scenes are split into
+ * upload jobs (one per texture and per node), which update() runs on the
+ * GL thread within a time budget, so that geometry shows up progressively.
+ * Scene files are registered in the given order, so indices stay stable.
+ */
+class SceneLoader
+{
+public:
+    explicit SceneLoader(const std::string& scenefiles);
+    ~SceneLoader();
+
+    // runs at least one job, returns true if instances were added
+    bool update(double budget_ms);
+    // blocks until everything is loaded
+    void finish();
+
+    bool done() const;
+    bool succeeded() const;
+
+private:
+    using Job = std::function<bool()>;
+
+    void pollImports();
+    void addJobs(import::ScenePtr imported, const std::string& file);
+    void addCameras(const import::Scene* scene);
+
+    std::vector<std::string>                    m_files;
+    std::vector<std::future<import::ScenePtr>>  m_imports;
+    std::size_t                                 m_next_import;
+    std::deque<Job>                             m_jobs;
+    Camera*                                     m_placeholder_cam;
+    bool                                        m_success;
+    std::chrono::steady_clock::time_point       m_start;
+};
 
 } // namespace core
 
 #endif // CORE_LOADER_H
-
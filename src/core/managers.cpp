@@ -6,6 +6,7 @@
 #include "mesh_manager.h"
 #include "instance_manager.h"
 #include "light_manager.h"
+#include "scene_graph.h"
 #include "gl/gl_sys.h"
 
 namespace core
@@ -22,6 +23,7 @@ MaterialManager* materials;
 InstanceManager* instances;
 MeshManager* meshes;
 LightManager* lights;
+SceneGraph* scene_graph;
 } // namespace res
 
 /***************************************************************************/
@@ -35,6 +37,7 @@ void initializeManagers()
     res::instances = new InstanceManager();
     res::meshes = new MeshManager();
     res::lights = new LightManager();
+    res::scene_graph = new SceneGraph();
 }
 
 /***************************************************************************/
@@ -48,6 +51,7 @@ void terminateManagers()
     delete res::instances;
     delete res::meshes;
     delete res::lights;
+    delete res::scene_graph;
 }
 
 /***************************************************************************/
@@ -57,7 +61,18 @@ bool updateManagers()
     bool result = false;
 
     result |= res::cameras->update();
+    // hands the world transformations to the instances
+    result |= res::scene_graph->update();
     result |= res::instances->update();
+    // needs the instances' bounding boxes
+    result |= res::meshes->update();
+
+    // the CPU is done writing for this frame
+    res::cameras->flush();
+    res::materials->flush();
+    res::instances->flush();
+    res::meshes->flush();
+    res::lights->flush();
 
     return result;
 }
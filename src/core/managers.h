@@ -11,6 +11,7 @@ class MaterialManager;
 class InstanceManager;
 class MeshManager;
 class LightManager;
+class SceneGraph;
 
 namespace res
 {
@@ -21,6 +22,7 @@ extern MaterialManager* materials;
 extern InstanceManager* instances;
 extern MeshManager* meshes;
 extern LightManager* lights;
+extern SceneGraph* scene_graph;
 } // namespace res
 
 
@@ -9,7 +9,7 @@ namespace core
 
 /****************************************************************************/
 
-Material::Material(const GLuint index, shader::MaterialStruct* const ptr)
+Material::Material(const MaterialData ptr)
   : m_diffuse_texture{nullptr},
     m_specular_texture{nullptr},
     m_glossy_texture{nullptr},
@@ -24,8 +24,7 @@ Material::Material(const GLuint index, shader::MaterialStruct* const ptr)
     m_transparent_color{.0f},
     m_glossiness{1.f},
     m_opacity{1.f},
-    m_index{index},
-    m_data{ptr}
+    m_data(ptr)
 {
     shader::MaterialStruct data;
     data.hasDiffuseTex = 0;
@@ -53,7 +52,7 @@ Material::Material(const GLuint index, shader::MaterialStruct* const ptr)
     data.glossiness = m_glossiness;
     data.opacity = m_opacity;
 
-    std::memcpy(m_data, &data, sizeof(shader::MaterialStruct));
+    std::memcpy(m_data.get(), &data, sizeof(shader::MaterialStruct));
 }
 
 /****************************************************************************/
@@ -330,7 +329,7 @@ void Material::setOpacity(const float value)
 
 GLuint Material::getIndex() const
 {
-    return m_index;
+    return m_data.index();
 }
 
 /****************************************************************************/
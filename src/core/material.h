@@ -3,6 +3,7 @@
 
 #include "gl/gl_sys.h"
 #include <glm/vec3.hpp>
+#include "buffer_storage_pool.h"
 
 namespace core
 {
@@ -14,6 +15,8 @@ namespace shader
 struct MaterialStruct;
 } // namespace shader
 
+using MaterialData = BufferStoragePool<shader::MaterialStruct>::Ref;
+
 class Material
 {
 public:
@@ -63,7 +66,7 @@ public:
 
 private:
     friend class MaterialManager;
-    Material(GLuint index, shader::MaterialStruct* ptr);
+    explicit Material(MaterialData ptr);
 
     const Texture*  m_diffuse_texture;
     const Texture*  m_specular_texture;
@@ -80,8 +83,7 @@ private:
     float           m_glossiness;
     float           m_opacity;
 
-    GLuint          m_index;
-    shader::MaterialStruct* m_data;
+    MaterialData    m_data;
 };
 
 
@@ -10,9 +10,9 @@ namespace core
 
 /****************************************************************************/
 
-constexpr int MAX_NUM_MATERIALS = 256;
+constexpr int INITIAL_NUM_MATERIALS = 256;
 MaterialManager::MaterialManager()
-  : m_material_buffer(GL_SHADER_STORAGE_BUFFER, MAX_NUM_MATERIALS)
+  : m_material_buffer(GL_SHADER_STORAGE_BUFFER, INITIAL_NUM_MATERIALS)
 {
     bind();
 }
@@ -34,11 +34,9 @@ Material* MaterialManager::addMaterial(const std::string& name,
                 "' with imported material: ", material->name);
         result = it->second.get();
     } else {
-        const GLintptr offset = m_material_buffer.alloc();
-        const auto index = m_material_buffer.offsetToIndex(offset);
-        auto* ptr = m_material_buffer.offsetToPointer(offset);
+        const auto data = m_material_buffer.ref(m_material_buffer.alloc());
 
-        std::unique_ptr<Material> mat{new Material(index, ptr)};
+        std::unique_ptr<Material> mat{new Material(data)};
         auto res = m_materials.emplace(name, std::move(mat));
         result = res.first->second.get();
     }
@@ -85,11 +83,9 @@ Material* MaterialManager::addMaterial(const std::string& name)
         return it->second.get();
     }
 
-    const GLintptr offset = m_material_buffer.alloc();
-    const auto index = m_material_buffer.offsetToIndex(offset);
-    auto* ptr = m_material_buffer.offsetToPointer(offset);
+    const auto data = m_material_buffer.ref(m_material_buffer.alloc());
 
-    std::unique_ptr<Material> mat{new Material(index, ptr)};
+    std::unique_ptr<Material> mat{new Material(data)};
     auto res = m_materials.emplace(name, std::move(mat));
     return res.first->second.get();
 }
@@ -120,10 +116,16 @@ const Material* MaterialManager::getMaterial(const std::string& name) const
 
 /****************************************************************************/
 
+void MaterialManager::flush()
+{
+    m_material_buffer.flush();
+}
+
+/****************************************************************************/
+
 void MaterialManager::bind() const
 {
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindings::MATERIAL,
-            m_material_buffer.buffer());
+    m_material_buffer.bind(GL_SHADER_STORAGE_BUFFER, bindings::MATERIAL);
 }
 
 /****************************************************************************/
@@ -31,6 +31,8 @@ public:
     Material* getMaterial(const std::string& name);
     const Material* getMaterial(const std::string& name) const;
 
+    // once per frame, see BufferStoragePool::flush()
+    void flush();
     void bind() const;
 
 private:
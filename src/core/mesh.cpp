@@ -5,6 +5,15 @@ namespace core
 
 /****************************************************************************/
 
+bool Meshlet::isBackfacing(const glm::vec3& eye) const
+{
+    // the sphere has to lie within the cone's back side, seen from 'eye'
+    const glm::vec3 dir = center - eye;
+    return glm::dot(dir, cone_axis) >= cone_cutoff * glm::length(dir) + radius;
+}
+
+/****************************************************************************/
+
 Mesh::Mesh(GLenum mode_, GLsizei count_, GLenum type_, GLvoid* indices_,
             GLint basevertex_, util::bitfield<MeshComponents> components_,
             const AABB& bbox_, const GLuint index_)
@@ -15,7 +24,9 @@ Mesh::Mesh(GLenum mode_, GLsizei count_, GLenum type_, GLvoid* indices_,
     m_basevertex{basevertex_},
     m_components{components_},
     m_bbox{bbox_},
-    m_index{index_}
+    m_index{index_},
+    m_resident{false},
+    m_pager_id{0}
 {
 }
 
@@ -77,6 +88,34 @@ GLuint Mesh::index() const
 
 /****************************************************************************/
 
+const std::vector<Meshlet>& Mesh::meshlets() const
+{
+    return m_meshlets;
+}
+
+/****************************************************************************/
+
+const std::vector<MeshLod>& Mesh::lods() const
+{
+    return m_lods;
+}
+
+/****************************************************************************/
+
+const std::vector<MeshPart>& Mesh::parts() const
+{
+    return m_parts;
+}
+
+/****************************************************************************/
+
+bool Mesh::isResident() const
+{
+    return m_resident;
+}
+
+/****************************************************************************/
+
 GLuint Mesh::firstIndex() const
 {
     unsigned int size;
@@ -1,18 +1,46 @@
 #ifndef CORE_MESH_H
 #define CORE_MESH_H
 
+#include <cstdint>
+#include <vector>
+
 #include "gl/gl_sys.h"
 #include "util/bitfield.h"
 #include "aabb.h"
+#include "mesh_components.h"
 
 namespace core
 {
 
-enum class MeshComponents : unsigned char
+// Cluster of triangles, see import::buildMeshlets(). Everything is in the
+// mesh's object space.
+struct Meshlet
+{
+    glm::vec3   center;         // bounding sphere
+    float       radius;
+    glm::vec3   cone_axis;      // normal cone
+    float       cone_cutoff;
+    GLuint      first_index;    // relative to Mesh::firstIndex()
+    GLsizei     count;
+
+    // true if every triangle faces away from 'eye'
+    bool isBackfacing(const glm::vec3& eye) const;
+};
+
+// simplified triangle list, shares the vertices of its mesh
+struct MeshLod
+{
+    float       error;      // object space distance to the original surface
+    GLvoid*     indices;
+    GLsizei     count;
+};
+
+// merged mesh of a static batch, see MeshManager::addBatch()
+struct MeshPart
 {
-    TexCoords = 1<<0,
-    Normals   = 1<<1,
-    Tangents  = 1<<2
+    AABB        bbox;
+    GLuint      first_index;    // relative to Mesh::firstIndex()
+    GLsizei     count;
 };
 
 class Mesh
@@ -27,6 +55,12 @@ public:
     const AABB& bbox() const;
     GLuint firstIndex() const;
     GLuint index() const;
+    const std::vector<Meshlet>& meshlets() const;
+    const std::vector<MeshLod>& lods() const;
+    // empty, unless this is a static batch
+    const std::vector<MeshPart>& parts() const;
+    // indices() and basevertex() change whenever the mesh is paged in
+    bool isResident() const;
 
 private:
     friend class MeshManager;
@@ -43,6 +77,11 @@ private:
     util::bitfield<MeshComponents> m_components;
     AABB        m_bbox;
     GLuint      m_index;
+    std::vector<Meshlet> m_meshlets;
+    std::vector<MeshLod> m_lods;
+    std::vector<MeshPart> m_parts;
+    bool        m_resident;
+    std::uint32_t m_pager_id;   // see MeshManager::update()
 };
 
 } // namespace core
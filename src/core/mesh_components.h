@@ -0,0 +1,17 @@
+#ifndef CORE_MESH_COMPONENTS_H
+#define CORE_MESH_COMPONENTS_H
+
+namespace core
+{
+
+enum class MeshComponents : unsigned char
+{
+    TexCoords = 1<<0,
+    Normals   = 1<<1,
+    Tangents  = 1<<2,
+    Quantized = 1<<3  // compact layout, see MeshManager::addMesh()
+};
+
+} // namespace core
+
+#endif // CORE_MESH_COMPONENTS_H
@@ -1,7 +1,13 @@
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <future>
 
 #include "mesh_manager.h"
+#include "camera_manager.h"
+#include "instance_manager.h"
 #include "import/mesh.h"
+#include "import/mesh_batch.h"
 #include "log/log.h"
 #include "framework/vars.h"
 
@@ -10,11 +16,39 @@ namespace core
 
 /****************************************************************************/
 
-constexpr int MAX_NUM_MESHES = 1200;
+constexpr int INITIAL_NUM_MESHES = 1200;
+
+/****************************************************************************/
+
+namespace
+{
+
+GLenum indexType(const std::size_t per_index_size)
+{
+    switch (per_index_size) {
+    case sizeof(GLubyte):
+        return GL_UNSIGNED_BYTE;
+    case sizeof(GLushort):
+        return GL_UNSIGNED_SHORT;
+    default:
+        return GL_UNSIGNED_INT;
+    }
+}
+
+} // anonymous namespace
+
+/****************************************************************************/
+
 MeshManager::MeshManager()
-  : m_data(GL_SHADER_STORAGE_BUFFER, vars.vertex_buffer_size),
-    m_mesh_pool(GL_SHADER_STORAGE_BUFFER, MAX_NUM_MESHES)
+  : m_pager(static_cast<std::size_t>(vars.vertex_buffer_size / vars.geometry_page_size),
+            static_cast<std::size_t>(vars.geometry_page_size), *this),
+    m_mesh_pool(GL_SHADER_STORAGE_BUFFER, INITIAL_NUM_MESHES),
+    m_pack_threads(static_cast<unsigned int>(std::max(vars.import_threads, 0)))
 {
+    const auto size = static_cast<GLsizeiptr>(m_pager.getNumPages() * m_pager.getPageSize());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_data);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
     initVAOs();
 }
 
@@ -24,133 +58,201 @@ MeshManager::~MeshManager() = default;
 
 /****************************************************************************/
 
-Mesh* MeshManager::addMesh(const import::Mesh* mesh)
+Mesh* MeshManager::addMesh(const import::Mesh* mesh, SceneRef scene)
 {
-    std::string name = mesh->name;
+    return addMeshes({mesh}, std::move(scene)).front();
+}
 
-    auto it = m_meshes.find(name);
-    if (it != m_meshes.end()) {
-        LOG_INFO("Mesh already added: ", name);
-        return it->second.get();
-    }
+/****************************************************************************/
 
-    // observe the order in 'shader_interface.h'
-    util::bitfield<MeshComponents> components;
-    GLsizeiptr per_vertex_size = 3 * sizeof(float);
-    if (mesh->hasTexCoords()) {
-        per_vertex_size += 2 * sizeof(float);
-        components |= MeshComponents::TexCoords;
+std::vector<Mesh*> MeshManager::addMeshes(const std::vector<const import::Mesh*>& meshes,
+        SceneRef scene)
+{
+    std::vector<Mesh*> result(meshes.size(), nullptr);
+
+    // the layouts tell where each new mesh goes into the arena
+    const std::size_t first_packed = m_packed.size();
+    std::vector<const import::Mesh*> sources;
+    std::vector<std::size_t> arena_offsets;
+    std::size_t arena_size = 0;
+    for (std::size_t i = 0; i < meshes.size(); ++i) {
+        result[i] = findMesh(meshes[i]);
+        if (result[i] != nullptr)
+            continue;
+        PackedMesh packed;
+        result[i] = createMesh(meshes[i], packed);
+        m_packed.emplace_back(std::move(packed));
+        sources.push_back(meshes[i]);
+        arena_offsets.push_back(arena_size);
+        // keep the next mesh 4 byte aligned
+        arena_size += (m_packed.back().layout.size + 3) & ~std::size_t(3);
     }
-    // if mesh has tangents, then use we use tangent
-    // and bitangent plus a reflect float to reconstruct
-    // the normal
-    if (mesh->hasTangents()) {
-        per_vertex_size += 7 * sizeof(float);
-        components |= MeshComponents::Tangents;
-    } else if (mesh->hasNormals()) {
-        per_vertex_size += 3 * sizeof(float);
-        components |= MeshComponents::Normals;
+    if (sources.empty())
+        return result;
+
+    // pack: CPU only
+    auto arena = std::make_shared<Arena>(arena_size);
+    std::vector<std::future<void>> packing;
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        auto& packed = m_packed[first_packed + i];
+        const import::Mesh* mesh = sources[i];
+        if (scene) {
+            packed.source = mesh;
+            packed.scene = scene;
+        }
+        packed.arena = arena;
+        packed.data = arena->data() + arena_offsets[i];
+        const PackedMeshLayout& layout = packed.layout;
+        GLubyte* dst = arena->data() + arena_offsets[i];
+        if (sources.size() == 1) {
+            packMesh(mesh, layout, dst);
+        } else {
+            packing.emplace_back(m_pack_threads.submit([mesh, &layout, dst] () {
+                        packMesh(mesh, layout, dst);
+                    }));
+        }
     }
-
-    GLenum index_type;
-    GLsizeiptr per_index_size;
-    if (mesh->num_vertices < 256) {
-        per_index_size = sizeof(GLubyte);
-        index_type = GL_UNSIGNED_BYTE;
-    } else if (mesh->num_vertices < 65535) {
-        per_index_size = sizeof(GLushort);
-        index_type = GL_UNSIGNED_SHORT;
-    } else {
-        per_index_size = sizeof(GLuint);
-        index_type = GL_UNSIGNED_INT;
+    for (auto& pending : packing) {
+        pending.get();
     }
 
-    const GLsizeiptr vertices_size = per_vertex_size * mesh->num_vertices;
-    const GLsizeiptr indices_size = per_index_size * mesh->num_indices;
-    const GLsizeiptr size = vertices_size + indices_size;
-
-    // allocate memory and make sure the first address is aligned to
-    // a multiple of the per_vertex_size
-    const auto offset = m_data.alloc(size, static_cast<GLsizei>(vertices_size));
-    assert(offset % vertices_size == 0);
-
-    // Upload data to GPU
-    void* ptr = glMapNamedBufferRangeEXT(m_data.buffer(),
-                offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
-    float* data = static_cast<float*>(ptr);
-    for (unsigned int i = 0; i < mesh->num_vertices; ++i) {
-        *data++ = mesh->vertices[i][0];
-        *data++ = mesh->vertices[i][1];
-        *data++ = mesh->vertices[i][2];
-
-        // order is specified in shader::MeshStruct (shader_interface.h)
-        if (mesh->hasTexCoords()) {
-            *data++ = mesh->texcoords[i][0];
-            *data++ = mesh->texcoords[i][1];
-        }
-        if (mesh->hasTangents()) {
-            *data++ = mesh->tangents[i][0];
-            *data++ = mesh->tangents[i][1];
-            *data++ = mesh->tangents[i][2];
-            *data++ = mesh->bitangents[i][0];
-            *data++ = mesh->bitangents[i][1];
-            *data++ = mesh->bitangents[i][2];
-
-            *data++ = (glm::dot(mesh->normals[i],
-                    glm::cross(mesh->tangents[i], mesh->bitangents[i])) > .0f) ?
-                    1.f : -1.f;
-        } else if (mesh->hasNormals()) {
-            *data++ = mesh->normals[i][0];
-            *data++ = mesh->normals[i][1];
-            *data++ = mesh->normals[i][2];
-        }
-        if (mesh->hasVertexColors()) {
-            *data++ = mesh->vertex_colors[i][0];
-            *data++ = mesh->vertex_colors[i][1];
-            *data++ = mesh->vertex_colors[i][2];
+    // commit: place the meshes while there are free pages, one upload per
+    // range of neighbouring pages
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        auto& packed = m_packed[first_packed + i];
+        // the vertices have to start at a multiple of per_vertex_size, which
+        // may take up to per_vertex_size - 4 bytes after the first page's start
+        const auto pages_size = packed.layout.size + packed.layout.per_vertex_size;
+        const auto id = m_pager.addResource(pages_size);
+        assert(id == first_packed + i);
+        packed.mesh->m_pager_id = id;
+        if (pages_size > m_pager.getNumPages() * m_pager.getPageSize()) {
+            LOG_ERROR("Mesh ", sources[i]->name, " doesn't fit into the vertex buffer "
+                    "(vertex_buffer_size)");
+        } else if (!m_pager.load(id)) {
+            LOG_INFO("Vertex buffer is full, mesh ", sources[i]->name,
+                    " is paged in when it's visible");
         }
     }
-    // since we're only pushing floats into the buffer,
-    // // the start of out index array is always aligned to
-    // // 4 bytes... good
-    GLubyte* indices = reinterpret_cast<GLubyte*>(data);
-    for (unsigned int i = 0; i < mesh->num_indices; ++i) {
-        if (per_index_size == sizeof(GLubyte)) {
-            *indices = static_cast<GLubyte>(mesh->indices[i]);
-        } else if (per_index_size == sizeof(GLushort)) {
-            GLushort* idx = reinterpret_cast<GLushort*>(indices);
-            *idx = static_cast<GLushort>(mesh->indices[i]);
-        } else {
-            GLuint* idx = reinterpret_cast<GLuint*>(indices);
-            *idx = static_cast<GLuint>(mesh->indices[i]);
+    commit();
+
+    // the scene's meshes are packed again on page-in, so the arena goes
+    // away with the upload
+    if (scene) {
+        for (std::size_t i = first_packed; i < m_packed.size(); ++i) {
+            m_packed[i].arena.reset();
+            m_packed[i].data = nullptr;
         }
-        indices += per_index_size;
     }
-    assert(indices - static_cast<GLubyte*>(ptr) == size);
-    glUnmapNamedBufferEXT(m_data.buffer());
 
-    // Add MeshStruct on GPU
-    const GLintptr mesh_offset = m_mesh_pool.alloc();
-    const GLuint mesh_index = m_mesh_pool.offsetToIndex(mesh_offset);
-    auto* mesh_data = m_mesh_pool.offsetToPointer(mesh_offset);
+    return result;
+}
+
+/****************************************************************************/
+
+// by name or by geometry
+Mesh* MeshManager::findMesh(const import::Mesh* mesh)
+{
+    auto it = m_meshes.find(mesh->name);
+    if (it != m_meshes.end()) {
+        LOG_INFO("Mesh already added: ", mesh->name);
+        return it->second;
+    }
+
+    // the index count guards against hash collisions
+    const auto range = m_geometry.equal_range(mesh->geometry_hash);
+    for (auto geometry = range.first; geometry != range.second; ++geometry) {
+        Mesh* result = geometry->second.get();
+        if (result->count() != static_cast<GLsizei>(mesh->num_indices))
+            continue;
+        LOG_INFO("Mesh ", mesh->name, " shares its geometry with an earlier mesh");
+        m_meshes.emplace(mesh->name, result);
+        return result;
+    }
+
+    return nullptr;
+}
+
+/****************************************************************************/
+
+// everything but the vertex data, which is packed by addMeshes()
+Mesh* MeshManager::createMesh(const import::Mesh* mesh, PackedMesh& packed)
+{
+    packed.layout = getPackedMeshLayout(mesh, vars.vertex_quantization);
+    const PackedMeshLayout& layout = packed.layout;
+
+    // Add MeshStruct on GPU, the offsets are set by upload()
+    packed.mesh_handle = m_mesh_pool.alloc();
+    const GLuint mesh_index = m_mesh_pool.index(packed.mesh_handle);
+    auto* mesh_data = m_mesh_pool.get(packed.mesh_handle);
     // remember: we're using a float[] array, so divide everything by sizeof(float)
-    mesh_data->stride = static_cast<GLuint>(per_vertex_size / static_cast<GLsizei>(sizeof(float)));
-    mesh_data->components = static_cast<GLuint>(components());
-    mesh_data->first = static_cast<GLuint>(offset / static_cast<GLintptr>(sizeof(float)));
-    mesh_data->firstIndex = static_cast<GLuint>((offset + vertices_size) / per_index_size);
+    mesh_data->stride = static_cast<GLuint>(layout.per_vertex_size / sizeof(float));
+    mesh_data->components = static_cast<GLuint>(layout.components());
+    mesh_data->first = 0;
+    mesh_data->firstIndex = 0;
     mesh_data->count = static_cast<GLuint>(mesh->num_indices);
+    for (int i = 0; i < 3; ++i) {
+        mesh_data->bboxMin[i] = mesh->bbox.pmin[i];
+        mesh_data->bboxExtent[i] = mesh->bbox.pmax[i] - mesh->bbox.pmin[i];
+    }
 
-    auto res = m_meshes.emplace(std::move(name),
+    Mesh* result = m_geometry.emplace(mesh->geometry_hash,
             std::unique_ptr<Mesh>(
                 new Mesh(GL_TRIANGLES,
                 static_cast<GLsizei>(mesh->num_indices),
-                index_type,
-                reinterpret_cast<GLvoid*>(offset + vertices_size),
-                static_cast<GLint>(offset / per_vertex_size),
-                components,
+                indexType(layout.per_index_size),
+                nullptr,
+                0,
+                layout.components,
                 mesh->bbox,
-                mesh_index)));
-    return res.first->second.get();
+                mesh_index)))->second.get();
+    m_meshes.emplace(mesh->name, result);
+    packed.mesh = result;
+    packed.source = nullptr;
+    packed.data = nullptr;
+
+    result->m_meshlets.resize(mesh->num_meshlets);
+    for (std::uint32_t i = 0; i < mesh->num_meshlets; ++i) {
+        const auto& src = mesh->meshlets[i];
+        auto& dst = result->m_meshlets[i];
+        dst.center = src.center;
+        dst.radius = src.radius;
+        dst.cone_axis = src.cone_axis;
+        dst.cone_cutoff = src.cone_cutoff;
+        dst.first_index = static_cast<GLuint>(src.first_index);
+        dst.count = static_cast<GLsizei>(src.num_indices);
+    }
+
+    const auto lod_offset = static_cast<GLintptr>(layout.vertices_size +
+        layout.per_index_size * mesh->num_indices);
+    result->m_lods.resize(mesh->num_lods);
+    packed.lod_offsets.resize(mesh->num_lods);
+    for (std::uint32_t i = 0; i < mesh->num_lods; ++i) {
+        const auto& src = mesh->lods[i];
+        auto& dst = result->m_lods[i];
+        dst.error = src.error;
+        dst.indices = nullptr;
+        dst.count = static_cast<GLsizei>(src.num_indices);
+        packed.lod_offsets[i] = lod_offset +
+            static_cast<GLintptr>(layout.per_index_size * src.first_index);
+    }
+
+    return result;
+}
+
+/****************************************************************************/
+
+Mesh* MeshManager::addBatch(import::MeshBatch& batch)
+{
+    Mesh* result = addMesh(batch.getMesh());
+    if (result->m_parts.empty()) {
+        for (const auto& part : batch.getParts()) {
+            result->m_parts.push_back(MeshPart{part.bbox,
+                    static_cast<GLuint>(part.first_index),
+                    static_cast<GLsizei>(part.num_indices)});
+        }
+    }
+    return result;
 }
 
 /****************************************************************************/
@@ -162,7 +264,7 @@ Mesh* MeshManager::getMesh(const char* name)
         LOG_ERROR("Can't find mesh: ", name);
         return nullptr;
     }
-    return it->second.get();
+    return it->second;
 }
 
 /****************************************************************************/
@@ -174,15 +276,19 @@ const Mesh* MeshManager::getMesh(const char* name) const
         LOG_ERROR("Can't find mesh: ", name);
         return nullptr;
     }
-    return it->second.get();
+    return it->second;
 }
 
 /****************************************************************************/
 
 void MeshManager::initVAOs()
 {
-    for (unsigned char i = 0; i < 8; ++i) {
+    for (unsigned char i = 0; i < 16; ++i) {
         util::bitfield<MeshComponents> c(i);
+        if (c & MeshComponents::Quantized) {
+            initQuantizedVAO(c);
+            continue;
+        }
         GLsizei stride = static_cast<GLsizei>(3 * sizeof(float));
         if (c & MeshComponents::TexCoords)
             stride += static_cast<GLsizei>(2 * sizeof(float));
@@ -193,7 +299,7 @@ void MeshManager::initVAOs()
 
         gl::VertexArray vao;
         glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m_data.buffer());
+        glBindBuffer(GL_ARRAY_BUFFER, m_data);
 
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
@@ -226,7 +332,7 @@ void MeshManager::initVAOs()
         assert(static_cast<GLsizei>(offset) == stride);
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_data.buffer());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_data);
         glBindVertexArray(0);
 
         m_vaos.emplace(c(), std::move(vao));
@@ -235,6 +341,60 @@ void MeshManager::initVAOs()
 
 /****************************************************************************/
 
+// Positions are relative to the mesh bbox and w holds the normal's
+// reflection (0: -1, 1: +1), normals and tangents are octahedral.
+void MeshManager::initQuantizedVAO(const util::bitfield<MeshComponents> c)
+{
+    GLsizei stride = static_cast<GLsizei>(2 * sizeof(GLuint));
+    if (c & MeshComponents::TexCoords)
+        stride += static_cast<GLsizei>(sizeof(GLuint));
+    if (c & MeshComponents::Normals)
+        stride += static_cast<GLsizei>(sizeof(GLuint));
+    if (c & MeshComponents::Tangents)
+        stride += static_cast<GLsizei>(2 * sizeof(GLuint));
+
+    gl::VertexArray vao;
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_data);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_UNSIGNED_SHORT, GL_TRUE, stride, nullptr);
+
+    auto offset = 2 * sizeof(GLuint);
+    if (c & MeshComponents::TexCoords) {
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, stride,
+                reinterpret_cast<GLvoid*>(offset));
+        offset += sizeof(GLuint);
+    }
+    if (c & MeshComponents::Normals) {
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, stride,
+                reinterpret_cast<GLvoid*>(offset));
+        offset += sizeof(GLuint);
+    }
+    if (c & MeshComponents::Tangents) {
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 2, GL_SHORT, GL_TRUE, stride,
+                reinterpret_cast<GLvoid*>(offset));
+        offset += sizeof(GLuint);
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 2, GL_SHORT, GL_TRUE, stride,
+                reinterpret_cast<GLvoid*>(offset));
+        offset += sizeof(GLuint);
+    }
+
+    assert(static_cast<GLsizei>(offset) == stride);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_data);
+    glBindVertexArray(0);
+
+    m_vaos.emplace(c(), std::move(vao));
+}
+
+/****************************************************************************/
+
 GLuint MeshManager::getVAO(const Mesh* mesh) const
 {
     if (mesh == nullptr)
@@ -249,19 +409,137 @@ GLuint MeshManager::getVAO(const Mesh* mesh) const
 
 /****************************************************************************/
 
+bool MeshManager::update()
+{
+    const auto* cam = res::cameras->getDefaultCam();
+    if (cam == nullptr || m_packed.empty())
+        return false;
+
+    const glm::vec3 eye(cam->getPosition());
+    for (const auto* instance : res::instances->getInstances()) {
+        const auto& bbox = instance->getBoundingBox();
+        const auto closest = glm::clamp(eye, bbox.pmin, bbox.pmax);
+        m_pager.request(instance->getMesh()->m_pager_id, glm::distance(eye, closest),
+                cam->inFrustum(bbox));
+    }
+    const bool changed = m_pager.update(static_cast<std::size_t>(vars.geometry_pages_per_frame));
+    commit();
+    return changed;
+}
+
+/****************************************************************************/
+
+void MeshManager::upload(const GeometryPager::Id id, const std::size_t first_page)
+{
+    auto& packed = m_packed[id];
+    const auto& layout = packed.layout;
+    const auto page_offset = static_cast<GLintptr>(first_page * m_pager.getPageSize());
+    const auto stride = static_cast<GLintptr>(layout.per_vertex_size);
+    const auto vertices_size = static_cast<GLintptr>(layout.vertices_size);
+    const GLintptr offset = ((page_offset + stride - 1) / stride) * stride;
+    // the data follows with commit()
+    m_pending.push_back(PendingUpload{offset, id});
+
+    Mesh* mesh = packed.mesh;
+    mesh->m_indices = reinterpret_cast<GLvoid*>(offset + vertices_size);
+    mesh->m_basevertex = static_cast<GLint>(offset / stride);
+    for (std::size_t i = 0; i < packed.lod_offsets.size(); ++i) {
+        mesh->m_lods[i].indices = reinterpret_cast<GLvoid*>(offset + packed.lod_offsets[i]);
+    }
+    mesh->m_resident = true;
+
+    auto* mesh_data = m_mesh_pool.get(packed.mesh_handle);
+    mesh_data->first = static_cast<GLuint>(offset / static_cast<GLintptr>(sizeof(float)));
+    mesh_data->firstIndex = static_cast<GLuint>((offset + vertices_size) /
+            static_cast<GLintptr>(layout.per_index_size));
+}
+
+/****************************************************************************/
+
+void MeshManager::evict(const GeometryPager::Id id)
+{
+    m_packed[id].mesh->m_resident = false;
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(),
+                [id] (const PendingUpload& pending) -> bool
+                {
+                    return pending.id == id;
+                }), m_pending.end());
+}
+
+/****************************************************************************/
+
+// Uploads that are less than a page apart are merged in m_staging, the gap
+// only covers unused bytes of their own pages. Meshes without a packed copy
+// are packed into m_staging from their scene, page faults bring the
+// dropped pages of a mapped cache back in.
+void MeshManager::commit()
+{
+    std::sort(m_pending.begin(), m_pending.end(),
+            [] (const PendingUpload& u0, const PendingUpload& u1) -> bool
+            {
+                return u0.offset < u1.offset;
+            });
+
+    const auto max_gap = static_cast<GLintptr>(m_pager.getPageSize());
+    std::size_t first = 0;
+    while (first < m_pending.size()) {
+        const GLintptr begin = m_pending[first].offset;
+        GLintptr end = begin + static_cast<GLintptr>(m_packed[m_pending[first].id].layout.size);
+        std::size_t last = first + 1;
+        for (; last < m_pending.size() && m_pending[last].offset - end < max_gap; ++last) {
+            end = m_pending[last].offset +
+                static_cast<GLintptr>(m_packed[m_pending[last].id].layout.size);
+        }
+
+        const GLubyte* data = m_packed[m_pending[first].id].data;
+        if (last - first > 1 || data == nullptr) {
+            m_staging.resize(static_cast<std::size_t>(end - begin));
+            for (std::size_t i = first; i < last; ++i) {
+                const auto& packed = m_packed[m_pending[i].id];
+                GLubyte* dst = m_staging.data() + (m_pending[i].offset - begin);
+                if (packed.data != nullptr) {
+                    std::memcpy(dst, packed.data, packed.layout.size);
+                } else {
+                    packMesh(packed.source, packed.layout, dst);
+                }
+            }
+            data = m_staging.data();
+        }
+        glNamedBufferSubDataEXT(m_data, begin, end - begin, data);
+
+        first = last;
+    }
+    m_pending.clear();
+}
+
+/****************************************************************************/
+
+void MeshManager::flush()
+{
+    m_mesh_pool.flush();
+}
+
+/****************************************************************************/
+
 void MeshManager::bind() const
 {
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindings::VERTEX,
-            m_data.buffer());
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindings::MESH,
-            m_mesh_pool.buffer());
+            m_data);
+    m_mesh_pool.bind(GL_SHADER_STORAGE_BUFFER, bindings::MESH);
 }
 
 /****************************************************************************/
 
 GLuint MeshManager::getElementArrayBuffer() const
 {
-    return m_data.buffer().get();
+    return m_data.get();
+}
+
+/****************************************************************************/
+
+const GeometryPager& MeshManager::getPager() const
+{
+    return m_pager;
 }
 
 /****************************************************************************/
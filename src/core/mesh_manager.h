@@ -1,51 +1,115 @@
 #ifndef CORE_MESH_MANAGER_H
 #define CORE_MESH_MANAGER_H
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 #include "gl/gl_objects.h"
 #include "mesh.h"
 #include "managers.h"
-#include "buffer_storage.h"
+#include "geometry_pager.h"
+#include "mesh_packer.h"
 #include "buffer_storage_pool.h"
 #include "shader_interface.h"
+#include "util/thread_pool.h"
 
 namespace import
 {
 class Mesh;
+class MeshBatch;
+struct Scene;
 } // namespace import
 
 namespace core
 {
 
-class MeshManager
+/*
+ * The vertex buffer is split into pages of vars.geometry_page_size bytes,
+ * so a scene may exceed vars.vertex_buffer_size. update() pages in the
+ * meshes of visible instances and evicts the least recently visible ones
+ * (see GeometryPager). Meshes of a cached scene are packed again from the
+ * cache when they're paged in, the others keep their packed copy.
+ */
+class MeshManager : private GeometryPager::Backend
 {
 public:
     MeshManager();
     ~MeshManager();
 
-    Mesh* addMesh(const import::Mesh* mesh);
+    using SceneRef = std::shared_ptr<const import::Scene>;
+
+    // Meshes with identical geometry (see import::Mesh::hashGeometry())
+    // share one Mesh, regardless of their name and scene file. 'scene'
+    // owns the meshes, if it's set the packed copy is dropped after the
+    // upload and the scene is kept instead.
+    Mesh* addMesh(const import::Mesh* mesh, SceneRef scene = nullptr);
+    // Packs the meshes on worker threads into one staging arena and
+    // uploads them at once. The result is in the order of 'meshes'.
+    std::vector<Mesh*> addMeshes(const std::vector<const import::Mesh*>& meshes,
+            SceneRef scene = nullptr);
+    // the parts of the batch keep their bounding boxes, see Mesh::parts()
+    Mesh* addBatch(import::MeshBatch& batch);
     Mesh* getMesh(const char* name);
     const Mesh* getMesh(const char* name) const;
 
     GLuint getVAO(const Mesh* mesh) const;
     GLuint getElementArrayBuffer() const;
+    const GeometryPager& getPager() const;
 
+    bool update();
+    // once per frame, see BufferStoragePool::flush()
+    void flush();
     void bind() const;
 
 private:
+    using Arena = std::vector<GLubyte>;
     using MeshPool = BufferStoragePool<shader::MeshStruct>;
-    using MeshMap = std::unordered_map<std::string, std::unique_ptr<Mesh>>;
+
+    struct PackedMesh
+    {
+        Mesh*                   mesh;
+        MeshPool::Handle        mesh_handle;    // in m_mesh_pool
+        PackedMeshLayout        layout;
+        const import::Mesh*     source;         // packed again by commit()
+        SceneRef                scene;          // owns source
+        std::shared_ptr<Arena>  arena;          // of the addMeshes() call
+        const GLubyte*          data;           // see packMesh(), null with source
+        std::vector<GLintptr>   lod_offsets;    // relative to data
+    };
+
+    struct PendingUpload
+    {
+        GLintptr                offset;
+        GeometryPager::Id       id;
+    };
+
+    using MeshMap = std::unordered_map<std::string, Mesh*>;
+    using GeometryMap = std::unordered_multimap<std::uint64_t, std::unique_ptr<Mesh>>;
     using VAOMap = std::unordered_map<unsigned char, gl::VertexArray>;
 
     void initVAOs();
+    void initQuantizedVAO(util::bitfield<MeshComponents> components);
+
+    Mesh* findMesh(const import::Mesh* mesh);
+    Mesh* createMesh(const import::Mesh* mesh, PackedMesh& packed);
+
+    void upload(GeometryPager::Id id, std::size_t first_page) override;
+    void evict(GeometryPager::Id id) override;
+    void commit();
 
     MeshMap             m_meshes;
-    BufferStorage       m_data;
+    GeometryMap         m_geometry;
+    gl::Buffer          m_data;
+    GeometryPager       m_pager;
+    std::vector<PackedMesh> m_packed;   // by pager id
+    std::vector<PendingUpload> m_pending;
+    Arena               m_staging;
     VAOMap              m_vaos;
     MeshPool            m_mesh_pool;
+    util::ThreadPool    m_pack_threads;
 };
 
 } // namespace core
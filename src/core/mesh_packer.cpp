@@ -0,0 +1,242 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include <emmintrin.h>
+#include <glm/packing.hpp>
+
+#include "mesh_packer.h"
+#include "import/mesh.h"
+
+namespace core
+{
+
+/****************************************************************************/
+
+namespace
+{
+
+// octahedral mapping of a unit vector, stored as two snorm16
+std::uint32_t octEncode(const glm::vec3& v)
+{
+    const float l1 = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    if (l1 == .0f)
+        return glm::packSnorm2x16(glm::vec2(.0f));
+
+    const glm::vec3 n = v / l1;
+    glm::vec2 e(n.x, n.y);
+    if (n.z < .0f) {
+        e = (glm::vec2(1.f) - glm::abs(glm::vec2(n.y, n.x))) *
+            glm::vec2(n.x >= .0f ? 1.f : -1.f, n.y >= .0f ? 1.f : -1.f);
+    }
+    return glm::packSnorm2x16(e);
+}
+
+/****************************************************************************/
+
+// +1 or -1, reconstructs the normal from tangent and bitangent
+float reflection(const import::Mesh* mesh, const std::uint32_t i)
+{
+    return (glm::dot(mesh->normals[i],
+            glm::cross(mesh->tangents[i], mesh->bitangents[i])) > .0f) ? 1.f : -1.f;
+}
+
+/****************************************************************************/
+
+// The order is specified in shader::MeshStruct (shader_interface.h).
+std::uint8_t* writeVertices(const import::Mesh* mesh, const PackedMeshLayout& layout,
+        std::uint8_t* data)
+{
+    const bool has_texcoords = mesh->hasTexCoords();
+    const bool has_tangents = mesh->hasTangents();
+    const bool has_normals = mesh->hasNormals();
+    float* dst = reinterpret_cast<float*>(data);
+    for (std::uint32_t i = 0; i < mesh->num_vertices; ++i) {
+        std::memcpy(dst, &mesh->vertices[i], 3 * sizeof(float));
+        dst += 3;
+        if (has_texcoords) {
+            std::memcpy(dst, &mesh->texcoords[i], 2 * sizeof(float));
+            dst += 2;
+        }
+        // if mesh has tangents, then use we use tangent
+        // and bitangent plus a reflect float to reconstruct
+        // the normal
+        if (has_tangents) {
+            std::memcpy(dst, &mesh->tangents[i], 3 * sizeof(float));
+            std::memcpy(dst + 3, &mesh->bitangents[i], 3 * sizeof(float));
+            dst[6] = reflection(mesh, i);
+            dst += 7;
+        } else if (has_normals) {
+            std::memcpy(dst, &mesh->normals[i], 3 * sizeof(float));
+            dst += 3;
+        }
+    }
+    assert(reinterpret_cast<std::uint8_t*>(dst) == data + layout.vertices_size);
+
+    return data + layout.vertices_size;
+}
+
+/****************************************************************************/
+
+// Quantized layout, one 32 bit word each:
+//   position xy (unorm16, relative to the bbox)
+//   position z, reflect normal (unorm16, 0: -1, 1: +1)
+//   [texcoords (half)]
+//   [normal (octahedral)] or [tangent (octahedral), bitangent (octahedral)]
+std::uint8_t* writeQuantizedVertices(const import::Mesh* mesh, const PackedMeshLayout& layout,
+        std::uint8_t* data)
+{
+    const std::size_t stride = layout.per_vertex_size / sizeof(std::uint32_t);
+    const std::uint32_t num_vertices = mesh->num_vertices;
+    std::uint32_t* dst = reinterpret_cast<std::uint32_t*>(data);
+
+    // all four unorm16 of a position at once
+    const glm::vec3 pmin = mesh->bbox.pmin;
+    const glm::vec3 extent = mesh->bbox.pmax - mesh->bbox.pmin;
+    const __m128 offset = _mm_setr_ps(pmin.x, pmin.y, pmin.z, .0f);
+    const __m128 scale = _mm_setr_ps(extent.x > .0f ? 1.f / extent.x : .0f,
+            extent.y > .0f ? 1.f / extent.y : .0f,
+            extent.z > .0f ? 1.f / extent.z : .0f, 1.f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 max16 = _mm_set1_ps(65535.f);
+    const __m128 half = _mm_set1_ps(.5f);
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16(-32768);
+    const bool has_tangents = mesh->hasTangents();
+    for (std::uint32_t i = 0; i < num_vertices; ++i) {
+        const glm::vec3& v = mesh->vertices[i];
+        const float reflect_normal = (has_tangents && reflection(mesh, i) < .0f) ? .0f : 1.f;
+        __m128 p = _mm_setr_ps(v.x, v.y, v.z, reflect_normal);
+        p = _mm_mul_ps(_mm_sub_ps(p, offset), scale);
+        p = _mm_min_ps(_mm_max_ps(p, zero), one);
+        // unsigned to signed and back, SSE2 only packs signed integers
+        // rounds like glm::packUnorm2x16()
+        p = _mm_add_ps(_mm_mul_ps(p, max16), half);
+        __m128i u = _mm_sub_epi32(_mm_cvttps_epi32(p), bias32);
+        u = _mm_add_epi16(_mm_packs_epi32(u, u), bias16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * stride), u);
+    }
+    dst += 2;
+
+    if (mesh->hasTexCoords()) {
+        for (std::uint32_t i = 0; i < num_vertices; ++i) {
+            dst[i * stride] = glm::packHalf2x16(mesh->texcoords[i]);
+        }
+        dst += 1;
+    }
+    if (has_tangents) {
+        for (std::uint32_t i = 0; i < num_vertices; ++i) {
+            dst[i * stride] = octEncode(mesh->tangents[i]);
+            dst[i * stride + 1] = octEncode(mesh->bitangents[i]);
+        }
+    } else if (mesh->hasNormals()) {
+        for (std::uint32_t i = 0; i < num_vertices; ++i) {
+            dst[i * stride] = octEncode(mesh->normals[i]);
+        }
+    }
+
+    return data + layout.vertices_size;
+}
+
+/****************************************************************************/
+
+std::uint8_t* writeIndices(const std::uint32_t* src, const std::uint32_t count,
+        const std::size_t per_index_size, std::uint8_t* indices)
+{
+    std::uint32_t i = 0;
+    if (per_index_size == sizeof(std::uint32_t)) {
+        if (count > 0)
+            std::memcpy(indices, src, count * sizeof(std::uint32_t));
+        return indices + count * sizeof(std::uint32_t);
+    }
+
+    // unsigned to signed and back, SSE2 only packs signed integers
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16(-32768);
+    const __m128i* in = reinterpret_cast<const __m128i*>(src);
+    __m128i* out = reinterpret_cast<__m128i*>(indices);
+    if (per_index_size == sizeof(std::uint16_t)) {
+        for (; i + 8 <= count; i += 8, in += 2) {
+            const __m128i lo = _mm_sub_epi32(_mm_loadu_si128(in), bias32);
+            const __m128i hi = _mm_sub_epi32(_mm_loadu_si128(in + 1), bias32);
+            _mm_storeu_si128(out++, _mm_add_epi16(_mm_packs_epi32(lo, hi), bias16));
+        }
+        std::uint16_t* idx = reinterpret_cast<std::uint16_t*>(out);
+        for (; i < count; ++i) {
+            *idx++ = static_cast<std::uint16_t>(src[i]);
+        }
+        return reinterpret_cast<std::uint8_t*>(idx);
+    }
+
+    assert(per_index_size == sizeof(std::uint8_t));
+    for (; i + 16 <= count; i += 16, in += 4) {
+        const __m128i lo = _mm_packs_epi32(_mm_loadu_si128(in), _mm_loadu_si128(in + 1));
+        const __m128i hi = _mm_packs_epi32(_mm_loadu_si128(in + 2), _mm_loadu_si128(in + 3));
+        _mm_storeu_si128(out++, _mm_packus_epi16(lo, hi));
+    }
+    std::uint8_t* idx = reinterpret_cast<std::uint8_t*>(out);
+    for (; i < count; ++i) {
+        *idx++ = static_cast<std::uint8_t>(src[i]);
+    }
+    return idx;
+}
+
+} // anonymous namespace
+
+/****************************************************************************/
+
+PackedMeshLayout getPackedMeshLayout(const import::Mesh* mesh, const bool quantize)
+{
+    // observe the order in 'shader_interface.h'
+    PackedMeshLayout layout;
+    if (quantize)
+        layout.components |= MeshComponents::Quantized;
+    layout.per_vertex_size = (quantize ? 2 : 3) * sizeof(float);
+    if (mesh->hasTexCoords()) {
+        layout.per_vertex_size += (quantize ? 1 : 2) * sizeof(float);
+        layout.components |= MeshComponents::TexCoords;
+    }
+    if (mesh->hasTangents()) {
+        layout.per_vertex_size += (quantize ? 2 : 7) * sizeof(float);
+        layout.components |= MeshComponents::Tangents;
+    } else if (mesh->hasNormals()) {
+        layout.per_vertex_size += (quantize ? 1 : 3) * sizeof(float);
+        layout.components |= MeshComponents::Normals;
+    }
+
+    if (mesh->num_vertices < 256)
+        layout.per_index_size = sizeof(std::uint8_t);
+    else if (mesh->num_vertices < 65535)
+        layout.per_index_size = sizeof(std::uint16_t);
+    else
+        layout.per_index_size = sizeof(std::uint32_t);
+
+    layout.vertices_size = layout.per_vertex_size * mesh->num_vertices;
+    // the LODs follow the indices of the full mesh
+    layout.size = layout.vertices_size + layout.per_index_size *
+        (mesh->num_indices + mesh->num_lod_indices);
+
+    return layout;
+}
+
+/****************************************************************************/
+
+void packMesh(const import::Mesh* mesh, const PackedMeshLayout& layout, std::uint8_t* dst)
+{
+    // since we're only pushing 4 byte words into the buffer,
+    // the start of out index array is always aligned to
+    // 4 bytes... good
+    std::uint8_t* indices = (layout.components & MeshComponents::Quantized) ?
+        writeQuantizedVertices(mesh, layout, dst) :
+        writeVertices(mesh, layout, dst);
+    indices = writeIndices(mesh->indices, mesh->num_indices, layout.per_index_size, indices);
+    indices = writeIndices(mesh->lod_indices, mesh->num_lod_indices, layout.per_index_size,
+            indices);
+    assert(static_cast<std::size_t>(indices - dst) == layout.size);
+    static_cast<void>(indices);
+}
+
+/****************************************************************************/
+
+} // namespace core
@@ -0,0 +1,38 @@
+#ifndef CORE_MESH_PACKER_H
+#define CORE_MESH_PACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "util/bitfield.h"
+#include "mesh_components.h"
+
+namespace import
+{
+struct Mesh;
+} // namespace import
+
+namespace core
+{
+
+// Layout of a mesh in the vertex buffer: interleaved vertices (in the
+// order of shader::MeshStruct), followed by the indices and the LOD indices.
+// Sizes are in bytes, indices are 1, 2 or 4 bytes.
+struct PackedMeshLayout
+{
+    util::bitfield<MeshComponents> components;
+    std::size_t per_vertex_size;
+    std::size_t per_index_size;
+    std::size_t vertices_size;
+    std::size_t size;
+};
+
+PackedMeshLayout getPackedMeshLayout(const import::Mesh* mesh, bool quantize);
+
+// Writes layout.size bytes to the 4 byte aligned 'dst'. Doesn't call
+// OpenGL, so meshes can be packed on any thread.
+void packMesh(const import::Mesh* mesh, const PackedMeshLayout& layout, std::uint8_t* dst);
+
+} // namespace core
+
+#endif // CORE_MESH_PACKER_H
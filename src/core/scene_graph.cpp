@@ -0,0 +1,190 @@
+#include <cassert>
+
+#include "scene_graph.h"
+#include "instance.h"
+#include "log/log.h"
+
+namespace core
+{
+
+/****************************************************************************/
+
+SceneGraph::SceneGraph()
+  : m_has_modified{false},
+    m_transforms{nullptr},
+    m_batch_first{NO_NODE}
+{
+}
+
+/****************************************************************************/
+
+SceneGraph::~SceneGraph() = default;
+
+/****************************************************************************/
+
+NodeId SceneGraph::addNode(NodeId parent, const glm::mat4& local, Instance* instance)
+{
+    const auto node = static_cast<NodeId>(m_parents.size());
+    if (parent != NO_NODE && (parent >= node || parent + m_subtree_sizes[parent] != node)) {
+        LOG_ERROR("Scene graph node ", node, " is not added depth-first, "
+                "attaching it to the root");
+        parent = NO_NODE;
+    }
+
+    m_parents.push_back(parent);
+    m_subtree_sizes.push_back(1);
+    m_local.push_back(local);
+    m_world.push_back(local);
+    m_instances.push_back(instance);
+    if (node % 64 == 0)
+        m_modified.push_back(0);
+    for (NodeId p = parent; p != NO_NODE; p = m_parents[p]) {
+        ++m_subtree_sizes[p];
+    }
+
+    if (instance != nullptr) {
+        if (instance->m_node != NO_NODE)
+            m_instances[instance->m_node] = nullptr;
+        instance->m_node = node;
+        instance->m_update_members = true;
+        assert(m_transforms == nullptr || m_transforms == &instance->m_transforms);
+        m_transforms = &instance->m_transforms;
+    }
+    setModified(node);
+
+    return node;
+}
+
+/****************************************************************************/
+
+NodeId SceneGraph::getParent(const NodeId node) const
+{
+    return m_parents[node];
+}
+
+/****************************************************************************/
+
+Instance* SceneGraph::getInstance(const NodeId node) const
+{
+    return m_instances[node];
+}
+
+/****************************************************************************/
+
+void SceneGraph::setLocalTransformation(const NodeId node, const glm::mat4& local)
+{
+    if (m_instances[node] != nullptr) {
+        LOG_ERROR("Scene graph node ", node, " takes its transformation from its instance");
+        return;
+    }
+    m_local[node] = local;
+    setModified(node);
+}
+
+/****************************************************************************/
+
+glm::mat4 SceneGraph::getLocalTransformation(const NodeId node) const
+{
+    const Instance* instance = m_instances[node];
+    return instance != nullptr ? instance->getLocalTransformation() : m_local[node];
+}
+
+/****************************************************************************/
+
+const glm::mat4& SceneGraph::getWorldTransformation(const NodeId node) const
+{
+    const Instance* instance = m_instances[node];
+    return instance != nullptr ? m_transforms->getWorld(instance->m_transform) : m_world[node];
+}
+
+/****************************************************************************/
+
+void SceneGraph::setModified(const NodeId node)
+{
+    assert(node < m_parents.size());
+    m_modified[node / 64] |= std::uint64_t(1) << (node % 64);
+    m_has_modified = true;
+}
+
+/****************************************************************************/
+
+bool SceneGraph::update()
+{
+    if (!m_has_modified)
+        return false;
+
+    // parents first, nested modified nodes are covered by their ancestor's range
+    NodeId end = 0;
+    for (std::size_t word = 0; word < m_modified.size(); ++word) {
+        std::uint64_t bits = m_modified[word];
+        m_modified[word] = 0;
+        while (bits != 0) {
+            const auto first = static_cast<NodeId>(64 * word +
+                    static_cast<std::size_t>(__builtin_ctzll(bits)));
+            bits &= bits - 1;
+            if (first < end)
+                continue;
+            end = first + m_subtree_sizes[first];
+            updateRange(first, end);
+        }
+    }
+    composeBatch();
+    m_has_modified = false;
+
+    return true;
+}
+
+/****************************************************************************/
+
+void SceneGraph::updateRange(const NodeId first, const NodeId end)
+{
+    for (NodeId node = first; node < end; ++node) {
+        const NodeId parent = m_parents[node];
+        // children of instances wait for their parent's batch
+        if (parent != NO_NODE && parent >= m_batch_first && m_instances[parent] != nullptr)
+            composeBatch();
+        const glm::mat4* parent_world = parent == NO_NODE ?
+            nullptr : &getWorldTransformation(parent);
+
+        Instance* instance = m_instances[node];
+        if (instance != nullptr) {
+            if (m_batch_instances.empty())
+                m_batch_first = node;
+            m_batch_instances.push_back(instance);
+            m_batch_ids.push_back(instance->m_transform);
+            m_batch_parents.push_back(parent_world);
+        } else {
+            m_world[node] = parent_world == nullptr ? m_local[node] : *parent_world * m_local[node];
+        }
+    }
+}
+
+/****************************************************************************/
+
+// the instance nodes since the last call, in one TransformStore::compose()
+void SceneGraph::composeBatch()
+{
+    if (m_batch_instances.empty())
+        return;
+
+    m_transforms->compose(m_batch_ids.data(), m_batch_ids.size(), m_batch_parents.data());
+    for (auto* instance : m_batch_instances) {
+        instance->worldModified();
+    }
+
+    m_batch_first = NO_NODE;
+    m_batch_instances.clear();
+    m_batch_ids.clear();
+    m_batch_parents.clear();
+}
+
+/****************************************************************************/
+
+std::size_t SceneGraph::size() const
+{
+    return m_parents.size();
+}
+
+/****************************************************************************/
+
+} // namespace core
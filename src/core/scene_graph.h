@@ -0,0 +1,71 @@
+#ifndef CORE_SCENE_GRAPH_H
+#define CORE_SCENE_GRAPH_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "managers.h"
+#include "transform_store.h"
+
+namespace core
+{
+
+class Instance;
+
+using NodeId = std::uint32_t;
+constexpr NodeId NO_NODE = 0xFFFFFFFF;
+
+/*
+ * Parent/child transformations, stored in flat arrays. Nodes have to be
+ * added depth-first (a new node's parent has to be the last subtree), so
+ * every subtree is a contiguous range and update() only walks the ranges
+ * below modified nodes (one bit per node). Nodes with an instance take
+ * their local transformation from the instance and keep their world
+ * transformation in the instances' TransformStore, which composes them in
+ * batches.
+ */
+class SceneGraph
+{
+public:
+    SceneGraph();
+    ~SceneGraph();
+
+    NodeId addNode(NodeId parent, const glm::mat4& local, Instance* instance = nullptr);
+
+    NodeId getParent(NodeId node) const;
+    Instance* getInstance(NodeId node) const;
+
+    // for nodes without an instance
+    void setLocalTransformation(NodeId node, const glm::mat4& local);
+    glm::mat4 getLocalTransformation(NodeId node) const;
+
+    // valid after update()
+    const glm::mat4& getWorldTransformation(NodeId node) const;
+
+    void setModified(NodeId node);
+    bool update();
+
+    std::size_t size() const;
+
+private:
+    void updateRange(NodeId first, NodeId end);
+    void composeBatch();
+
+    std::vector<NodeId>     m_parents;
+    std::vector<NodeId>     m_subtree_sizes;    // including the node itself
+    std::vector<glm::mat4>  m_local;            // of the nodes without an instance
+    std::vector<glm::mat4>  m_world;            // of the nodes without an instance
+    std::vector<Instance*>  m_instances;
+    std::vector<std::uint64_t> m_modified;      // one bit per node
+    bool                    m_has_modified;
+    TransformStore*         m_transforms;       // of the instances
+    NodeId                  m_batch_first;      // see composeBatch()
+    std::vector<Instance*>  m_batch_instances;
+    std::vector<TransformId> m_batch_ids;
+    std::vector<const glm::mat4*> m_batch_parents;
+};
+
+} // namespace core
+
+#endif // CORE_SCENE_GRAPH_H
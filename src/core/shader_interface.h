@@ -120,8 +120,10 @@ struct MeshStruct
     GLuint                          first;
     GLuint                          firstIndex;
     GLuint                          count;
+    GLfloat                         bboxMin[3];     // dequantization of
+    GLfloat                         bboxExtent[3];  // the positions
 };
-static_assert(sizeof(MeshStruct) == 20 &&
+static_assert(sizeof(MeshStruct) == 44 &&
         sizeof(MeshStruct) % MeshStruct::alignment() == 0, "");
 
 struct LightStruct
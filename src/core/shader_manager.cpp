@@ -9,6 +9,7 @@
 
 #include "framework/vars.h"
 #include "log/log.h"
+#include "util/hash.h"
 #include "gl/program.h"
 #include "gl/shader.h"
 #include "gl/shadersource.h"
@@ -24,12 +25,25 @@ namespace
 
 struct CacheFile
 {
-    GLenum      binary_format;
-    int         num_shaders;
-    int         num_files;
-    bool        is_separable;
+    GLenum          binary_format;
+    int             num_shaders;
+    int             num_files;
+    bool            is_separable;
+    std::uint64_t   source_hash;
 };
 
+// contents of all files a program was built from, in order
+std::uint64_t hashSources(const std::vector<std::string>& files)
+{
+    util::Hasher hasher;
+    for (const auto& file : files) {
+        hasher.update(file);
+        if (!util::hashFile(file, hasher))
+            return 0;
+    }
+    return hasher.digest();
+}
+
 } // anonmymous namespace
 
 /****************************************************************************/
@@ -490,6 +504,7 @@ std::string ShaderManager::program_id(const ProgramInfo& p) const
     id += reinterpret_cast<const char*>(glGetString(GL_VERSION));
     id += reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION));
     id += reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    id += m_defines_str;
     id += '_' + std::to_string(p.shaders.size()) + '_';
     for (std::size_t i = 0; i < p.shaders.size(); ++i) {
         const auto& name = p.shaders[i];
@@ -505,7 +520,8 @@ std::string ShaderManager::program_id(const ProgramInfo& p) const
 
 bool ShaderManager::load_cached_program(ProgramInfo& p, const std::string& id) const
 {
-    const path cache_file = vars.cache_dir / "shaders" / std::to_string(m_hasher(id));
+    const path cache_file = vars.cache_dir / "shaders" /
+        std::to_string(util::hash64(id.data(), id.size()));
 
     if (!exists(cache_file) || !is_regular_file(cache_file)) {
         return false;
@@ -575,15 +591,8 @@ bool ShaderManager::load_cached_program(ProgramInfo& p, const std::string& id) c
         assert(ptr < end);
     }
 
-    // check time of last modification on files
-    const auto last_write = last_write_time(cache_file);
-    for (const auto& f : filenames) {
-        if (last_write < last_write_time(f)) {
-            valid = false;
-            break;
-        }
-    }
-    if (!valid) {
+    // check the contents of the files, the times change with every checkout
+    if (header->source_hash != hashSources(filenames)) {
         std::remove(cache_file.c_str());
         return false;
     }
@@ -606,7 +615,7 @@ bool ShaderManager::load_cached_program(ProgramInfo& p, const std::string& id) c
 void ShaderManager::save_program(const ProgramInfo& info, const std::string& id) const
 {
     path cache_dir = vars.cache_dir / "shaders";
-    path cache_file = cache_dir / std::to_string(m_hasher(id));
+    path cache_file = cache_dir / std::to_string(util::hash64(id.data(), id.size()));
 
     create_directories(cache_dir);
     std::ofstream os(cache_file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
@@ -623,6 +632,7 @@ void ShaderManager::save_program(const ProgramInfo& info, const std::string& id)
     header.is_separable = info.is_separable;
     header.num_files = static_cast<int>(info.files.size());
     header.num_shaders = static_cast<int>(info.shaders.size());
+    header.source_hash = hashSources(info.files);
 
     os.write(reinterpret_cast<const char*>(&header), sizeof(CacheFile));
 
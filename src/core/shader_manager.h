@@ -80,7 +80,6 @@ private:
     mutable std::vector<ShaderInfo>                 m_shaders;
     mutable std::vector<ProgramInfo>                m_programs;
     mutable std::vector<PipelineInfo>               m_pipelines;
-    std::hash<std::string>                          m_hasher;
     std::time_t                                     m_timestamp;
 
 };
@@ -1,6 +1,7 @@
 #include "texture_manager.h"
 #include "log/log.h"
 #include "import/image.h"
+#include "import/texture_data.h"
 #include "framework/vars.h"
 
 namespace core
@@ -10,6 +11,33 @@ namespace core
 
 static constexpr int MAX_NUM_TEXTURES = 1024;
 
+/****************************************************************************/
+
+// leaves the texture bound to GL_TEXTURE_2D
+static gl::Texture createTexture(const GLsizei levels, const GLenum internal_format,
+        const GLsizei width, const GLsizei height)
+{
+    gl::Texture tex;
+    glBindTexture(GL_TEXTURE_2D, tex);
+
+    glTexStorage2D(GL_TEXTURE_2D, levels, internal_format, width, height);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+            static_cast<GLint>(gl::stringToEnum(vars.tex_min_filter)));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+            static_cast<GLint>(gl::stringToEnum(vars.tex_mag_filter)));
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT,
+            vars.tex_max_anisotropy);
+    glTexParameteri(GL_TEXTURE_2D,  GL_TEXTURE_WRAP_S,
+             GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D,  GL_TEXTURE_WRAP_T,
+             GL_REPEAT);
+
+    return tex;
+}
+
+/****************************************************************************/
+
 TextureManager::TextureManager()
 {
 }
@@ -29,22 +57,8 @@ Texture* TextureManager::addTexture(const std::string& name, const import::Image
     else if (numChannels == 3)
         internal_format = GL_RGB8;
 
-    gl::Texture tex;
-    glBindTexture(GL_TEXTURE_2D, tex);
-
-    glTexStorage2D(GL_TEXTURE_2D, image.maxNumMipMaps(),
-            internal_format, image.width(), image.height());
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-            static_cast<GLint>(gl::stringToEnum(vars.tex_min_filter)));
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-            static_cast<GLint>(gl::stringToEnum(vars.tex_mag_filter)));
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT,
-            vars.tex_max_anisotropy);
-    glTexParameteri(GL_TEXTURE_2D,  GL_TEXTURE_WRAP_S,
-             GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D,  GL_TEXTURE_WRAP_T,
-             GL_REPEAT);
+    gl::Texture tex = createTexture(image.maxNumMipMaps(), internal_format,
+            static_cast<GLsizei>(image.width()), static_cast<GLsizei>(image.height()));
 
     glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0,
             static_cast<GLsizei>(image.width()), static_cast<GLsizei>(image.height()),
@@ -75,6 +89,33 @@ Texture* TextureManager::addTexture(const std::string& name, const import::Image
 
 /****************************************************************************/
 
+Texture* TextureManager::addTexture(const std::string& name, const import::TextureData& data)
+{
+    const auto& base = data.levels[0];
+    gl::Texture tex = createTexture(static_cast<GLsizei>(data.levels.size()),
+            data.internal_format, static_cast<GLsizei>(base.width),
+            static_cast<GLsizei>(base.height));
+
+    // the mip chain is baked, no glGenerateMipmap()
+    for (std::size_t i = 0; i < data.levels.size(); ++i) {
+        const auto& level = data.levels[i];
+        if (data.compression != import::BlockFormat::None) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), 0, 0,
+                    static_cast<GLsizei>(level.width), static_cast<GLsizei>(level.height),
+                    data.internal_format, static_cast<GLsizei>(level.size),
+                    data.data.data() + level.offset);
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), 0, 0,
+                    static_cast<GLsizei>(level.width), static_cast<GLsizei>(level.height),
+                    data.format, data.type, data.data.data() + level.offset);
+        }
+    }
+
+    return addTexture(name, std::move(tex), data.num_channels);
+}
+
+/****************************************************************************/
+
 Texture* TextureManager::addTexture(const std::string& name, gl::Texture&& texture,
         const int num_channels)
 {
@@ -12,6 +12,7 @@
 namespace import
 {
 class Image;
+struct TextureData;
 }
 
 namespace core
@@ -24,6 +25,7 @@ public:
     ~TextureManager();
 
     Texture* addTexture(const std::string& name, const import::Image& image);
+    Texture* addTexture(const std::string& name, const import::TextureData& data);
     Texture* addTexture(const std::string& name, gl::Texture&& texture, int num_channels);
 
     Texture* getTexture(const std::string& name);
@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <cassert>
+#include <emmintrin.h>
+
+#include "transform_store.h"
+
+namespace core
+{
+
+/****************************************************************************/
+
+constexpr unsigned int TransformStore::NUM_COMPONENTS;
+
+/****************************************************************************/
+
+namespace
+{
+
+enum Component : unsigned int
+{
+    PX, PY, PZ,     // position
+    QX, QY, QZ, QW, // orientation
+    SX, SY, SZ,     // scale
+    CX, CY, CZ,     // center and half extent of the bounds
+    EX, EY, EZ,
+    NUM
+};
+
+constexpr float DEFAULTS[NUM] = {
+    0.f, 0.f, 0.f,
+    0.f, 0.f, 0.f, 1.f,
+    1.f, 1.f, 1.f,
+    0.f, 0.f, 0.f,
+    0.f, 0.f, 0.f
+};
+
+/****************************************************************************/
+
+// the four transformations of one SSE iteration
+struct Block
+{
+    std::size_t         ids[4];
+    const glm::mat4*    parents[4];     // nullptr: none
+    bool                consecutive;    // ids[0], ids[0] + 1, ...
+    bool                has_parents;
+};
+
+/****************************************************************************/
+
+__m128 load(const std::vector<float>& component, const Block& block)
+{
+    if (block.consecutive)
+        return _mm_loadu_ps(&component[block.ids[0]]);
+    return _mm_set_ps(component[block.ids[3]], component[block.ids[2]],
+            component[block.ids[1]], component[block.ids[0]]);
+}
+
+/****************************************************************************/
+
+// blocks of four consecutive transformations, the arrays are padded
+struct Consecutive
+{
+    Block operator()(const std::size_t block) const
+    {
+        Block result;
+        for (unsigned int lane = 0; lane < 4; ++lane) {
+            result.ids[lane] = 4 * block + lane;
+            result.parents[lane] = nullptr;
+        }
+        result.consecutive = true;
+        result.has_parents = false;
+        return result;
+    }
+};
+
+/****************************************************************************/
+
+// blocks from a list of ids, the last block repeats the last id
+struct Gathered
+{
+    const TransformId*          ids;
+    const glm::mat4* const*     parents;    // optional, by position in ids
+    std::size_t                 count;
+
+    Block operator()(const std::size_t block) const
+    {
+        Block result;
+        const std::size_t first = 4 * block;
+        for (unsigned int lane = 0; lane < 4; ++lane) {
+            const auto i = first + 3 < count ? first + lane : std::min(first + lane, count - 1);
+            result.ids[lane] = ids[i];
+            result.parents[lane] = parents != nullptr ? parents[i] : nullptr;
+        }
+        // sorted ids often are, e.g. the scene graph's
+        result.consecutive = result.ids[1] == result.ids[0] + 1 &&
+            result.ids[2] == result.ids[0] + 2 && result.ids[3] == result.ids[0] + 3;
+        result.has_parents = parents != nullptr;
+        return result;
+    }
+};
+
+/****************************************************************************/
+
+// m = p * m for the four lanes, m has (0, 0, 0, 1) as its last row
+void multiplyParents(__m128 (&m)[4][4], const Block& block)
+{
+    static const glm::mat4 identity(1.f);
+
+    __m128 p[4][4]; // [column][row], like m
+    if (block.parents[0] == block.parents[3] && block.parents[1] == block.parents[3] &&
+            block.parents[2] == block.parents[3]) {
+        // siblings, the usual case
+        const glm::mat4& parent = block.parents[0] != nullptr ? *block.parents[0] : identity;
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                p[c][r] = _mm_set1_ps(parent[c][r]);
+            }
+        }
+    } else {
+        for (int c = 0; c < 4; ++c) {
+            for (unsigned int lane = 0; lane < 4; ++lane) {
+                const glm::mat4* parent = block.parents[lane];
+                p[c][lane] = _mm_loadu_ps(&(parent != nullptr ? *parent : identity)[c][0]);
+            }
+            _MM_TRANSPOSE4_PS(p[c][0], p[c][1], p[c][2], p[c][3]);
+        }
+    }
+
+    for (int c = 0; c < 4; ++c) {
+        __m128 result[4];
+        for (int r = 0; r < 4; ++r) {
+            result[r] = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(p[0][r], m[c][0]), _mm_mul_ps(p[1][r], m[c][1])),
+                    _mm_mul_ps(p[2][r], m[c][2]));
+            if (c == 3)
+                result[r] = _mm_add_ps(result[r], p[3][r]);
+        }
+        for (int r = 0; r < 4; ++r) {
+            m[c][r] = result[r];
+        }
+    }
+}
+
+/****************************************************************************/
+
+template <typename Lanes>
+void composeBlocks(const std::vector<float>* const components, const Lanes& lanes,
+        const std::size_t num_blocks, glm::mat4* const world, AABB* const bounds)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    for (std::size_t b = 0; b < num_blocks; ++b) {
+        const Block block = lanes(b);
+
+        // rotation (as glm::mat3_cast) times scale, one lane per transformation
+        const __m128 qx = load(components[QX], block);
+        const __m128 qy = load(components[QY], block);
+        const __m128 qz = load(components[QZ], block);
+        const __m128 qw = load(components[QW], block);
+        const __m128 x2 = _mm_add_ps(qx, qx);
+        const __m128 y2 = _mm_add_ps(qy, qy);
+        const __m128 z2 = _mm_add_ps(qz, qz);
+        const __m128 xx = _mm_mul_ps(qx, x2);
+        const __m128 yy = _mm_mul_ps(qy, y2);
+        const __m128 zz = _mm_mul_ps(qz, z2);
+        const __m128 xy = _mm_mul_ps(qx, y2);
+        const __m128 xz = _mm_mul_ps(qx, z2);
+        const __m128 yz = _mm_mul_ps(qy, z2);
+        const __m128 wx = _mm_mul_ps(qw, x2);
+        const __m128 wy = _mm_mul_ps(qw, y2);
+        const __m128 wz = _mm_mul_ps(qw, z2);
+        const __m128 sx = load(components[SX], block);
+        const __m128 sy = load(components[SY], block);
+        const __m128 sz = load(components[SZ], block);
+
+        __m128 m[4][4]; // [column][row]
+        m[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+        m[0][1] = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+        m[0][2] = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+        m[0][3] = zero;
+        m[1][0] = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+        m[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+        m[1][2] = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+        m[1][3] = zero;
+        m[2][0] = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+        m[2][1] = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+        m[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+        m[2][3] = zero;
+        m[3][0] = load(components[PX], block);
+        m[3][1] = load(components[PY], block);
+        m[3][2] = load(components[PZ], block);
+        m[3][3] = one;
+        if (block.has_parents)
+            multiplyParents(m, block);
+
+        // center: m * c, half extent: abs(m) * e
+        const __m128 cx = load(components[CX], block);
+        const __m128 cy = load(components[CY], block);
+        const __m128 cz = load(components[CZ], block);
+        const __m128 ex = load(components[EX], block);
+        const __m128 ey = load(components[EY], block);
+        const __m128 ez = load(components[EZ], block);
+        alignas(16) float pmin[3][4];
+        alignas(16) float pmax[3][4];
+        for (int r = 0; r < 3; ++r) {
+            const __m128 c = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(m[0][r], cx), _mm_mul_ps(m[1][r], cy)),
+                    _mm_add_ps(_mm_mul_ps(m[2][r], cz), m[3][r]));
+            const __m128 e = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_and_ps(m[0][r], abs_mask), ex),
+                               _mm_mul_ps(_mm_and_ps(m[1][r], abs_mask), ey)),
+                    _mm_mul_ps(_mm_and_ps(m[2][r], abs_mask), ez));
+            _mm_store_ps(pmin[r], _mm_sub_ps(c, e));
+            _mm_store_ps(pmax[r], _mm_add_ps(c, e));
+        }
+
+        // one column of four matrices per transpose
+        for (int c = 0; c < 4; ++c) {
+            _MM_TRANSPOSE4_PS(m[c][0], m[c][1], m[c][2], m[c][3]);
+        }
+        for (unsigned int lane = 0; lane < 4; ++lane) {
+            const auto i = block.ids[lane];
+            float* const dst = &world[i][0][0];
+            for (int c = 0; c < 4; ++c) {
+                _mm_storeu_ps(dst + 4 * c, m[c][lane]);
+            }
+            bounds[i].pmin = glm::vec3(pmin[0][lane], pmin[1][lane], pmin[2][lane]);
+            bounds[i].pmax = glm::vec3(pmax[0][lane], pmax[1][lane], pmax[2][lane]);
+        }
+    }
+}
+
+} // anonymous namespace
+
+/****************************************************************************/
+
+TransformStore::TransformStore()
+  : m_size{0}
+{
+    static_assert(NUM_COMPONENTS == NUM, "");
+    static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "");
+}
+
+/****************************************************************************/
+
+TransformStore::~TransformStore() = default;
+
+/****************************************************************************/
+
+TransformId TransformStore::add()
+{
+    if (!m_free.empty()) {
+        const TransformId id = m_free.back();
+        m_free.pop_back();
+        return id;
+    }
+    if (m_size == m_world.size()) {
+        const auto padded = m_size + 4;
+        for (unsigned int c = 0; c < NUM; ++c) {
+            m_components[c].resize(padded, DEFAULTS[c]);
+        }
+        m_world.resize(padded, glm::mat4(1.f));
+        m_bounds.resize(padded, AABB(glm::vec3(.0f)));
+    }
+    return static_cast<TransformId>(m_size++);
+}
+
+/****************************************************************************/
+
+// back to the defaults, like a new id
+void TransformStore::remove(const TransformId id)
+{
+    assert(id < m_size);
+    for (unsigned int c = 0; c < NUM; ++c) {
+        m_components[c][id] = DEFAULTS[c];
+    }
+    m_world[id] = glm::mat4(1.f);
+    m_bounds[id] = AABB(glm::vec3(.0f));
+    m_free.push_back(id);
+}
+
+/****************************************************************************/
+
+void TransformStore::setPosition(const TransformId id, const glm::vec3& pos)
+{
+    assert(id < m_size);
+    m_components[PX][id] = pos.x;
+    m_components[PY][id] = pos.y;
+    m_components[PZ][id] = pos.z;
+}
+
+/****************************************************************************/
+
+glm::vec3 TransformStore::getPosition(const TransformId id) const
+{
+    assert(id < m_size);
+    return glm::vec3(m_components[PX][id], m_components[PY][id], m_components[PZ][id]);
+}
+
+/****************************************************************************/
+
+void TransformStore::setOrientation(const TransformId id, const glm::quat& orientation)
+{
+    assert(id < m_size);
+    m_components[QX][id] = orientation.x;
+    m_components[QY][id] = orientation.y;
+    m_components[QZ][id] = orientation.z;
+    m_components[QW][id] = orientation.w;
+}
+
+/****************************************************************************/
+
+glm::quat TransformStore::getOrientation(const TransformId id) const
+{
+    assert(id < m_size);
+    return glm::quat(m_components[QW][id], m_components[QX][id],
+            m_components[QY][id], m_components[QZ][id]);
+}
+
+/****************************************************************************/
+
+void TransformStore::setScale(const TransformId id, const glm::vec3& scale)
+{
+    assert(id < m_size);
+    m_components[SX][id] = scale.x;
+    m_components[SY][id] = scale.y;
+    m_components[SZ][id] = scale.z;
+}
+
+/****************************************************************************/
+
+glm::vec3 TransformStore::getScale(const TransformId id) const
+{
+    assert(id < m_size);
+    return glm::vec3(m_components[SX][id], m_components[SY][id], m_components[SZ][id]);
+}
+
+/****************************************************************************/
+
+void TransformStore::setBounds(const TransformId id, const AABB& bbox)
+{
+    assert(id < m_size);
+    const glm::vec3 c = bbox.center();
+    const glm::vec3 e = .5f * (bbox.pmax - bbox.pmin);
+    m_components[CX][id] = c.x;
+    m_components[CY][id] = c.y;
+    m_components[CZ][id] = c.z;
+    m_components[EX][id] = e.x;
+    m_components[EY][id] = e.y;
+    m_components[EZ][id] = e.z;
+}
+
+/****************************************************************************/
+
+glm::mat4 TransformStore::getLocalTransformation(const TransformId id) const
+{
+    const glm::vec3 scale = getScale(id);
+    glm::mat4 result = glm::mat4_cast(getOrientation(id));
+    result[0] *= scale.x;
+    result[1] *= scale.y;
+    result[2] *= scale.z;
+    result[3] = glm::vec4(getPosition(id), 1.f);
+    return result;
+}
+
+/****************************************************************************/
+
+const glm::mat4& TransformStore::getWorld(const TransformId id) const
+{
+    assert(id < m_size);
+    return m_world[id];
+}
+
+/****************************************************************************/
+
+const AABB& TransformStore::getWorldBounds(const TransformId id) const
+{
+    assert(id < m_size);
+    return m_bounds[id];
+}
+
+/****************************************************************************/
+
+void TransformStore::compose(const TransformId* const ids, const std::size_t count,
+        const glm::mat4* const* const parents)
+{
+    if (count == 0)
+        return;
+    composeBlocks(m_components, Gathered{ids, parents, count}, (count + 3) / 4,
+            m_world.data(), m_bounds.data());
+}
+
+/****************************************************************************/
+
+void TransformStore::composeAll()
+{
+    composeBlocks(m_components, Consecutive{}, (m_size + 3) / 4,
+            m_world.data(), m_bounds.data());
+}
+
+/****************************************************************************/
+
+std::size_t TransformStore::size() const
+{
+    return m_size;
+}
+
+/****************************************************************************/
+
+} // namespace core
@@ -0,0 +1,75 @@
+#ifndef CORE_TRANSFORM_STORE_H
+#define CORE_TRANSFORM_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "aabb.h"
+
+namespace core
+{
+
+using TransformId = std::uint32_t;
+
+/*
+ * Position, orientation and scale of the instances, one array per
+ * component, plus the world matrices and bounds computed from them.
+ * compose() does four transformations per SSE iteration: it builds the
+ * TRS matrices, multiplies them with the parents' world matrices and
+ * transforms the center and half extent of the mesh's bounds (Arvo). The
+ * arrays are padded to a multiple of four. Removed ids are reused by add().
+ */
+class TransformStore
+{
+public:
+    TransformStore();
+    ~TransformStore();
+
+    TransformId add();
+    void remove(TransformId id);
+
+    void setPosition(TransformId id, const glm::vec3& pos);
+    glm::vec3 getPosition(TransformId id) const;
+
+    void setOrientation(TransformId id, const glm::quat& orientation);
+    glm::quat getOrientation(TransformId id) const;
+
+    void setScale(TransformId id, const glm::vec3& scale);
+    glm::vec3 getScale(TransformId id) const;
+
+    // object space, usually the mesh's
+    void setBounds(TransformId id, const AABB& bbox);
+
+    glm::mat4 getLocalTransformation(TransformId id) const;
+
+    // valid after compose()
+    const glm::mat4& getWorld(TransformId id) const;
+    const AABB& getWorldBounds(TransformId id) const;
+
+    // 'parents' has one world matrix per id (nullptr: none), e.g. the scene
+    // graph's, the result is parent * local
+    void compose(const TransformId* ids, std::size_t count,
+            const glm::mat4* const* parents = nullptr);
+    // without parents, including the removed ids
+    void composeAll();
+
+    // including the removed ids
+    std::size_t size() const;
+
+private:
+    // see transform_store.cpp
+    static constexpr unsigned int NUM_COMPONENTS = 16;
+
+    std::size_t              m_size;
+    std::vector<float>       m_components[NUM_COMPONENTS];
+    std::vector<glm::mat4>   m_world;
+    std::vector<AABB>        m_bounds;
+    std::vector<TransformId> m_free;     // removed ids
+};
+
+} // namespace core
+
+#endif // CORE_TRANSFORM_STORE_H
@@ -8,6 +8,7 @@
 #include "framework/vars.h"
 
 #include "core/instance_manager.h"
+#include "core/mesh_manager.h"
 #include "core/camera_manager.h"
 #include "core/shader_manager.h"
 #include "core/light_manager.h"
@@ -37,6 +38,8 @@ GraPro::GraPro(GLFWwindow* window)
     m_diffuseConeSteps{2},
     m_specularConeSteps{4},
     m_debugOutput{false},
+    m_loader{new core::SceneLoader(vars.scene_files)},
+    m_num_drawn{0},
     m_cam{core::res::cameras->getDefaultCam()},
     m_renderer{new RendererImplBM(m_timers, m_treeLevels)}
 {
@@ -56,15 +59,60 @@ GraPro::GraPro(GLFWwindow* window)
     m_options.specularConeSteps = m_specularConeSteps;
     m_options.debugOutput = m_debugOutput;
 
-    const auto* instances = core::res::instances;
-    m_renderer->setGeometry(instances->getInstances());
-
     glm::dvec3 up {0.0, 1.0, 0.0};
     m_cam->setFixedYawAxis(true, up);
 
     m_renderTimer = m_timers.addGPUTimer("Render");
 
-    // fix lights
+    // without a budget, everything is there before the first frame
+    if (vars.scene_upload_budget_ms <= 0.0)
+        m_loader->finish();
+    update_stuff(.0);
+
+    // done. print gpu mem usage
+    gl::printInfo();
+}
+
+/****************************************************************************/
+
+// Uploads the next part of the scene files. The geometry shows up as it
+// arrives, appended to the draw list; sorting it, the scene's bounding box
+// and voxelization wait until everything is there.
+void GraPro::update_stuff(const double /* delta_t */)
+{
+    if (!m_loader)
+        return;
+
+    const bool added_instances = m_loader->update(vars.scene_upload_budget_ms);
+    const auto* instances = core::res::instances;
+    if (m_loader->done()) {
+        m_renderer->setGeometry(instances->getInstances());
+    } else if (added_instances) {
+        m_renderer->addGeometry(instances->getInstancesSince(m_num_drawn));
+        m_num_drawn = instances->getNumInstances();
+    }
+
+    // the scene's camera replaces the placeholder
+    if (m_cam != core::res::cameras->getDefaultCam()) {
+        m_cam = core::res::cameras->getDefaultCam();
+        glm::dvec3 up {0.0, 1.0, 0.0};
+        m_cam->setFixedYawAxis(true, up);
+        resize(getWidth(), getHeight());
+    }
+
+    if (m_loader->done()) {
+        if (!m_loader->succeeded())
+            LOG_ERROR("Failed to load all scene files");
+        m_loader.reset();
+        adjustLights();
+        m_renderer->markTreeInvalid();
+    }
+}
+
+/****************************************************************************/
+
+void GraPro::adjustLights()
+{
     const auto& bbox = m_renderer.get()->getSceneBBox();
     const auto maxExtend = bbox.maxExtend();
     const auto maxDist = bbox.pmax[maxExtend] - bbox.pmin[maxExtend];
@@ -81,8 +129,6 @@ GraPro::GraPro(GLFWwindow* window)
         auto* dlight = static_cast<core::DirectionalLight*>(light.get());
         dlight->setSize(maxDist);
     }
-    // done. print gpu mem usage
-    gl::printInfo();
 }
 
 /****************************************************************************/
@@ -138,6 +184,16 @@ void GraPro::update_gui(const double delta_t)
             ImGui::Checkbox("render Indirect Specular", &m_renderIndirectSpecular);
         }
 
+        // vertex buffer
+        if (ImGui::CollapsingHeader("Geometry", nullptr, true, false)) {
+            const auto& pager = core::res::meshes->getPager();
+            const auto& pages = pager.getAllocator();
+            ImGui::Text("pages: %zu / %zu free", pages.getFreeSize(), pages.getSize());
+            ImGui::Text("largest free run: %zu", pages.getLargestFreeBlock());
+            ImGui::Text("high water mark: %zu", pages.getHighWaterMark());
+            ImGui::Text("fragmentation: %.1f%%", 100.f * pages.getFragmentation());
+        }
+
         // Timers: Just create your timer via m_timers and they will
         // appear here
         if (ImGui::CollapsingHeader("Time", nullptr, true, true)) {
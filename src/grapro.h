@@ -6,6 +6,7 @@
 #include "framework/mainwindow.h"
 
 #include "core/timer_array.h"
+#include "core/loader.h"
 
 #include "rendererinterface.h"
 
@@ -23,9 +24,11 @@ public:
     virtual void handle_keyboard(double delta_t) override;
     virtual void handle_mouse(double delta_t) override;
     virtual void update_gui(double delta_t) override;
+    virtual void update_stuff(double delta_t) override;
     virtual void resize(int width, int height) override;
 
 private:
+    void adjustLights();
 
     // GUI
     bool                                m_showgui;
@@ -52,6 +55,8 @@ private:
     Options                             m_options;
 
     // other
+    std::unique_ptr<core::SceneLoader>  m_loader;
+    std::size_t                         m_num_drawn;    // instances, while loading
     core::Camera*                       m_cam;
     core::TimerArray                    m_timers;
     core::GPUTimer*                     m_renderTimer;
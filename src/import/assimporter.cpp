@@ -26,16 +26,17 @@ namespace
 
 using namespace import;
 
-int cam_counter = 0;
-int light_counter = 0;
-int material_counter = 0;
-int mesh_counter = 0;
-int node_counter = 0;
-std::string DEFAULT_CAM_NAME = "unkown_camera";
-std::string DEFAULT_LIGHT_NAME = "unkown_light";
-std::string DEFAULT_MATERIAL_NAME = "unknown_material";
-std::string DEFAULT_MESH_NAME = "unkown_mesh";
-std::string DEFAULT_NODE_NAME = "unkown_node";
+// scene files may be imported concurrently (see core::SceneLoader)
+thread_local int cam_counter = 0;
+thread_local int light_counter = 0;
+thread_local int material_counter = 0;
+thread_local int mesh_counter = 0;
+thread_local int node_counter = 0;
+thread_local std::string DEFAULT_CAM_NAME = "unkown_camera";
+thread_local std::string DEFAULT_LIGHT_NAME = "unkown_light";
+thread_local std::string DEFAULT_MATERIAL_NAME = "unknown_material";
+thread_local std::string DEFAULT_MESH_NAME = "unkown_mesh";
+thread_local std::string DEFAULT_NODE_NAME = "unkown_node";
 
 struct AssimpMaterial
 {
@@ -71,12 +72,13 @@ struct AssimpMaterial
 
 struct AssimpNode
 {
-    AssimpNode(const aiNode* node, unsigned int index)
-      : ptr{node}, idx{index}
+    AssimpNode(const glm::mat4& local, std::uint32_t index, std::uint32_t parent_index)
+      : transformation{local}, idx{index}, parent{parent_index}
     {
     }
-    const aiNode* ptr;
-    unsigned int  idx;
+    glm::mat4     transformation;
+    std::uint32_t idx;
+    std::uint32_t parent;
 };
 
 struct AssimpMesh
@@ -115,6 +117,8 @@ std::string getName(const aiMaterial* mat);
 std::string getName(const aiMesh* mesh);
 std::string getName(const aiNode* node);
 const aiNode* findNode(const aiNode* root, const aiString& name);
+bool hasMeshes(const aiNode* node);
+glm::mat4 worldTransformation(const aiNode* node);
 
 char* dumpCamera(char* ptr, const std::pair<std::string, const aiCamera*>& cam);
 char* dumpMaterial(char* ptr, const std::pair<std::string, AssimpMaterial>& mat);
@@ -130,7 +134,7 @@ char* dumpNode(char* ptr, const std::pair<std::string, AssimpNode>& node);
 namespace import
 {
 
-std::unique_ptr<Scene> assimport(const std::string& filename)
+ScenePtr assimport(const std::string& filename)
 {
     Assimp::Importer importer;
 
@@ -149,7 +153,13 @@ std::unique_ptr<Scene> assimport(const std::string& filename)
         LOG_ERROR(importer.GetErrorString());
         return nullptr;
     }
-    // adjust default names
+    // adjust default names; they are unique per file, so the counters
+    // can start over and names don't depend on the import order
+    cam_counter = 0;
+    light_counter = 0;
+    material_counter = 0;
+    mesh_counter = 0;
+    node_counter = 0;
     DEFAULT_CAM_NAME = filename + "_unkown_camera";
     DEFAULT_LIGHT_NAME = filename + "_unkown_light";
     DEFAULT_MATERIAL_NAME = filename + "_unknown_material";
@@ -186,6 +196,7 @@ std::unique_ptr<Scene> assimport(const std::string& filename)
     my_scene->num_lights = static_cast<std::uint32_t>(lights.size());
     my_scene->num_cameras = static_cast<std::uint32_t>(cameras.size());
     my_scene->num_nodes = static_cast<std::uint32_t>(nodes.size());
+    my_scene->storage = nullptr;
 
     // arrays
     if (my_scene->num_materials > 0) {
@@ -263,7 +274,7 @@ std::unique_ptr<Scene> assimport(const std::string& filename)
 
     assert(data == reinterpret_cast<char*>(my_scene) + scene_size);
 
-    return std::unique_ptr<Scene>(my_scene);
+    return ScenePtr(my_scene);
 }
 
 } // namespace import
@@ -475,23 +486,36 @@ std::size_t getSceneInfo(const std::string& filename, const aiScene* scene,
         meshes.emplace_back(std::move(meshname), mesh_props);
     }
 
-    // nodes
-    aiNode* stack[1024];
-    stack[0] = scene->mRootNode;
-    std::size_t pos = 1;
-    do {
-        const aiNode* node = stack[--pos];
-
-        std::string nodename = getName(node);
-        for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
+    // Nodes, depth-first. The first node of an aiNode carries its
+    // transformation, its other meshes and its children are attached to it.
+    std::vector<std::pair<const aiNode*, std::uint32_t>> stack;
+    stack.emplace_back(scene->mRootNode, Node::NO_PARENT);
+    while (!stack.empty()) {
+        const aiNode* node = stack.back().first;
+        const std::uint32_t parent = stack.back().second;
+        stack.pop_back();
+        if (!hasMeshes(node))
+            continue;
+
+        const std::string nodename = getName(node);
+        const auto index = static_cast<std::uint32_t>(nodes.size());
+        if (node->mNumMeshes == 0) {
+            nodes.emplace_back(nodename, AssimpNode(to_glm(node->mTransformation),
+                        Node::NO_MESH, parent));
+        } else {
+            nodes.emplace_back(nodename + "_0", AssimpNode(to_glm(node->mTransformation),
+                        node->mMeshes[0], parent));
+        }
+        size += sizeof(Node) + nodes.back().first.size() + 1;
+        for (unsigned int i = 1; i < node->mNumMeshes; ++i) {
             nodes.emplace_back(nodename + '_' + std::to_string(i),
-                    AssimpNode(node, node->mMeshes[i]));
+                    AssimpNode(glm::mat4(1.f), node->mMeshes[i], index));
             size += sizeof(Node) + nodes.back().first.size() + 1;
         }
-        for (unsigned int i = 0; i < node->mNumChildren; ++i) {
-            stack[pos++] = node->mChildren[i];
+        for (unsigned int i = node->mNumChildren; i-- > 0;) {
+            stack.emplace_back(node->mChildren[i], index);
         }
-    } while (pos != 0);
+    }
     size += nodes.size() * sizeof(Node*);
 
     return size;
@@ -582,7 +606,7 @@ char* dumpTexture(char* ptr, const std::string& tex)
     Texture* my_tex = reinterpret_cast<Texture*>(ptr);
     ptr += sizeof(Texture);
     my_tex->name = ptr;
-    my_tex->image = nullptr;
+    my_tex->data = nullptr;
     std::strcpy(ptr, tex.c_str());
     ptr += tex.size() + 1;
     return ptr;
@@ -660,6 +684,15 @@ char* dumpMesh(char* ptr, const std::pair<std::string, AssimpMesh>& mesh)
         my_mesh->texcoords = nullptr;
     }
 
+    // added by addDerivedData(), once the triangle order is final
+    my_mesh->meshlets = nullptr;
+    my_mesh->lods = nullptr;
+    my_mesh->lod_indices = nullptr;
+    my_mesh->num_meshlets = 0;
+    my_mesh->num_lods = 0;
+    my_mesh->num_lod_indices = 0;
+    my_mesh->geometry_hash = 0;
+
     my_mesh->material_index = aimesh->mMaterialIndex;
     my_mesh->num_vertices = aimesh->mNumVertices;
     my_mesh->num_indices = 3 * aimesh->mNumFaces;
@@ -682,7 +715,7 @@ char* dumpLight(const aiNode* const root, char* ptr, const std::pair<std::string
                 light.second->mName.C_Str(), '\'');
         trans = glm::mat4(1.f);
     } else {
-        trans = to_glm(node->mTransformation);
+        trans = worldTransformation(node);
     }
 
     my_light->name = ptr;
@@ -725,8 +758,7 @@ char* dumpNode(char* ptr, const std::pair<std::string, AssimpNode>& node)
     std::strcpy(ptr, node.first.c_str());
     ptr += node.first.size() + 1;
 
-    const aiNode* ainode = node.second.ptr;
-    glm::mat4 transformation = to_glm(ainode->mTransformation);
+    const glm::mat4& transformation = node.second.transformation;
 
     my_node->transformation = transformation;
 
@@ -754,6 +786,7 @@ char* dumpNode(char* ptr, const std::pair<std::string, AssimpNode>& node)
     my_node->rotation = glm::quat_cast(rot);
 
     my_node->mesh_index = node.second.idx;
+    my_node->parent_index = node.second.parent;
 
     return ptr;
 }
@@ -854,4 +887,28 @@ const aiNode* findNode(const aiNode* node, const aiString& name)
 
 /***************************************************************************/
 
+bool hasMeshes(const aiNode* node)
+{
+    if (node->mNumMeshes > 0)
+        return true;
+    for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+        if (hasMeshes(node->mChildren[i]))
+            return true;
+    }
+    return false;
+}
+
+/***************************************************************************/
+
+glm::mat4 worldTransformation(const aiNode* node)
+{
+    glm::mat4 result = to_glm(node->mTransformation);
+    for (node = node->mParent; node != nullptr; node = node->mParent) {
+        result = to_glm(node->mTransformation) * result;
+    }
+    return result;
+}
+
+/***************************************************************************/
+
 } // anonmymous namespace
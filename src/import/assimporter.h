@@ -1,17 +1,16 @@
 #ifndef IMPORT_ASSIMPORTER_H
 #define IMPORT_ASSIMPORTER_H
 
-#include <memory>
 #include <string>
 
+#include "scene.h"
+
 namespace import
 {
 
-struct Scene;
-
-constexpr int ASSIMPORTER_VERSION = 3;
+constexpr int ASSIMPORTER_VERSION = 4;
 
-std::unique_ptr<Scene> assimport(const std::string& filename);
+ScenePtr assimport(const std::string& filename);
 
 } // namespace import
 
@@ -0,0 +1,525 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include <emmintrin.h>
+
+#include "block_compression.h"
+
+namespace import
+{
+namespace
+{
+
+/***************************************************************************/
+
+std::size_t blockSize(const BlockFormat format)
+{
+    switch (format) {
+    case BlockFormat::BC1:
+    case BlockFormat::BC4:
+        return 8;
+    case BlockFormat::BC3:
+    case BlockFormat::BC5:
+        return 16;
+    case BlockFormat::None:
+    default:
+        return 0;
+    }
+}
+
+/***************************************************************************/
+
+// copies a 4x4 block of RGBA pixels, edges are clamped
+void fetchBlock(const std::uint8_t* const rgba, const std::uint32_t width,
+        const std::uint32_t height, const std::uint32_t bx, const std::uint32_t by,
+        std::uint8_t* const block)
+{
+    for (std::uint32_t y = 0; y < 4; ++y) {
+        const std::size_t sy = std::min(by * 4 + y, height - 1);
+        for (std::uint32_t x = 0; x < 4; ++x) {
+            const std::size_t sx = std::min(bx * 4 + x, width - 1);
+            std::memcpy(block + (y * 4 + x) * 4, rgba + (sy * width + sx) * 4, 4);
+        }
+    }
+}
+
+/***************************************************************************/
+
+void storeBlock(const std::uint8_t* const block, const std::uint32_t width,
+        const std::uint32_t height, const std::uint32_t bx, const std::uint32_t by,
+        std::uint8_t* const rgba)
+{
+    for (std::uint32_t y = 0; y < 4 && by * 4 + y < height; ++y) {
+        const std::size_t dy = by * 4 + y;
+        for (std::uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x) {
+            const std::size_t dx = bx * 4 + x;
+            std::memcpy(rgba + (dy * width + dx) * 4, block + (y * 4 + x) * 4, 4);
+        }
+    }
+}
+
+/***************************************************************************/
+
+std::uint16_t to565(const float* const c)
+{
+    auto quantize = [] (const float v, const int max) -> std::uint16_t
+    {
+        const int q = static_cast<int>(v * static_cast<float>(max) / 255.f + .5f);
+        return static_cast<std::uint16_t>(std::max(0, std::min(max, q)));
+    };
+    return static_cast<std::uint16_t>((quantize(c[0], 31) << 11) |
+            (quantize(c[1], 63) << 5) | quantize(c[2], 31));
+}
+
+/***************************************************************************/
+
+void from565(const std::uint16_t v, int* const c)
+{
+    const int r = (v >> 11) & 31;
+    const int g = (v >> 5) & 63;
+    const int b = v & 31;
+    c[0] = (r << 3) | (r >> 2);
+    c[1] = (g << 2) | (g >> 4);
+    c[2] = (b << 3) | (b >> 2);
+}
+
+/***************************************************************************/
+
+void colorPalette(const std::uint16_t c0, const std::uint16_t c1, const bool four_colors,
+        int palette[4][3])
+{
+    from565(c0, palette[0]);
+    from565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        if (four_colors) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+}
+
+/***************************************************************************/
+
+// squared RGB distances of the 16 pixels to 'color', 4 pixels per register
+inline void distances(const __m128i* const px, const __m128i color, __m128i* const dist)
+{
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < 4; ++i) {
+        __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(px[i], zero), color);
+        __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(px[i], zero), color);
+        // (rg, ba) partial sums of two pixels each
+        const __m128 lo_sq = _mm_castsi128_ps(_mm_madd_epi16(lo, lo));
+        const __m128 hi_sq = _mm_castsi128_ps(_mm_madd_epi16(hi, hi));
+        dist[i] = _mm_add_epi32(
+                _mm_castps_si128(_mm_shuffle_ps(lo_sq, hi_sq, _MM_SHUFFLE(2, 0, 2, 0))),
+                _mm_castps_si128(_mm_shuffle_ps(lo_sq, hi_sq, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+}
+
+/***************************************************************************/
+
+// nearest palette entry per pixel, returns the summed squared error
+std::uint32_t selectIndices(const __m128i* const px, const int palette[4][3],
+        std::uint32_t& indices)
+{
+    auto color = [] (const int* const c)
+    {
+        const auto r = static_cast<short>(c[0]);
+        const auto g = static_cast<short>(c[1]);
+        const auto b = static_cast<short>(c[2]);
+        return _mm_setr_epi16(r, g, b, 0, r, g, b, 0);
+    };
+
+    __m128i best[4];
+    __m128i best_idx[4];
+    __m128i dist[4];
+    distances(px, color(palette[0]), best);
+    for (int i = 0; i < 4; ++i) {
+        best_idx[i] = _mm_setzero_si128();
+    }
+    for (int k = 1; k < 4; ++k) {
+        distances(px, color(palette[k]), dist);
+        const __m128i idx = _mm_set1_epi32(k);
+        for (int i = 0; i < 4; ++i) {
+            const __m128i closer = _mm_cmplt_epi32(dist[i], best[i]);
+            best[i] = _mm_or_si128(_mm_and_si128(closer, dist[i]),
+                    _mm_andnot_si128(closer, best[i]));
+            best_idx[i] = _mm_or_si128(_mm_and_si128(closer, idx),
+                    _mm_andnot_si128(closer, best_idx[i]));
+        }
+    }
+
+    alignas(16) std::uint32_t errors[16];
+    alignas(16) std::uint32_t idx[16];
+    for (int i = 0; i < 4; ++i) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(errors + 4 * i), best[i]);
+        _mm_store_si128(reinterpret_cast<__m128i*>(idx + 4 * i), best_idx[i]);
+    }
+
+    std::uint32_t error = 0;
+    indices = 0;
+    for (std::uint32_t p = 0; p < 16; ++p) {
+        error += errors[p];
+        indices |= idx[p] << (2 * p);
+    }
+    return error;
+}
+
+/***************************************************************************/
+
+// the pixels with the smallest and largest projection onto the principal axis
+void principalEndpoints(const std::uint8_t* const block, float* const e0, float* const e1)
+{
+    float mean[3] = {0.f, 0.f, 0.f};
+    for (int p = 0; p < 16; ++p) {
+        for (int c = 0; c < 3; ++c) {
+            mean[c] += static_cast<float>(block[p * 4 + c]);
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        mean[c] /= 16.f;
+    }
+
+    float cov[3][3] = {{0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}};
+    for (int p = 0; p < 16; ++p) {
+        float d[3];
+        for (int c = 0; c < 3; ++c) {
+            d[c] = static_cast<float>(block[p * 4 + c]) - mean[c];
+        }
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                cov[i][j] += d[i] * d[j];
+            }
+        }
+    }
+
+    // power iteration, starting with the row of the largest variance
+    int row = 0;
+    for (int i = 1; i < 3; ++i) {
+        if (cov[i][i] > cov[row][row])
+            row = i;
+    }
+    float axis[3] = {cov[row][0], cov[row][1], cov[row][2]};
+    for (int iter = 0; iter < 4; ++iter) {
+        float v[3];
+        for (int i = 0; i < 3; ++i) {
+            v[i] = cov[i][0] * axis[0] + cov[i][1] * axis[1] + cov[i][2] * axis[2];
+        }
+        const float len = std::max(std::fabs(v[0]), std::max(std::fabs(v[1]), std::fabs(v[2])));
+        if (len < 1e-6f)
+            break;
+        for (int i = 0; i < 3; ++i) {
+            axis[i] = v[i] / len;
+        }
+    }
+
+    int min_p = 0;
+    int max_p = 0;
+    float min_d = std::numeric_limits<float>::max();
+    float max_d = -std::numeric_limits<float>::max();
+    for (int p = 0; p < 16; ++p) {
+        float d = 0.f;
+        for (int c = 0; c < 3; ++c) {
+            d += static_cast<float>(block[p * 4 + c]) * axis[c];
+        }
+        if (d < min_d) {
+            min_d = d;
+            min_p = p;
+        }
+        if (d > max_d) {
+            max_d = d;
+            max_p = p;
+        }
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        e0[c] = static_cast<float>(block[max_p * 4 + c]);
+        e1[c] = static_cast<float>(block[min_p * 4 + c]);
+    }
+}
+
+/***************************************************************************/
+
+// least squares fit of the endpoints to the given indices
+bool fitEndpoints(const std::uint8_t* const block, const std::uint32_t indices,
+        float* const e0, float* const e1)
+{
+    static const float weights[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+
+    float aa = 0.f;
+    float bb = 0.f;
+    float ab = 0.f;
+    float ax[3] = {0.f, 0.f, 0.f};
+    float bx[3] = {0.f, 0.f, 0.f};
+    for (std::uint32_t p = 0; p < 16; ++p) {
+        const float b = weights[(indices >> (2 * p)) & 3];
+        const float a = 1.f - b;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (int c = 0; c < 3; ++c) {
+            const auto x = static_cast<float>(block[p * 4 + c]);
+            ax[c] += a * x;
+            bx[c] += b * x;
+        }
+    }
+
+    const float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f)
+        return false;
+
+    for (int c = 0; c < 3; ++c) {
+        e0[c] = std::max(0.f, std::min(255.f, (ax[c] * bb - bx[c] * ab) / det));
+        e1[c] = std::max(0.f, std::min(255.f, (bx[c] * aa - ax[c] * ab) / det));
+    }
+    return true;
+}
+
+/***************************************************************************/
+
+// always uses the four color mode, BC1 blocks therefore don't need alpha
+void encodeColorBlock(const std::uint8_t* const block, const int refinement,
+        std::uint8_t* const out)
+{
+    const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+    __m128i px[4];
+    for (int i = 0; i < 4; ++i) {
+        px[i] = _mm_and_si128(rgb_mask,
+                _mm_load_si128(reinterpret_cast<const __m128i*>(block + 16 * i)));
+    }
+
+    float e0[3];
+    float e1[3];
+    principalEndpoints(block, e0, e1);
+
+    std::uint16_t best_c0 = 0;
+    std::uint16_t best_c1 = 0;
+    std::uint32_t best_indices = 0;
+    std::uint32_t best_error = std::numeric_limits<std::uint32_t>::max();
+    for (int pass = 0; ; ++pass) {
+        std::uint16_t c0 = to565(e0);
+        std::uint16_t c1 = to565(e1);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        int palette[4][3];
+        colorPalette(c0, c1, true, palette);
+        std::uint32_t indices;
+        const std::uint32_t error = selectIndices(px, palette, indices);
+        if (c0 == c1)
+            indices = 0;
+
+        if (error >= best_error)
+            break;
+        best_c0 = c0;
+        best_c1 = c1;
+        best_indices = indices;
+        best_error = error;
+
+        if (pass == refinement || error == 0 || c0 == c1)
+            break;
+        // the indices refer to the swapped endpoints
+        float q0[3];
+        float q1[3];
+        if (!fitEndpoints(block, indices, q0, q1))
+            break;
+        std::copy(q0, q0 + 3, e0);
+        std::copy(q1, q1 + 3, e1);
+    }
+
+    out[0] = static_cast<std::uint8_t>(best_c0 & 0xFF);
+    out[1] = static_cast<std::uint8_t>(best_c0 >> 8);
+    out[2] = static_cast<std::uint8_t>(best_c1 & 0xFF);
+    out[3] = static_cast<std::uint8_t>(best_c1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<std::uint8_t>((best_indices >> (8 * i)) & 0xFF);
+    }
+}
+
+/***************************************************************************/
+
+void decodeColorBlock(const std::uint8_t* const in, const bool always_four_colors,
+        std::uint8_t* const block)
+{
+    const auto c0 = static_cast<std::uint16_t>(in[0] | (in[1] << 8));
+    const auto c1 = static_cast<std::uint16_t>(in[2] | (in[3] << 8));
+    int palette[4][3];
+    colorPalette(c0, c1, always_four_colors || c0 > c1, palette);
+
+    for (int p = 0; p < 16; ++p) {
+        const int idx = (in[4 + p / 4] >> (2 * (p % 4))) & 3;
+        for (int c = 0; c < 3; ++c) {
+            block[p * 4 + c] = static_cast<std::uint8_t>(palette[idx][c]);
+        }
+    }
+}
+
+/***************************************************************************/
+
+// BC4 block of one channel, always uses the eight value mode
+void encodeAlphaBlock(const std::uint8_t* const block, const int channel,
+        std::uint8_t* const out)
+{
+    int a0 = 0;
+    int a1 = 255;
+    for (int p = 0; p < 16; ++p) {
+        a0 = std::max(a0, static_cast<int>(block[p * 4 + channel]));
+        a1 = std::min(a1, static_cast<int>(block[p * 4 + channel]));
+    }
+
+    std::uint64_t bits = 0;
+    if (a0 > a1) {
+        // the palette is evenly spaced, nearest entry by projection
+        const int range = a0 - a1;
+        for (int p = 0; p < 16; ++p) {
+            const int t = ((a0 - block[p * 4 + channel]) * 7 + range / 2) / range;
+            const std::uint64_t idx = static_cast<std::uint64_t>(t == 0 ? 0 : (t == 7 ? 1 : t + 1));
+            bits |= idx << (3 * p);
+        }
+    }
+
+    out[0] = static_cast<std::uint8_t>(a0);
+    out[1] = static_cast<std::uint8_t>(a1);
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<std::uint8_t>((bits >> (8 * i)) & 0xFF);
+    }
+}
+
+/***************************************************************************/
+
+void decodeAlphaBlock(const std::uint8_t* const in, const int channel,
+        std::uint8_t* const block)
+{
+    const int a0 = in[0];
+    const int a1 = in[1];
+    int palette[8] = {a0, a1, 0, 0, 0, 0, 0, 255};
+    if (a0 > a1) {
+        for (int k = 1; k < 7; ++k) {
+            palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+        }
+    } else {
+        for (int k = 1; k < 5; ++k) {
+            palette[k + 1] = ((5 - k) * a0 + k * a1) / 5;
+        }
+    }
+
+    std::uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) {
+        bits |= static_cast<std::uint64_t>(in[2 + i]) << (8 * i);
+    }
+    for (int p = 0; p < 16; ++p) {
+        block[p * 4 + channel] = static_cast<std::uint8_t>(palette[(bits >> (3 * p)) & 7]);
+    }
+}
+
+/***************************************************************************/
+
+} // anonymous namespace
+
+/***************************************************************************/
+
+GLenum glInternalFormat(const BlockFormat format)
+{
+    switch (format) {
+    case BlockFormat::BC1:
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3:
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BlockFormat::BC4:
+        return GL_COMPRESSED_RED_RGTC1;
+    case BlockFormat::BC5:
+        return GL_COMPRESSED_RG_RGTC2;
+    case BlockFormat::None:
+    default:
+        return GL_NONE;
+    }
+}
+
+/***************************************************************************/
+
+std::size_t compressedSize(const BlockFormat format, const std::uint32_t width,
+        const std::uint32_t height)
+{
+    return blockSize(format) * ((width + 3) / 4) * ((height + 3) / 4);
+}
+
+/***************************************************************************/
+
+void compressImage(const BlockFormat format, const std::uint8_t* const rgba,
+        const std::uint32_t width, const std::uint32_t height, const int refinement,
+        std::uint8_t* dst)
+{
+    alignas(16) std::uint8_t block[64];
+    for (std::uint32_t by = 0; by < (height + 3) / 4; ++by) {
+        for (std::uint32_t bx = 0; bx < (width + 3) / 4; ++bx) {
+            fetchBlock(rgba, width, height, bx, by, block);
+            switch (format) {
+            case BlockFormat::BC1:
+                encodeColorBlock(block, refinement, dst);
+                break;
+            case BlockFormat::BC3:
+                encodeAlphaBlock(block, 3, dst);
+                encodeColorBlock(block, refinement, dst + 8);
+                break;
+            case BlockFormat::BC4:
+                encodeAlphaBlock(block, 0, dst);
+                break;
+            case BlockFormat::BC5:
+                encodeAlphaBlock(block, 0, dst);
+                encodeAlphaBlock(block, 1, dst + 8);
+                break;
+            case BlockFormat::None:
+            default:
+                return;
+            }
+            dst += blockSize(format);
+        }
+    }
+}
+
+/***************************************************************************/
+
+void decompressImage(const BlockFormat format, const std::uint8_t* src,
+        const std::uint32_t width, const std::uint32_t height, std::uint8_t* const rgba)
+{
+    alignas(16) std::uint8_t block[64];
+    for (std::uint32_t by = 0; by < (height + 3) / 4; ++by) {
+        for (std::uint32_t bx = 0; bx < (width + 3) / 4; ++bx) {
+            for (int p = 0; p < 16; ++p) {
+                block[p * 4 + 0] = block[p * 4 + 1] = block[p * 4 + 2] = 0;
+                block[p * 4 + 3] = 255;
+            }
+            switch (format) {
+            case BlockFormat::BC1:
+                decodeColorBlock(src, false, block);
+                break;
+            case BlockFormat::BC3:
+                decodeAlphaBlock(src, 3, block);
+                decodeColorBlock(src + 8, true, block);
+                break;
+            case BlockFormat::BC4:
+                decodeAlphaBlock(src, 0, block);
+                break;
+            case BlockFormat::BC5:
+                decodeAlphaBlock(src, 0, block);
+                decodeAlphaBlock(src + 8, 1, block);
+                break;
+            case BlockFormat::None:
+            default:
+                return;
+            }
+            storeBlock(block, width, height, bx, by, rgba);
+            src += blockSize(format);
+        }
+    }
+}
+
+/***************************************************************************/
+
+} // namespace import
@@ -0,0 +1,37 @@
+#ifndef IMPORT_BLOCK_COMPRESSION_H
+#define IMPORT_BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gl/gl_sys.h"
+
+namespace import
+{
+
+enum class BlockFormat : std::uint32_t
+{
+    None,
+    BC1,    // RGB
+    BC3,    // RGBA
+    BC4,    // R
+    BC5     // RG, tangent space normals
+};
+
+GLenum glInternalFormat(BlockFormat format);
+
+std::size_t compressedSize(BlockFormat format, std::uint32_t width, std::uint32_t height);
+
+// 'rgba' is a tightly packed RGBA8 image. Every refinement pass fits the
+// color endpoints to the chosen indices (least squares), 0 keeps the
+// principal axis extremes.
+void compressImage(BlockFormat format, const std::uint8_t* rgba, std::uint32_t width,
+        std::uint32_t height, int refinement, std::uint8_t* dst);
+
+// writes a tightly packed RGBA8 image, missing channels are 0 (alpha: 255)
+void decompressImage(BlockFormat format, const std::uint8_t* src, std::uint32_t width,
+        std::uint32_t height, std::uint8_t* rgba);
+
+} // namespace import
+
+#endif // IMPORT_BLOCK_COMPRESSION_H
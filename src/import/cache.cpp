@@ -0,0 +1,963 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "log/log.h"
+#include "framework/vars.h"
+#include "util/hash.h"
+#include "util/mapped_file.h"
+#include "util/lz.h"
+#include "util/thread_pool.h"
+#include "cache.h"
+#include "import.h"
+#include "assimporter.h"
+#include "glb_importer.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+
+#include <boost/filesystem.hpp>
+using namespace boost::filesystem;
+
+/***************************************************************************/
+
+namespace import
+{
+namespace
+{
+
+/***************************************************************************/
+
+constexpr int CACHE_FORMAT_VERSION = 4;
+
+constexpr int TEXTURE_VERSION = TextureData::VERSION + CACHE_FORMAT_VERSION;
+
+constexpr int VERSION = Scene::VERSION + Light::VERSION + Material::VERSION +
+        Mesh::VERSION + Node::VERSION + Texture::VERSION + Camera::VERSION +
+        ASSIMPORTER_VERSION + GLB_IMPORTER_VERSION + MESH_OPTIMIZER_VERSION + MESH_SIMPLIFIER_VERSION +
+        CACHE_FORMAT_VERSION;
+
+/***************************************************************************/
+
+struct FileHeader
+{
+    char            header[4];
+    int             version;
+    std::uint32_t   num_sections;
+    std::uint32_t   data_offset;
+    std::uint64_t   source_hash;
+    std::uint64_t   source_stamp;
+};
+
+/***************************************************************************/
+
+constexpr char HEADER_STRING[5] = "aibf";
+
+/***************************************************************************/
+
+struct CompressedFileHeader
+{
+    char            header[4];
+    int             version;
+    std::uint64_t   scene_size;
+    std::uint32_t   chunk_size;
+    std::uint32_t   num_chunks;
+    std::uint64_t   source_hash;
+    std::uint64_t   source_stamp;
+};
+
+/***************************************************************************/
+
+struct Chunk
+{
+    std::uint64_t   offset; // in the file
+    std::uint64_t   size;   // stored as is, if it equals the uncompressed size
+};
+
+/***************************************************************************/
+
+constexpr char COMPRESSED_HEADER_STRING[5] = "aicf";
+
+// small enough for the decoding buffer to stay in the L2 cache
+constexpr std::size_t CHUNK_SIZE = 256 * 1024;
+
+/***************************************************************************/
+
+struct TextureHeader
+{
+    char            header[4];
+    int             version;
+    std::uint32_t   internal_format;
+    std::uint32_t   format;
+    std::uint32_t   type;
+    std::uint32_t   num_channels;
+    std::uint32_t   num_levels;
+    BlockFormat     compression;
+    std::uint64_t   source_hash;
+    std::uint64_t   source_stamp;
+};
+
+/***************************************************************************/
+
+constexpr char TEXTURE_HEADER_STRING[5] = "atbf";
+
+/***************************************************************************/
+
+class MappedSceneStorage
+  : public SceneStorage
+{
+public:
+    MappedSceneStorage(util::MappedFile&& file, std::vector<Section>&& meshes,
+            const std::size_t data_offset)
+      : m_file{std::move(file)},
+        m_meshes{std::move(meshes)},
+        m_data_offset{data_offset}
+    {
+    }
+
+    virtual bool loadMesh(std::uint32_t) override
+    {
+        // page faults take care of it
+        return true;
+    }
+
+    virtual void prefetchMesh(const std::uint32_t idx) override
+    {
+        const auto& section = m_meshes[idx];
+        m_file.advise(m_data_offset + section.offset, section.size,
+                util::MappedFile::Advice::WillNeed);
+    }
+
+private:
+    util::MappedFile        m_file;
+    std::vector<Section>    m_meshes;
+    std::size_t             m_data_offset;
+};
+
+/***************************************************************************/
+
+class ReadSceneStorage
+  : public SceneStorage
+{
+public:
+    ReadSceneStorage(std::unique_ptr<char[]>&& data, std::ifstream&& is,
+            std::vector<Section>&& meshes, const std::size_t data_offset)
+      : m_data{std::move(data)},
+        m_stream{std::move(is)},
+        m_meshes{std::move(meshes)},
+        m_resident(m_meshes.size(), false),
+        m_data_offset{data_offset}
+    {
+    }
+
+    virtual bool loadMesh(const std::uint32_t idx) override
+    {
+        if (m_resident[idx])
+            return true;
+
+        const auto& section = m_meshes[idx];
+        m_stream.seekg(static_cast<long>(m_data_offset + section.offset));
+        m_stream.read(m_data.get() + section.offset, static_cast<long>(section.size));
+        if (!m_stream) {
+            LOG_ERROR(logtag::Import, "Failed to read mesh ", idx, " from cache");
+            m_stream.clear();
+            return false;
+        }
+        m_resident[idx] = true;
+        return true;
+    }
+
+private:
+    std::unique_ptr<char[]> m_data;
+    std::ifstream           m_stream;
+    std::vector<Section>    m_meshes;
+    std::vector<bool>       m_resident;
+    std::size_t             m_data_offset;
+};
+
+/***************************************************************************/
+
+// util::hashFile() or util::hashFileStamp()
+using FileHasher = bool (*)(const std::string&, util::Hasher&);
+
+/***************************************************************************/
+
+// The caches are keyed on the contents of their sources instead of the
+// modification times, so they stay valid across copies and fresh checkouts.
+// With util::hashFileStamp() as 'hash_file', the result is the cheap stamp
+// that SourceKey checks first.
+std::uint64_t sceneSourceHash(const std::string& scenefile,
+        const FileHasher hash_file = util::hashFile)
+{
+    util::Hasher hasher;
+    hasher.update(VERSION);
+    if (!hash_file(scenefile, hasher))
+        return 0;
+    // special case for wavefront obj's
+    if (path(scenefile).extension() == ".obj") {
+        const std::string mtl_file = scenefile.substr(0, scenefile.size() - 3) + "mtl";
+        hasher.update(exists(mtl_file) && hash_file(mtl_file, hasher));
+    }
+    // settings that change the imported scene
+    hasher.update(vars.mesh_optimization);
+    hasher.update(vars.mesh_lods);
+    hasher.update(vars.glb_importer && isGlbFile(scenefile));
+    return hasher.digest();
+}
+
+/***************************************************************************/
+
+std::uint64_t textureSourceHash(const std::string& texfile,
+        const FileHasher hash_file = util::hashFile)
+{
+    util::Hasher hasher;
+    hasher.update(TEXTURE_VERSION);
+    if (!hash_file(texfile, hasher))
+        return 0;
+    return hasher.digest();
+}
+
+/***************************************************************************/
+
+// Checks a cache's source hash only if its stamp (sizes and modification
+// times of the sources) is outdated, reading multi-GB scenes on every load
+// would defeat the cache.
+class SourceKey
+{
+public:
+    using HashFunction = std::uint64_t (*)(const std::string&, FileHasher);
+
+    SourceKey(const std::string& file, const HashFunction hash_function)
+      : m_file(file),
+        m_hash_function{hash_function},
+        m_stamp{hash_function(file, util::hashFileStamp)},
+        m_hash{0},
+        m_hashed{false},
+        m_restamp{false}
+    {
+    }
+
+    bool matches(const std::uint64_t stamp, const std::uint64_t hash)
+    {
+        if (m_stamp != 0 && stamp == m_stamp)
+            return true;
+        if (m_stamp == 0 || getHash() != hash)
+            return false;
+        // e.g. a fresh checkout, see restamp()
+        m_restamp = true;
+        return true;
+    }
+
+    std::uint64_t getHash()
+    {
+        if (!m_hashed) {
+            m_hash = m_hash_function(m_file, util::hashFile);
+            m_hashed = true;
+        }
+        return m_hash;
+    }
+
+    std::uint64_t getStamp() const
+    {
+        return m_stamp;
+    }
+
+    bool needsRestamp() const
+    {
+        return m_restamp;
+    }
+
+private:
+    std::string     m_file;
+    HashFunction    m_hash_function;
+    std::uint64_t   m_stamp;
+    std::uint64_t   m_hash;
+    bool            m_hashed;
+    bool            m_restamp;
+};
+
+/***************************************************************************/
+
+// writes the current stamp into a valid cache file, so the next load
+// doesn't hash the sources again
+void restamp(const path& file, const std::size_t offset, const std::uint64_t stamp)
+{
+    std::fstream fs(file.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    fs.seekp(static_cast<long>(offset));
+    fs.write(reinterpret_cast<const char*>(&stamp), sizeof(stamp));
+}
+
+/***************************************************************************/
+
+// moves a completely written temporary file over the cache file, readers
+// see either the old or the new one
+void replaceCacheFile(const path& tmp_file, const path& file, const bool written)
+{
+    boost::system::error_code ec;
+    if (!written) {
+        remove(tmp_file, ec);
+        return;
+    }
+    rename(tmp_file, file, ec);
+    if (ec) {
+        remove(tmp_file, ec);
+    }
+}
+
+/***************************************************************************/
+
+bool isValidHeader(const FileHeader& header, const std::size_t file_size,
+        SourceKey& source)
+{
+    return std::strncmp(header.header, HEADER_STRING, sizeof(HEADER_STRING) - 1) == 0 &&
+            header.version == VERSION &&
+            header.data_offset == sizeof(FileHeader) + header.num_sections * sizeof(Section) &&
+            header.data_offset + sizeof(Scene) <= file_size &&
+            source.matches(header.source_stamp, header.source_hash);
+}
+
+/***************************************************************************/
+
+// returns the mesh sections indexed by mesh, or false if the table is broken
+bool getMeshSections(const Section* sections, const FileHeader& header,
+        const std::size_t scene_size, std::vector<Section>& meshes)
+{
+    for (std::uint32_t i = 0; i < header.num_sections; ++i) {
+        const auto& section = sections[i];
+        if (section.offset + section.size > scene_size)
+            return false;
+        if (section.type != SectionType::Mesh)
+            continue;
+        if (section.index >= meshes.size())
+            meshes.resize(section.index + 1);
+        meshes[section.index] = section;
+    }
+    return true;
+}
+
+/***************************************************************************/
+
+ScenePtr mapCachedData(const path& file, SourceKey& source)
+{
+    ScenePtr result;
+
+    // private mapping: makePointersAbsolute() only dirties the pages
+    // holding the object headers, the vertex data stays in the page cache
+    util::MappedFile mapping{file.string(), true};
+    if (!mapping || mapping.size() < sizeof(FileHeader)) {
+        return result;
+    }
+
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(mapping.data());
+    if (!isValidHeader(*header, mapping.size(), source)) {
+        mapping = util::MappedFile();
+        std::remove(file.c_str());
+        return result;
+    }
+
+    const std::size_t data_offset = header->data_offset;
+    Scene* scene = reinterpret_cast<Scene*>(mapping.data() + data_offset);
+    if (scene->size != mapping.size() - data_offset) {
+        return result;
+    }
+
+    const Section* sections = reinterpret_cast<const Section*>(mapping.data() +
+            sizeof(FileHeader));
+    std::vector<Section> meshes;
+    if (!getMeshSections(sections, *header, scene->size, meshes)) {
+        return result;
+    }
+
+    scene->storage = new MappedSceneStorage(std::move(mapping), std::move(meshes),
+            data_offset);
+    result.reset(scene);
+
+    return result;
+}
+
+/***************************************************************************/
+
+ScenePtr readCachedData(const path& file, SourceKey& source)
+{
+    ScenePtr result;
+
+    std::ifstream is(file.c_str(), std::ios::in | std::ios::binary);
+    if (!is) {
+        return result;
+    }
+
+    is.seekg(0, std::ios::end);
+    const std::size_t size = static_cast<std::size_t>(is.tellg());
+    is.seekg(0, std::ios::beg);
+
+    if (size < sizeof(FileHeader)) {
+        return result;
+    }
+
+    FileHeader header;
+    is.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+
+    if (!isValidHeader(header, size, source)) {
+        is.close();
+        std::remove(file.c_str());
+        return result;
+    }
+
+    std::vector<Section> sections(header.num_sections);
+    is.read(reinterpret_cast<char*>(sections.data()),
+            static_cast<long>(header.num_sections * sizeof(Section)));
+
+    const std::size_t scene_size = size - header.data_offset;
+    std::vector<Section> meshes;
+    if (!is || !getMeshSections(sections.data(), header, scene_size, meshes)) {
+        return result;
+    }
+
+    // everything except the meshes is read right away
+    std::unique_ptr<char[]> data{new char[scene_size]};
+    for (const auto& section : sections) {
+        if (section.type == SectionType::Mesh)
+            continue;
+        is.seekg(static_cast<long>(header.data_offset + section.offset));
+        is.read(data.get() + section.offset, static_cast<long>(section.size));
+    }
+    if (!is) {
+        return result;
+    }
+
+    Scene* scene = reinterpret_cast<Scene*>(data.get());
+    if (scene->size != scene_size) {
+        return result;
+    }
+
+    scene->storage = new ReadSceneStorage(std::move(data), std::move(is),
+            std::move(meshes), header.data_offset);
+    result.reset(scene);
+
+    return result;
+}
+
+/***************************************************************************/
+
+// Groups the n-th bytes of all 4 byte words. Most of the scene are floats
+// and indices, whose high bytes are much alike.
+void shuffle(const char* const src, const std::size_t size, char* const dst)
+{
+    const std::size_t n = size / 4;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t k = 0; k < 4; ++k) {
+            dst[k * n + i] = src[4 * i + k];
+        }
+    }
+    std::memcpy(dst + 4 * n, src + 4 * n, size - 4 * n);
+}
+
+/***************************************************************************/
+
+void unshuffle(const char* const src, const std::size_t size, char* const dst)
+{
+    const std::size_t n = size / 4;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t k = 0; k < 4; ++k) {
+            dst[4 * i + k] = src[k * n + i];
+        }
+    }
+    std::memcpy(dst + 4 * n, src + 4 * n, size - 4 * n);
+}
+
+/***************************************************************************/
+
+std::vector<char> compressChunk(const char* const src, const std::size_t size)
+{
+    std::vector<char> shuffled(size);
+    shuffle(src, size, shuffled.data());
+    std::vector<char> result(util::lzCompressBound(size));
+    result.resize(util::lzCompress(shuffled.data(), size, result.data()));
+    if (result.size() >= size) {
+        result.assign(src, src + size);
+    }
+    return result;
+}
+
+/***************************************************************************/
+
+bool decompressChunk(const char* const src, const std::size_t src_size, char* const dst,
+        const std::size_t size)
+{
+    if (src_size == size) {
+        std::memcpy(dst, src, size);
+        return true;
+    }
+    std::unique_ptr<char[]> shuffled{new char[size]};
+    if (!util::lzDecompress(src, src_size, shuffled.get(), size))
+        return false;
+    unshuffle(shuffled.get(), size, dst);
+    return true;
+}
+
+/***************************************************************************/
+
+bool isCompressedCache(const path& file)
+{
+    std::ifstream is(file.c_str(), std::ios::in | std::ios::binary);
+    char header[4];
+    return is.read(header, sizeof(header)) && std::strncmp(header, COMPRESSED_HEADER_STRING,
+            sizeof(COMPRESSED_HEADER_STRING) - 1) == 0;
+}
+
+/***************************************************************************/
+
+// Chunks are decoded on the pool as soon as they are read, straight into
+// the scene's memory. The whole scene is resident afterwards.
+ScenePtr readCompressedData(const path& file, SourceKey& source,
+        util::ThreadPool& pool)
+{
+    ScenePtr result;
+
+    std::ifstream is(file.c_str(), std::ios::in | std::ios::binary);
+    if (!is) {
+        return result;
+    }
+
+    is.seekg(0, std::ios::end);
+    const std::size_t size = static_cast<std::size_t>(is.tellg());
+    is.seekg(0, std::ios::beg);
+
+    CompressedFileHeader header;
+    if (size < sizeof(CompressedFileHeader) ||
+            !is.read(reinterpret_cast<char*>(&header), sizeof(CompressedFileHeader)) ||
+            header.version != VERSION ||
+            header.scene_size < sizeof(Scene) ||
+            header.scene_size > std::numeric_limits<std::uint32_t>::max() ||
+            header.chunk_size == 0 ||
+            header.num_chunks != (header.scene_size + header.chunk_size - 1) / header.chunk_size ||
+            size < sizeof(CompressedFileHeader) + header.num_chunks * sizeof(Chunk) ||
+            !source.matches(header.source_stamp, header.source_hash)) {
+        is.close();
+        std::remove(file.c_str());
+        return result;
+    }
+
+    std::vector<Chunk> chunks(header.num_chunks);
+    is.read(reinterpret_cast<char*>(chunks.data()),
+            static_cast<long>(header.num_chunks * sizeof(Chunk)));
+    std::size_t compressed_size = 0;
+    for (std::uint32_t i = 0; i < header.num_chunks; ++i) {
+        const std::size_t chunk_size = std::min<std::size_t>(header.chunk_size,
+                header.scene_size - std::size_t(i) * header.chunk_size);
+        if (chunks[i].offset + chunks[i].size > size || chunks[i].size > chunk_size)
+            return result;
+        compressed_size += chunks[i].size;
+    }
+    if (!is) {
+        return result;
+    }
+
+    std::unique_ptr<char[]> data{new char[header.scene_size]};
+    std::unique_ptr<char[]> compressed{new char[compressed_size]};
+    std::vector<std::future<bool>> decodes;
+    decodes.reserve(header.num_chunks);
+
+    double read_time = 0.0;
+    std::size_t offset = 0;
+    for (std::uint32_t i = 0; i < header.num_chunks; ++i) {
+        const auto read_start = std::chrono::steady_clock::now();
+        char* src = compressed.get() + offset;
+        const std::size_t src_size = chunks[i].size;
+        is.seekg(static_cast<long>(chunks[i].offset));
+        is.read(src, static_cast<long>(src_size));
+        const std::chrono::duration<double, std::milli> time =
+            std::chrono::steady_clock::now() - read_start;
+        read_time += time.count();
+        if (!is)
+            break;
+        offset += src_size;
+
+        char* dst = data.get() + std::size_t(i) * header.chunk_size;
+        const std::size_t dst_size = std::min<std::size_t>(header.chunk_size,
+                header.scene_size - std::size_t(i) * header.chunk_size);
+        decodes.emplace_back(pool.submit([src, src_size, dst, dst_size] () {
+                    return decompressChunk(src, src_size, dst, dst_size);
+                }));
+    }
+
+    // the chunks refer to 'compressed' and 'data', so wait for all of them
+    const auto wait_start = std::chrono::steady_clock::now();
+    bool success = decodes.size() == header.num_chunks;
+    for (auto& decode : decodes) {
+        try {
+            success = decode.get() && success;
+        } catch (const std::exception&) {
+            success = false;
+        }
+    }
+    const std::chrono::duration<double, std::milli> wait_time =
+        std::chrono::steady_clock::now() - wait_start;
+    if (!success) {
+        LOG_ERROR(logtag::Import, "Corrupt compressed cache file: ", file.string());
+        return result;
+    }
+
+    Scene* scene = reinterpret_cast<Scene*>(data.get());
+    if (scene->size != header.scene_size) {
+        return result;
+    }
+
+    LOG_INFO(logtag::Import, "Read ", compressed_size / (1024 * 1024), " MiB of ",
+            header.num_chunks, " chunks in ", read_time, " ms, waited ", wait_time.count(),
+            " ms for decoding on ", pool.size(), " threads");
+
+    scene->storage = nullptr;
+    result.reset(scene);
+    data.release();
+
+    return result;
+}
+
+/***************************************************************************/
+
+// 'scene' must have relative pointers
+bool writeCompressedData(std::ofstream& os, const Scene* const scene,
+        SourceKey& source, util::ThreadPool& pool)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const char* data = reinterpret_cast<const char*>(scene);
+    const std::size_t size = scene->size;
+
+    CompressedFileHeader header;
+    std::memcpy(header.header, COMPRESSED_HEADER_STRING, sizeof(COMPRESSED_HEADER_STRING) - 1);
+    header.version = VERSION;
+    header.source_hash = source.getHash();
+    header.source_stamp = source.getStamp();
+    header.scene_size = size;
+    header.chunk_size = static_cast<std::uint32_t>(CHUNK_SIZE);
+    header.num_chunks = static_cast<std::uint32_t>((size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+    std::vector<std::future<std::vector<char>>> encodes;
+    encodes.reserve(header.num_chunks);
+    for (std::size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+        const char* src = data + offset;
+        const std::size_t src_size = std::min(CHUNK_SIZE, size - offset);
+        encodes.emplace_back(pool.submit([src, src_size] () {
+                    return compressChunk(src, src_size);
+                }));
+    }
+
+    // the chunks refer to the scene, so wait for all of them
+    std::vector<std::vector<char>> compressed(header.num_chunks);
+    bool success = true;
+    for (std::uint32_t i = 0; i < header.num_chunks; ++i) {
+        try {
+            compressed[i] = encodes[i].get();
+        } catch (const std::exception& e) {
+            LOG_ERROR(logtag::Import, "Failed to compress scene cache: ", e.what());
+            success = false;
+        }
+    }
+    if (!success)
+        return false;
+
+    std::vector<Chunk> chunks(header.num_chunks);
+    std::uint64_t offset = sizeof(CompressedFileHeader) + header.num_chunks * sizeof(Chunk);
+    for (std::uint32_t i = 0; i < header.num_chunks; ++i) {
+        chunks[i].offset = offset;
+        chunks[i].size = compressed[i].size();
+        offset += chunks[i].size;
+    }
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(chunks.data()),
+            static_cast<long>(chunks.size() * sizeof(Chunk)));
+    for (const auto& chunk : compressed) {
+        os.write(chunk.data(), static_cast<long>(chunk.size()));
+    }
+
+    const std::chrono::duration<double, std::milli> time =
+        std::chrono::steady_clock::now() - start;
+    const std::uint64_t compressed_size = offset - sizeof(CompressedFileHeader) -
+        header.num_chunks * sizeof(Chunk);
+    LOG_INFO(logtag::Import, "Compressed scene cache from ", size / (1024 * 1024), " MiB to ",
+            compressed_size / (1024 * 1024), " MiB (ratio ",
+            static_cast<double>(size) / static_cast<double>(std::max<std::uint64_t>(compressed_size, 1)),
+            ") in ", time.count(), " ms");
+
+    return static_cast<bool>(os);
+}
+
+/***************************************************************************/
+
+std::vector<Section> getSections(const Scene* scene)
+{
+    const char* base = reinterpret_cast<const char*>(scene);
+    std::vector<Section> sections;
+    sections.reserve(1 + scene->num_materials + scene->num_meshes +
+            scene->num_lights + scene->num_textures + scene->num_cameras +
+            scene->num_nodes);
+
+    auto add = [&] (const SectionType type, const std::uint32_t idx, const void* ptr)
+    {
+        Section section;
+        section.type = type;
+        section.index = idx;
+        section.offset = static_cast<std::uint64_t>(static_cast<const char*>(ptr) - base);
+        section.size = 0;
+        sections.emplace_back(section);
+    };
+
+    add(SectionType::Scene, 0, scene);
+    for (std::uint32_t i = 0; i < scene->num_materials; ++i)
+        add(SectionType::Material, i, scene->materials[i]);
+    for (std::uint32_t i = 0; i < scene->num_meshes; ++i)
+        add(SectionType::Mesh, i, scene->meshes[i]);
+    for (std::uint32_t i = 0; i < scene->num_lights; ++i)
+        add(SectionType::Light, i, scene->lights[i]);
+    for (std::uint32_t i = 0; i < scene->num_textures; ++i)
+        add(SectionType::Texture, i, scene->textures[i]);
+    for (std::uint32_t i = 0; i < scene->num_cameras; ++i)
+        add(SectionType::Camera, i, scene->cameras[i]);
+    for (std::uint32_t i = 0; i < scene->num_nodes; ++i)
+        add(SectionType::Node, i, scene->nodes[i]);
+
+    // every object is followed by its data, so it ends where the next one starts
+    std::sort(sections.begin(), sections.end(),
+            [] (const Section& s0, const Section& s1) -> bool
+            {
+                return s0.offset < s1.offset;
+            });
+    for (std::size_t i = 0; i + 1 < sections.size(); ++i) {
+        sections[i].size = sections[i + 1].offset - sections[i].offset;
+    }
+    sections.back().size = scene->size - sections.back().offset;
+
+    return sections;
+}
+
+/***************************************************************************/
+
+path textureCacheFile(const std::string& texfile)
+{
+    return vars.cache_dir / path(texfile + ".tex");
+}
+
+/***************************************************************************/
+
+} // anonymous namespace
+
+/***************************************************************************/
+
+SceneStorage::~SceneStorage() = default;
+
+/***************************************************************************/
+
+void SceneStorage::prefetchMesh(std::uint32_t)
+{
+}
+
+/***************************************************************************/
+
+ScenePtr loadSceneCache(const std::string& scenefile, util::ThreadPool& pool)
+{
+    path file = vars.cache_dir / path(scenefile);
+    if (!exists(file) || !is_regular_file(file)) {
+        return nullptr;
+    }
+
+    if (vars.scene_cache_drop_pages) {
+        util::dropFromPageCache(file.string());
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // outdated caches are removed by the readers
+    SourceKey source(scenefile, sceneSourceHash);
+    const bool compressed = isCompressedCache(file);
+    ScenePtr result;
+    if (compressed) {
+        result = readCompressedData(file, source, pool);
+    } else {
+        result = vars.scene_cache_mmap ? mapCachedData(file, source) :
+            readCachedData(file, source);
+    }
+    if (result && source.needsRestamp()) {
+        restamp(file, compressed ? offsetof(CompressedFileHeader, source_stamp) :
+                offsetof(FileHeader, source_stamp), source.getStamp());
+    }
+    if (result) {
+        // meshes are resolved by Scene::getMesh()
+        result->makePointersAbsolute();
+
+        const std::chrono::duration<double, std::milli> time =
+            std::chrono::steady_clock::now() - start;
+        LOG_INFO(logtag::Import,
+                (compressed ? "Decompressed" : (vars.scene_cache_mmap ? "Mapped" : "Read")),
+                " cached scene ", scenefile, " (", result->size / (1024 * 1024),
+                " MiB) in ", time.count(), " ms",
+                (vars.scene_cache_drop_pages ? " from a cold page cache" : ""));
+    }
+
+    return result;
+}
+
+/***************************************************************************/
+
+void writeSceneCache(Scene* const scene, const std::string& scenefile, util::ThreadPool& pool)
+{
+    path file = vars.cache_dir / path(scenefile);
+
+    if (exists(file) == false) {
+        create_directories(file.parent_path());
+    } else if (!is_regular_file(file)) {
+        return;
+    }
+
+    // the old file may still be mapped, the rename replaces it atomically
+    const path tmp_file = unique_path(file.string() + "-%%%%%%%%");
+    std::ofstream os(tmp_file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!os) {
+        return;
+    }
+
+    SourceKey source(scenefile, sceneSourceHash);
+
+    if (vars.scene_cache_compression) {
+        scene->makePointersRelative();
+        const bool success = writeCompressedData(os, scene, source, pool);
+        scene->makePointersAbsolute();
+        os.close();
+        replaceCacheFile(tmp_file, file, success && os);
+        return;
+    }
+
+    const std::vector<Section> sections = getSections(scene);
+
+    FileHeader header;
+    std::memcpy(header.header, HEADER_STRING, sizeof(HEADER_STRING) - 1);
+    header.version = VERSION;
+    header.num_sections = static_cast<std::uint32_t>(sections.size());
+    header.data_offset = static_cast<std::uint32_t>(sizeof(FileHeader) +
+            sections.size() * sizeof(Section));
+    header.source_hash = source.getHash();
+    header.source_stamp = source.getStamp();
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(sections.data()),
+            static_cast<long>(sections.size() * sizeof(Section)));
+
+    scene->makePointersRelative();
+    os.write(reinterpret_cast<const char*>(scene), scene->size);
+    scene->makePointersAbsolute();
+
+    os.close();
+    replaceCacheFile(tmp_file, file, static_cast<bool>(os));
+}
+
+/***************************************************************************/
+
+bool loadTextureCache(const std::string& texfile, TextureData& texture)
+{
+    const path file = textureCacheFile(texfile);
+    if (!exists(file) || !is_regular_file(file)) {
+        return false;
+    }
+
+    std::ifstream is(file.c_str(), std::ios::in | std::ios::binary);
+    if (!is) {
+        return false;
+    }
+
+    is.seekg(0, std::ios::end);
+    const std::size_t size = static_cast<std::size_t>(is.tellg());
+    is.seekg(0, std::ios::beg);
+
+    SourceKey source(texfile, textureSourceHash);
+    TextureHeader header;
+    if (size < sizeof(TextureHeader) ||
+            !is.read(reinterpret_cast<char*>(&header), sizeof(TextureHeader)) ||
+            std::strncmp(header.header, TEXTURE_HEADER_STRING,
+                sizeof(TEXTURE_HEADER_STRING) - 1) != 0 ||
+            header.version != TEXTURE_VERSION ||
+            header.num_levels == 0 ||
+            size < sizeof(TextureHeader) + header.num_levels * sizeof(TextureData::Level) ||
+            !source.matches(header.source_stamp, header.source_hash)) {
+        is.close();
+        std::remove(file.c_str());
+        return false;
+    }
+
+    texture.compression = header.compression;
+    texture.internal_format = header.internal_format;
+    texture.format = header.format;
+    texture.type = header.type;
+    texture.num_channels = static_cast<int>(header.num_channels);
+    texture.levels.resize(header.num_levels);
+    is.read(reinterpret_cast<char*>(texture.levels.data()),
+            static_cast<long>(header.num_levels * sizeof(TextureData::Level)));
+
+    const auto& last = texture.levels.back();
+    const std::size_t data_size = static_cast<std::size_t>(last.offset + last.size);
+    if (!is || size != sizeof(TextureHeader) +
+            header.num_levels * sizeof(TextureData::Level) + data_size) {
+        return false;
+    }
+
+    texture.data.resize(data_size);
+    is.read(texture.data.data(), static_cast<long>(data_size));
+    if (!is) {
+        return false;
+    }
+
+    if (source.needsRestamp()) {
+        is.close();
+        restamp(file, offsetof(TextureHeader, source_stamp), source.getStamp());
+    }
+    return true;
+}
+
+/***************************************************************************/
+
+void writeTextureCache(const TextureData& texture, const std::string& texfile)
+{
+    const path file = textureCacheFile(texfile);
+
+    if (exists(file) == false) {
+        create_directories(file.parent_path());
+    } else if (!is_regular_file(file)) {
+        return;
+    }
+
+    // several scenes may share a texture, the rename makes the file appear atomically
+    const path tmp_file = unique_path(file.string() + "-%%%%%%%%");
+    std::ofstream os(tmp_file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!os) {
+        return;
+    }
+
+    TextureHeader header;
+    std::memcpy(header.header, TEXTURE_HEADER_STRING, sizeof(TEXTURE_HEADER_STRING) - 1);
+    header.version = TEXTURE_VERSION;
+    header.internal_format = texture.internal_format;
+    header.format = texture.format;
+    header.type = texture.type;
+    header.num_channels = static_cast<std::uint32_t>(texture.num_channels);
+    header.num_levels = static_cast<std::uint32_t>(texture.levels.size());
+    header.compression = texture.compression;
+    SourceKey source(texfile, textureSourceHash);
+    header.source_hash = source.getHash();
+    header.source_stamp = source.getStamp();
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(texture.levels.data()),
+            static_cast<long>(texture.levels.size() * sizeof(TextureData::Level)));
+    os.write(texture.data.data(), static_cast<long>(texture.data.size()));
+    os.close();
+    replaceCacheFile(tmp_file, file, static_cast<bool>(os));
+}
+
+/***************************************************************************/
+
+} // namespace import
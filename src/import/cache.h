@@ -0,0 +1,91 @@
+#ifndef IMPORT_CACHE_H
+#define IMPORT_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include "scene.h"
+#include "texture_data.h"
+
+namespace util
+{
+class ThreadPool;
+} // namespace util
+
+namespace import
+{
+
+/*
+ * Cache file layout:
+ *
+ *   FileHeader
+ *   Section[num_sections]   table of contents, sorted by offset
+ *   Scene blob              relative pointers, see makePointersRelative()
+ *
+ * Every object of the scene blob has its own section, so single objects
+ * can be brought in without touching the rest of the file.
+ *
+ * Compressed cache file layout (scene_cache_compression):
+ *
+ *   CompressedFileHeader
+ *   Chunk[num_chunks]       offset and compressed size
+ *   chunks                  consecutive parts of the scene blob, byte
+ *                           shuffled and LZ compressed (util/lz.h)
+ *
+ * Compressed scenes are loaded as a whole, the chunks are decoded in
+ * parallel while the file is read.
+ *
+ * The headers of all cache files hold a hash of the sources' contents and
+ * of the settings the result depends on; a mismatch removes the file.
+ */
+
+enum class SectionType : std::uint32_t
+{
+    Scene,
+    Material,
+    Mesh,
+    Light,
+    Texture,
+    Camera,
+    Node
+};
+
+struct Section
+{
+    SectionType     type;
+    std::uint32_t   index;
+    std::uint64_t   offset; // relative to the start of the scene blob
+    std::uint64_t   size;
+};
+
+// Owns the memory of a cached scene and makes its meshes resident on demand.
+class SceneStorage
+{
+public:
+    virtual ~SceneStorage();
+
+    virtual bool loadMesh(std::uint32_t idx) = 0;
+    virtual void prefetchMesh(std::uint32_t idx);
+};
+
+// 'pool' decodes compressed caches
+ScenePtr loadSceneCache(const std::string& scenefile, util::ThreadPool& pool);
+
+// 'scene' must have absolute pointers, they are restored afterwards
+void writeSceneCache(Scene* scene, const std::string& scenefile, util::ThreadPool& pool);
+
+/*
+ * Texture cache file layout:
+ *
+ *   TextureHeader
+ *   TextureData::Level[num_levels]
+ *   texels of all levels
+ */
+
+bool loadTextureCache(const std::string& texfile, TextureData& texture);
+
+void writeTextureCache(const TextureData& texture, const std::string& texfile);
+
+} // namespace import
+
+#endif // IMPORT_CACHE_H
@@ -0,0 +1,1300 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "glb_importer.h"
+#include "scene.h"
+#include "mesh.h"
+#include "material.h"
+#include "light.h"
+#include "node.h"
+#include "camera.h"
+#include "texture.h"
+
+#include "framework/vars.h"
+#include "log/log.h"
+#include "util/mapped_file.h"
+
+using namespace boost::filesystem;
+using boost::property_tree::ptree;
+
+/***************************************************************************/
+
+namespace
+{
+
+using namespace import;
+
+constexpr std::uint32_t GLB_MAGIC = 0x46546C67;    // "glTF"
+constexpr std::uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr std::uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+struct GlbHeader
+{
+    std::uint32_t   magic;
+    std::uint32_t   version;
+    std::uint32_t   length;
+};
+
+struct GlbChunkHeader
+{
+    std::uint32_t   length;
+    std::uint32_t   type;
+};
+
+// accessor component types
+constexpr int GLTF_BYTE = 5120;
+constexpr int GLTF_UNSIGNED_BYTE = 5121;
+constexpr int GLTF_SHORT = 5122;
+constexpr int GLTF_UNSIGNED_SHORT = 5123;
+constexpr int GLTF_UNSIGNED_INT = 5125;
+constexpr int GLTF_FLOAT = 5126;
+
+constexpr int GLTF_TRIANGLES = 4;
+
+/***************************************************************************/
+
+struct Accessor
+{
+    const char*     data;
+    std::size_t     count;
+    std::size_t     stride;
+    int             component_type;
+    int             num_components;
+    bool            normalized;
+
+    float get(std::size_t idx, int component) const;
+    std::uint32_t getIndex(std::size_t idx) const;
+};
+
+/***************************************************************************/
+
+struct GlbMaterial
+{
+    GlbMaterial()
+      : diffuse_tex{-1}, normal_tex{-1}, emissive_tex{-1},
+        base_color{1.f}, emissive_color{0.f},
+        alpha{1.f}, metallic{1.f}, roughness{1.f},
+        blend{false}
+    {
+    }
+
+    std::string name;
+    int         diffuse_tex;
+    int         normal_tex;
+    int         emissive_tex;
+    glm::vec3   base_color;
+    glm::vec3   emissive_color;
+    float       alpha;
+    float       metallic;
+    float       roughness;
+    bool        blend;
+
+    bool needsTexcoords() const noexcept
+    {
+        return diffuse_tex != -1 || normal_tex != -1 || emissive_tex != -1;
+    }
+
+    bool needsTangents() const noexcept
+    {
+        return normal_tex != -1;
+    }
+};
+
+/***************************************************************************/
+
+// one per triangle primitive
+struct GlbMesh
+{
+    std::string     name;
+    const ptree*    primitive;
+    std::uint32_t   material_index;
+    std::uint32_t   num_vertices;
+    std::uint32_t   num_indices;
+    bool            has_texcoords;
+    bool            has_tangents;
+    bool            has_vertex_colors;
+};
+
+/***************************************************************************/
+
+struct GlbObject
+{
+    std::string     name;
+    glm::mat4       transformation; // world space
+    std::size_t     index;          // mesh, camera or light
+};
+
+/***************************************************************************/
+
+struct GlbNode
+{
+    std::string     name;
+    glm::mat4       transformation; // relative to the parent
+    std::uint32_t   mesh_index;     // Node::NO_MESH for groups
+    std::uint32_t   parent_index;
+};
+
+/***************************************************************************/
+
+class GlbReader
+{
+public:
+    explicit GlbReader(const std::string& filename);
+
+    ScenePtr read();
+
+private:
+    void mapBuffers();
+    Accessor getAccessor(std::size_t idx) const;
+    std::string getImageName(std::size_t idx);
+    int getTextureIndex(const ptree& texture_info);
+    void getMaterials();
+    void getMeshes();
+    void getNodes();
+
+    char* dumpMaterial(char* ptr, const GlbMaterial& mat) const;
+    char* dumpTexture(char* ptr, const std::string& tex) const;
+    char* dumpMesh(char* ptr, const GlbMesh& mesh) const;
+    char* dumpNode(char* ptr, const GlbNode& node) const;
+    char* dumpCamera(char* ptr, const GlbObject& cam) const;
+    char* dumpLight(char* ptr, const GlbObject& light) const;
+
+    std::string                         m_filename;
+    path                                m_parent_dir;
+    util::MappedFile                    m_file;
+    std::vector<util::MappedFile>       m_external_buffers;
+    ptree                               m_json;
+    std::vector<std::pair<const char*, std::size_t>> m_buffers;
+
+    // top level arrays of the JSON
+    std::vector<const ptree*>           m_json_accessors;
+    std::vector<const ptree*>           m_json_buffer_views;
+    std::vector<const ptree*>           m_json_images;
+    std::vector<const ptree*>           m_json_textures;
+    std::vector<const ptree*>           m_json_cameras;
+    std::vector<const ptree*>           m_json_lights;
+
+    std::vector<GlbMaterial>            m_materials;
+    std::vector<std::string>            m_textures;
+    std::vector<int>                    m_image_textures;
+    std::vector<GlbMesh>                m_meshes;
+    std::vector<std::vector<std::uint32_t>> m_primitive_meshes;
+    std::vector<GlbNode>                m_nodes;
+    std::vector<GlbObject>              m_cameras;
+    std::vector<GlbObject>              m_lights;
+    int                                 m_default_material;
+};
+
+/***************************************************************************/
+
+const ptree& getChild(const ptree& pt, const char* key)
+{
+    static const ptree empty;
+    const auto child = pt.get_child_optional(key);
+    return child ? *child : empty;
+}
+
+/***************************************************************************/
+
+std::vector<const ptree*> getElements(const ptree& pt, const char* key)
+{
+    std::vector<const ptree*> result;
+    for (const auto& element : getChild(pt, key)) {
+        result.push_back(&element.second);
+    }
+    return result;
+}
+
+/***************************************************************************/
+
+std::vector<float> getFloats(const ptree& pt, const char* key)
+{
+    std::vector<float> result;
+    for (const auto& element : getChild(pt, key)) {
+        result.push_back(element.second.get_value<float>());
+    }
+    return result;
+}
+
+/***************************************************************************/
+
+int componentSize(const int component_type)
+{
+    switch (component_type) {
+    case GLTF_BYTE:
+    case GLTF_UNSIGNED_BYTE:
+        return 1;
+    case GLTF_SHORT:
+    case GLTF_UNSIGNED_SHORT:
+        return 2;
+    case GLTF_UNSIGNED_INT:
+    case GLTF_FLOAT:
+        return 4;
+    default:
+        throw std::runtime_error("unknown component type " + std::to_string(component_type));
+    }
+}
+
+/***************************************************************************/
+
+int numComponents(const std::string& type)
+{
+    if (type == "SCALAR")
+        return 1;
+    if (type == "VEC2")
+        return 2;
+    if (type == "VEC3")
+        return 3;
+    if (type == "VEC4")
+        return 4;
+    if (type == "MAT2")
+        return 4;
+    if (type == "MAT3")
+        return 9;
+    if (type == "MAT4")
+        return 16;
+    throw std::runtime_error("unknown accessor type " + type);
+}
+
+/***************************************************************************/
+
+float Accessor::get(const std::size_t idx, const int component) const
+{
+    const char* ptr = data + idx * stride +
+        static_cast<std::size_t>(component * componentSize(component_type));
+    switch (component_type) {
+    case GLTF_FLOAT:
+    {
+        float v;
+        std::memcpy(&v, ptr, sizeof(v));
+        return v;
+    }
+    case GLTF_UNSIGNED_BYTE:
+    {
+        const float v = static_cast<float>(*reinterpret_cast<const std::uint8_t*>(ptr));
+        return normalized ? v / 255.f : v;
+    }
+    case GLTF_BYTE:
+    {
+        const float v = static_cast<float>(*reinterpret_cast<const std::int8_t*>(ptr));
+        return normalized ? std::max(v / 127.f, -1.f) : v;
+    }
+    case GLTF_UNSIGNED_SHORT:
+    {
+        std::uint16_t v;
+        std::memcpy(&v, ptr, sizeof(v));
+        return normalized ? static_cast<float>(v) / 65535.f : static_cast<float>(v);
+    }
+    case GLTF_SHORT:
+    {
+        std::int16_t v;
+        std::memcpy(&v, ptr, sizeof(v));
+        return normalized ? std::max(static_cast<float>(v) / 32767.f, -1.f) :
+            static_cast<float>(v);
+    }
+    default:
+        throw std::runtime_error("unsupported component type for attributes");
+    }
+}
+
+/***************************************************************************/
+
+std::uint32_t Accessor::getIndex(const std::size_t idx) const
+{
+    const char* ptr = data + idx * stride;
+    switch (component_type) {
+    case GLTF_UNSIGNED_BYTE:
+        return *reinterpret_cast<const std::uint8_t*>(ptr);
+    case GLTF_UNSIGNED_SHORT:
+    {
+        std::uint16_t v;
+        std::memcpy(&v, ptr, sizeof(v));
+        return v;
+    }
+    case GLTF_UNSIGNED_INT:
+    {
+        std::uint32_t v;
+        std::memcpy(&v, ptr, sizeof(v));
+        return v;
+    }
+    default:
+        throw std::runtime_error("unsupported component type for indices");
+    }
+}
+
+/***************************************************************************/
+
+// Tightly packed float data is copied as a whole, anything else is
+// converted element by element.
+template <typename T>
+void copyAccessor(const Accessor& accessor, T* const dst)
+{
+    constexpr int N = static_cast<int>(sizeof(T) / sizeof(float));
+    if (accessor.num_components < N)
+        throw std::runtime_error("accessor has too few components");
+
+    if (accessor.component_type == GLTF_FLOAT && accessor.num_components == N &&
+            accessor.stride == sizeof(T)) {
+        std::memcpy(dst, accessor.data, accessor.count * sizeof(T));
+        return;
+    }
+    for (std::size_t i = 0; i < accessor.count; ++i) {
+        float* v = glm::value_ptr(dst[i]);
+        for (int c = 0; c < N; ++c) {
+            v[c] = accessor.get(i, c);
+        }
+    }
+}
+
+/***************************************************************************/
+
+// area weighted, like aiProcess_GenSmoothNormals without the angle limit
+void computeNormals(Mesh* const mesh)
+{
+    std::fill(mesh->normals, mesh->normals + mesh->num_vertices, glm::vec3(0.f));
+    for (std::uint32_t i = 0; i + 2 < mesh->num_indices; i += 3) {
+        const auto v0 = mesh->indices[i];
+        const auto v1 = mesh->indices[i + 1];
+        const auto v2 = mesh->indices[i + 2];
+        const glm::vec3 n = glm::cross(mesh->vertices[v1] - mesh->vertices[v0],
+                mesh->vertices[v2] - mesh->vertices[v0]);
+        mesh->normals[v0] += n;
+        mesh->normals[v1] += n;
+        mesh->normals[v2] += n;
+    }
+    for (std::uint32_t i = 0; i < mesh->num_vertices; ++i) {
+        const float len = glm::length(mesh->normals[i]);
+        mesh->normals[i] = len > 0.f ? mesh->normals[i] / len : glm::vec3(0.f, 1.f, 0.f);
+    }
+}
+
+/***************************************************************************/
+
+// Lengyel, "Computing Tangent Space Basis Vectors for an Arbitrary Mesh"
+void computeTangents(Mesh* const mesh)
+{
+    std::vector<glm::vec3> bitangents(mesh->num_vertices, glm::vec3(0.f));
+    std::fill(mesh->tangents, mesh->tangents + mesh->num_vertices, glm::vec3(0.f));
+    for (std::uint32_t i = 0; i + 2 < mesh->num_indices; i += 3) {
+        const auto v0 = mesh->indices[i];
+        const auto v1 = mesh->indices[i + 1];
+        const auto v2 = mesh->indices[i + 2];
+        const glm::vec3 e1 = mesh->vertices[v1] - mesh->vertices[v0];
+        const glm::vec3 e2 = mesh->vertices[v2] - mesh->vertices[v0];
+        const glm::vec2 d1 = mesh->texcoords[v1] - mesh->texcoords[v0];
+        const glm::vec2 d2 = mesh->texcoords[v2] - mesh->texcoords[v0];
+        const float det = d1.x * d2.y - d2.x * d1.y;
+        if (det == 0.f)
+            continue;
+        const glm::vec3 t = (e1 * d2.y - e2 * d1.y) / det;
+        const glm::vec3 b = (e2 * d1.x - e1 * d2.x) / det;
+        for (const auto v : {v0, v1, v2}) {
+            mesh->tangents[v] += t;
+            bitangents[v] += b;
+        }
+    }
+    for (std::uint32_t i = 0; i < mesh->num_vertices; ++i) {
+        const glm::vec3& n = mesh->normals[i];
+        glm::vec3 t = mesh->tangents[i] - n * glm::dot(n, mesh->tangents[i]);
+        float len = glm::length(t);
+        if (len == 0.f) {
+            // any direction in the tangent plane
+            t = glm::cross(n, std::abs(n.x) < .9f ? glm::vec3(1.f, 0.f, 0.f) :
+                    glm::vec3(0.f, 1.f, 0.f));
+            len = glm::length(t);
+        }
+        t /= len;
+        const glm::vec3 b = glm::cross(n, t);
+        mesh->tangents[i] = t;
+        mesh->bitangents[i] = glm::dot(b, bitangents[i]) < 0.f ? -b : b;
+    }
+}
+
+/***************************************************************************/
+
+glm::mat4 getLocalTransformation(const ptree& node)
+{
+    const std::vector<float> matrix = getFloats(node, "matrix");
+    if (matrix.size() == 16)
+        return glm::make_mat4(matrix.data());
+
+    glm::mat4 result(1.f);
+    const std::vector<float> t = getFloats(node, "translation");
+    if (t.size() == 3)
+        result = glm::translate(result, glm::vec3(t[0], t[1], t[2]));
+    const std::vector<float> r = getFloats(node, "rotation");
+    if (r.size() == 4)
+        result = result * glm::mat4_cast(glm::quat(r[3], r[0], r[1], r[2]));
+    const std::vector<float> s = getFloats(node, "scale");
+    if (s.size() == 3)
+        result = glm::scale(result, glm::vec3(s[0], s[1], s[2]));
+    return result;
+}
+
+/***************************************************************************/
+
+glm::vec3 transformDirection(const glm::mat4& m, const glm::vec3& dir)
+{
+    return glm::normalize(glm::vec3(m * glm::vec4(dir, 0.f)));
+}
+
+/***************************************************************************/
+
+char* dumpString(char* ptr, const std::string& s)
+{
+    std::strcpy(ptr, s.c_str());
+    return ptr + s.size() + 1;
+}
+
+/***************************************************************************/
+
+GlbReader::GlbReader(const std::string& filename)
+  : m_filename{filename},
+    m_parent_dir{path(filename).parent_path()},
+    m_file{filename},
+    m_default_material{-1}
+{
+    if (!m_file || m_file.size() < sizeof(GlbHeader) + sizeof(GlbChunkHeader))
+        throw std::runtime_error("can't read file");
+
+    GlbHeader header;
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (header.magic != GLB_MAGIC || header.version != 2 || header.length > m_file.size())
+        throw std::runtime_error("not a glTF 2.0 binary");
+
+    // JSON first, then an optional binary chunk
+    std::size_t offset = sizeof(GlbHeader);
+    const char* bin = nullptr;
+    std::size_t bin_size = 0;
+    bool has_json = false;
+    while (offset + sizeof(GlbChunkHeader) <= header.length) {
+        GlbChunkHeader chunk;
+        std::memcpy(&chunk, m_file.data() + offset, sizeof(chunk));
+        offset += sizeof(GlbChunkHeader);
+        if (chunk.length > header.length - offset)
+            throw std::runtime_error("truncated chunk");
+        const char* data = m_file.data() + offset;
+        if (chunk.type == GLB_CHUNK_JSON && !has_json) {
+            std::istringstream is(std::string(data, chunk.length));
+            boost::property_tree::read_json(is, m_json);
+            has_json = true;
+        } else if (chunk.type == GLB_CHUNK_BIN && bin == nullptr) {
+            bin = data;
+            bin_size = chunk.length;
+        }
+        offset += (chunk.length + 3) & ~std::uint32_t(3);
+    }
+    if (!has_json)
+        throw std::runtime_error("no JSON chunk");
+    if (m_json.get<std::string>("asset.version", "").compare(0, 2, "2.") != 0)
+        throw std::runtime_error("unsupported glTF version");
+
+    for (const auto& extension : getChild(m_json, "extensionsRequired")) {
+        const std::string name = extension.second.get_value<std::string>();
+        if (name != "KHR_lights_punctual")
+            throw std::runtime_error("required extension " + name + " is not supported");
+    }
+
+    // the binary chunk belongs to the first buffer, if that one has no uri
+    m_buffers.emplace_back(bin, bin_size);
+
+    m_json_accessors = getElements(m_json, "accessors");
+    m_json_buffer_views = getElements(m_json, "bufferViews");
+    m_json_images = getElements(m_json, "images");
+    m_json_textures = getElements(m_json, "textures");
+    m_json_cameras = getElements(m_json, "cameras");
+    m_json_lights = getElements(m_json, "extensions.KHR_lights_punctual.lights");
+}
+
+/***************************************************************************/
+
+ScenePtr GlbReader::read()
+{
+    mapBuffers();
+    getMaterials();
+    getMeshes();
+    getNodes();
+
+    std::size_t size = sizeof(Scene) + m_filename.size() + 1;
+    size += m_materials.size() * sizeof(Material*);
+    for (const auto& mat : m_materials) {
+        size += sizeof(Material) + mat.name.size() + 1;
+    }
+    size += m_textures.size() * sizeof(Texture*);
+    for (const auto& tex : m_textures) {
+        size += sizeof(Texture) + tex.size() + 1;
+    }
+    size += m_meshes.size() * sizeof(Mesh*);
+    for (const auto& mesh : m_meshes) {
+        std::size_t per_vertex_size = 2 * sizeof(glm::vec3); // position + normal
+        if (mesh.has_texcoords)
+            per_vertex_size += sizeof(glm::vec2);
+        if (mesh.has_tangents)
+            per_vertex_size += 2 * sizeof(glm::vec3);
+        if (mesh.has_vertex_colors)
+            per_vertex_size += sizeof(glm::vec3);
+        size += sizeof(Mesh) + mesh.name.size() + 1 +
+            mesh.num_vertices * per_vertex_size +
+            mesh.num_indices * sizeof(std::uint32_t);
+    }
+    size += m_lights.size() * sizeof(Light*);
+    for (const auto& light : m_lights) {
+        size += sizeof(Light) + light.name.size() + 1;
+    }
+    size += m_cameras.size() * sizeof(Camera*);
+    for (const auto& cam : m_cameras) {
+        size += sizeof(Camera) + cam.name.size() + 1;
+    }
+    size += m_nodes.size() * sizeof(Node*);
+    for (const auto& node : m_nodes) {
+        size += sizeof(Node) + node.name.size() + 1;
+    }
+    if (size > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("scene too large");
+
+    // dumping may still fail on broken indices
+    std::unique_ptr<char[]> storage{new char[size]};
+    char* data = storage.get();
+
+    Scene* scene = reinterpret_cast<Scene*>(data);
+    data += sizeof(Scene);
+    scene->name = data;
+    data = dumpString(data, m_filename);
+
+    scene->size = static_cast<std::uint32_t>(size);
+    scene->num_materials = static_cast<std::uint32_t>(m_materials.size());
+    scene->num_textures = static_cast<std::uint32_t>(m_textures.size());
+    scene->num_meshes = static_cast<std::uint32_t>(m_meshes.size());
+    scene->num_lights = static_cast<std::uint32_t>(m_lights.size());
+    scene->num_cameras = static_cast<std::uint32_t>(m_cameras.size());
+    scene->num_nodes = static_cast<std::uint32_t>(m_nodes.size());
+    scene->storage = nullptr;
+
+    // arrays
+    auto array = [&data] (const std::size_t count, const std::size_t element_size) -> char*
+    {
+        if (count == 0)
+            return nullptr;
+        char* result = data;
+        data += count * element_size;
+        return result;
+    };
+    scene->materials = reinterpret_cast<Material**>(array(m_materials.size(), sizeof(Material*)));
+    scene->meshes = reinterpret_cast<Mesh**>(array(m_meshes.size(), sizeof(Mesh*)));
+    scene->lights = reinterpret_cast<Light**>(array(m_lights.size(), sizeof(Light*)));
+    scene->textures = reinterpret_cast<Texture**>(array(m_textures.size(), sizeof(Texture*)));
+    scene->cameras = reinterpret_cast<Camera**>(array(m_cameras.size(), sizeof(Camera*)));
+    scene->nodes = reinterpret_cast<Node**>(array(m_nodes.size(), sizeof(Node*)));
+
+    // dump data
+    for (std::size_t i = 0; i < m_materials.size(); ++i) {
+        scene->materials[i] = reinterpret_cast<Material*>(data);
+        data = dumpMaterial(data, m_materials[i]);
+    }
+    for (std::size_t i = 0; i < m_meshes.size(); ++i) {
+        scene->meshes[i] = reinterpret_cast<Mesh*>(data);
+        data = dumpMesh(data, m_meshes[i]);
+    }
+    for (std::size_t i = 0; i < m_lights.size(); ++i) {
+        scene->lights[i] = reinterpret_cast<Light*>(data);
+        data = dumpLight(data, m_lights[i]);
+    }
+    for (std::size_t i = 0; i < m_textures.size(); ++i) {
+        scene->textures[i] = reinterpret_cast<Texture*>(data);
+        data = dumpTexture(data, m_textures[i]);
+    }
+    for (std::size_t i = 0; i < m_cameras.size(); ++i) {
+        scene->cameras[i] = reinterpret_cast<Camera*>(data);
+        data = dumpCamera(data, m_cameras[i]);
+    }
+    for (std::size_t i = 0; i < m_nodes.size(); ++i) {
+        scene->nodes[i] = reinterpret_cast<Node*>(data);
+        data = dumpNode(data, m_nodes[i]);
+    }
+
+    if (data != storage.get() + size)
+        throw std::runtime_error("scene size mismatch");
+
+    storage.release();
+    return ScenePtr(scene);
+}
+
+/***************************************************************************/
+
+void GlbReader::mapBuffers()
+{
+    const auto buffers = getElements(m_json, "buffers");
+    m_buffers.resize(buffers.size(), std::make_pair(nullptr, std::size_t(0)));
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+        const auto& buffer = *buffers[i];
+        const std::size_t length = buffer.get<std::size_t>("byteLength");
+        const auto uri = buffer.get_optional<std::string>("uri");
+        if (uri) {
+            if (uri->compare(0, 5, "data:") == 0)
+                throw std::runtime_error("data URIs are not supported");
+            m_external_buffers.emplace_back((m_parent_dir / *uri).string());
+            const auto& file = m_external_buffers.back();
+            if (!file)
+                throw std::runtime_error("can't read buffer " + *uri);
+            m_buffers[i] = std::make_pair(file.data(), file.size());
+        } else if (i != 0 || m_buffers[0].first == nullptr) {
+            throw std::runtime_error("buffer " + std::to_string(i) + " has no data");
+        }
+        if (length > m_buffers[i].second)
+            throw std::runtime_error("buffer " + std::to_string(i) + " is truncated");
+        m_buffers[i].second = length;
+    }
+}
+
+/***************************************************************************/
+
+Accessor GlbReader::getAccessor(const std::size_t idx) const
+{
+    if (idx >= m_json_accessors.size())
+        throw std::runtime_error("invalid accessor " + std::to_string(idx));
+    const ptree& json = *m_json_accessors[idx];
+    if (json.count("sparse") > 0)
+        throw std::runtime_error("sparse accessors are not supported");
+    const auto view_idx = json.get_optional<std::size_t>("bufferView");
+    if (!view_idx)
+        throw std::runtime_error("accessors without buffer views are not supported");
+
+    Accessor accessor;
+    accessor.count = json.get<std::size_t>("count");
+    accessor.component_type = json.get<int>("componentType");
+    accessor.num_components = numComponents(json.get<std::string>("type"));
+    accessor.normalized = json.get("normalized", false);
+    const auto element_size = static_cast<std::size_t>(componentSize(accessor.component_type) *
+            accessor.num_components);
+
+    if (*view_idx >= m_json_buffer_views.size())
+        throw std::runtime_error("invalid buffer view " + std::to_string(*view_idx));
+    const ptree& view = *m_json_buffer_views[*view_idx];
+    const auto buffer_idx = view.get<std::size_t>("buffer");
+    if (buffer_idx >= m_buffers.size())
+        throw std::runtime_error("invalid buffer " + std::to_string(buffer_idx));
+    const auto& buffer = m_buffers[buffer_idx];
+    const std::size_t view_offset = view.get<std::size_t>("byteOffset", 0);
+    const std::size_t view_length = view.get<std::size_t>("byteLength");
+    const std::size_t offset = json.get<std::size_t>("byteOffset", 0);
+    accessor.stride = view.get<std::size_t>("byteStride", element_size);
+
+    if (view_offset + view_length > buffer.second || (accessor.count > 0 &&
+                offset + (accessor.count - 1) * accessor.stride + element_size > view_length))
+        throw std::runtime_error("accessor " + std::to_string(idx) + " is out of bounds");
+    accessor.data = buffer.first + view_offset + offset;
+
+    return accessor;
+}
+
+/***************************************************************************/
+
+// Texture names are relative to the scene file, see loadTextures(). Embedded
+// images end up in the cache directory.
+std::string GlbReader::getImageName(const std::size_t idx)
+{
+    if (idx >= m_json_images.size())
+        throw std::runtime_error("invalid image " + std::to_string(idx));
+    const ptree& image = *m_json_images[idx];
+
+    const auto uri = image.get_optional<std::string>("uri");
+    if (uri) {
+        if (uri->compare(0, 5, "data:") == 0) {
+            LOG_WARNING(logtag::Import, m_filename, ": ignoring image ", idx,
+                    " with a data URI");
+            return std::string();
+        }
+        return *uri;
+    }
+
+    const auto view_idx = image.get<std::size_t>("bufferView");
+    if (view_idx >= m_json_buffer_views.size())
+        throw std::runtime_error("invalid buffer view " + std::to_string(view_idx));
+    const ptree& view = *m_json_buffer_views[view_idx];
+    const auto buffer_idx = view.get<std::size_t>("buffer");
+    if (buffer_idx >= m_buffers.size())
+        throw std::runtime_error("invalid buffer " + std::to_string(buffer_idx));
+    const std::size_t offset = view.get<std::size_t>("byteOffset", 0);
+    const std::size_t length = view.get<std::size_t>("byteLength");
+    if (offset + length > m_buffers[buffer_idx].second)
+        throw std::runtime_error("image " + std::to_string(idx) + " is out of bounds");
+
+    // FreeImage looks at the contents, the extension is for humans
+    const std::string mime_type = image.get<std::string>("mimeType", "");
+    const char* extension = mime_type == "image/png" ? ".png" :
+        (mime_type == "image/jpeg" ? ".jpg" : ".img");
+    const path file = path(vars.cache_dir) / path(m_filename + ".images") /
+        (std::to_string(idx) + extension);
+    create_directories(file.parent_path());
+    std::ofstream os(file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    os.write(m_buffers[buffer_idx].first + offset, static_cast<long>(length));
+    os.close();
+    if (!os)
+        throw std::runtime_error("can't write " + file.string());
+
+    return relative(absolute(file), absolute(m_parent_dir)).generic_string();
+}
+
+/***************************************************************************/
+
+int GlbReader::getTextureIndex(const ptree& texture_info)
+{
+    const auto idx = texture_info.get<std::size_t>("index");
+    if (idx >= m_json_textures.size())
+        throw std::runtime_error("invalid texture " + std::to_string(idx));
+    const auto source = m_json_textures[idx]->get_optional<std::size_t>("source");
+    if (!source)
+        return -1;
+    if (texture_info.get<int>("texCoord", 0) != 0)
+        LOG_WARNING(logtag::Import, m_filename, ": only the first texture coordinates are used");
+
+    if (*source >= m_image_textures.size())
+        m_image_textures.resize(*source + 1, -2);
+    int& texture = m_image_textures[*source];
+    if (texture == -2) {
+        std::string name = getImageName(*source);
+        if (name.empty()) {
+            texture = -1;
+        } else {
+            texture = static_cast<int>(m_textures.size());
+            m_textures.emplace_back(std::move(name));
+        }
+    }
+    return texture;
+}
+
+/***************************************************************************/
+
+void GlbReader::getMaterials()
+{
+    const auto materials = getElements(m_json, "materials");
+    for (std::size_t i = 0; i < materials.size(); ++i) {
+        const ptree& json = *materials[i];
+        GlbMaterial mat;
+        mat.name = json.get<std::string>("name", m_filename + "_material" + std::to_string(i));
+
+        const ptree& pbr = getChild(json, "pbrMetallicRoughness");
+        const std::vector<float> base_color = getFloats(pbr, "baseColorFactor");
+        if (base_color.size() == 4) {
+            mat.base_color = glm::vec3(base_color[0], base_color[1], base_color[2]);
+            mat.alpha = base_color[3];
+        }
+        mat.metallic = pbr.get("metallicFactor", 1.f);
+        mat.roughness = pbr.get("roughnessFactor", 1.f);
+        if (pbr.count("baseColorTexture") > 0)
+            mat.diffuse_tex = getTextureIndex(getChild(pbr, "baseColorTexture"));
+
+        if (json.count("normalTexture") > 0)
+            mat.normal_tex = getTextureIndex(getChild(json, "normalTexture"));
+        if (json.count("emissiveTexture") > 0)
+            mat.emissive_tex = getTextureIndex(getChild(json, "emissiveTexture"));
+        const std::vector<float> emissive = getFloats(json, "emissiveFactor");
+        if (emissive.size() == 3)
+            mat.emissive_color = glm::vec3(emissive[0], emissive[1], emissive[2]);
+        mat.blend = json.get<std::string>("alphaMode", "OPAQUE") == "BLEND";
+
+        m_materials.push_back(std::move(mat));
+    }
+}
+
+/***************************************************************************/
+
+void GlbReader::getMeshes()
+{
+    const auto meshes = getElements(m_json, "meshes");
+    m_primitive_meshes.resize(meshes.size());
+    for (std::size_t i = 0; i < meshes.size(); ++i) {
+        const std::string name = meshes[i]->get<std::string>("name",
+                m_filename + "_mesh" + std::to_string(i));
+        const auto primitives = getElements(*meshes[i], "primitives");
+        for (std::size_t j = 0; j < primitives.size(); ++j) {
+            const ptree& primitive = *primitives[j];
+            if (primitive.get<int>("mode", GLTF_TRIANGLES) != GLTF_TRIANGLES) {
+                LOG_WARNING(logtag::Import, m_filename, ": skipping primitive ", j,
+                        " of mesh ", name, ", it doesn't consist of triangles");
+                continue;
+            }
+
+            GlbMesh mesh;
+            mesh.name = name + '_' + std::to_string(j);
+            mesh.primitive = &primitive;
+
+            const ptree& attributes = getChild(primitive, "attributes");
+            const Accessor positions = getAccessor(attributes.get<std::size_t>("POSITION"));
+            if (positions.component_type != GLTF_FLOAT || positions.num_components != 3)
+                throw std::runtime_error("positions of " + mesh.name + " aren't float3");
+            mesh.num_vertices = static_cast<std::uint32_t>(positions.count);
+            const auto indices = primitive.get_optional<std::size_t>("indices");
+            mesh.num_indices = static_cast<std::uint32_t>(indices ?
+                    getAccessor(*indices).count : positions.count);
+            if (mesh.num_indices % 3 != 0)
+                throw std::runtime_error(mesh.name + " isn't a triangle list");
+
+            const auto material = primitive.get_optional<std::size_t>("material");
+            if (material) {
+                if (*material >= m_materials.size())
+                    throw std::runtime_error("invalid material " + std::to_string(*material));
+                mesh.material_index = static_cast<std::uint32_t>(*material);
+            } else {
+                if (m_default_material == -1) {
+                    m_default_material = static_cast<int>(m_materials.size());
+                    m_materials.emplace_back();
+                    m_materials.back().name = m_filename + "_default_material";
+                }
+                mesh.material_index = static_cast<std::uint32_t>(m_default_material);
+            }
+
+            // same rules as for Assimp's meshes
+            const GlbMaterial& mat = m_materials[mesh.material_index];
+            mesh.has_texcoords = false;
+            mesh.has_tangents = false;
+            mesh.has_vertex_colors = false;
+            if (mat.needsTexcoords()) {
+                if (attributes.count("TEXCOORD_0") == 0)
+                    throw std::runtime_error("textured mesh " + mesh.name +
+                            " doesn't provide texture coordinates");
+                mesh.has_texcoords = true;
+                mesh.has_tangents = mat.needsTangents();
+            } else if (attributes.count("COLOR_0") > 0) {
+                mesh.has_vertex_colors = true;
+            }
+
+            m_primitive_meshes[i].push_back(static_cast<std::uint32_t>(m_meshes.size()));
+            m_meshes.push_back(std::move(mesh));
+        }
+    }
+}
+
+/***************************************************************************/
+
+// Walks the hierarchy of the default scene depth-first. The first primitive
+// of a mesh carries the node's transformation, the other primitives and the
+// children are attached to it. Cameras and lights get world transformations.
+void GlbReader::getNodes()
+{
+    const auto nodes = getElements(m_json, "nodes");
+    const auto& cameras = m_json_cameras;
+
+    std::vector<std::size_t> roots;
+    const auto scenes = getElements(m_json, "scenes");
+    if (!scenes.empty()) {
+        const auto scene_idx = m_json.get<std::size_t>("scene", 0);
+        if (scene_idx >= scenes.size())
+            throw std::runtime_error("invalid scene " + std::to_string(scene_idx));
+        for (const auto& root : getChild(*scenes[scene_idx], "nodes")) {
+            roots.push_back(root.second.get_value<std::size_t>());
+        }
+    } else {
+        std::vector<bool> is_child(nodes.size(), false);
+        for (const auto* node : nodes) {
+            for (const auto& child : getChild(*node, "children")) {
+                const auto idx = child.second.get_value<std::size_t>();
+                if (idx < nodes.size())
+                    is_child[idx] = true;
+            }
+        }
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            if (!is_child[i])
+                roots.push_back(i);
+        }
+    }
+
+    struct StackEntry
+    {
+        std::size_t     node;
+        glm::mat4       parent_transformation;  // world space
+        std::uint32_t   parent_index;
+    };
+    std::vector<bool> visited(nodes.size(), false);
+    std::vector<StackEntry> stack;
+    for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+        stack.push_back(StackEntry{*it, glm::mat4(1.f), Node::NO_PARENT});
+    }
+    while (!stack.empty()) {
+        const StackEntry entry = stack.back();
+        const std::size_t idx = entry.node;
+        stack.pop_back();
+        if (idx >= nodes.size() || visited[idx])
+            throw std::runtime_error("invalid node hierarchy");
+        visited[idx] = true;
+
+        const ptree& node = *nodes[idx];
+        const glm::mat4 local = getLocalTransformation(node);
+        const glm::mat4 transformation = entry.parent_transformation * local;
+        const std::string name = m_filename + "_node" + std::to_string(idx);
+        const auto& children = getChild(node, "children");
+
+        const auto mesh = node.get_optional<std::size_t>("mesh");
+        if (mesh && *mesh >= m_primitive_meshes.size())
+            throw std::runtime_error("invalid mesh " + std::to_string(*mesh));
+        const std::vector<std::uint32_t> no_primitives;
+        const auto& primitives = mesh ? m_primitive_meshes[*mesh] : no_primitives;
+
+        // cameras and lights don't need a node of their own
+        auto index = Node::NO_PARENT;
+        if (!primitives.empty() || !children.empty()) {
+            index = static_cast<std::uint32_t>(m_nodes.size());
+            if (primitives.empty()) {
+                m_nodes.push_back(GlbNode{name, local, Node::NO_MESH, entry.parent_index});
+            } else {
+                m_nodes.push_back(GlbNode{name + "_0", local, primitives[0],
+                        entry.parent_index});
+            }
+            for (std::size_t i = 1; i < primitives.size(); ++i) {
+                m_nodes.push_back(GlbNode{name + '_' + std::to_string(i), glm::mat4(1.f),
+                        primitives[i], index});
+            }
+        }
+
+        const auto camera = node.get_optional<std::size_t>("camera");
+        if (camera) {
+            if (*camera >= cameras.size())
+                throw std::runtime_error("invalid camera " + std::to_string(*camera));
+            if (cameras[*camera]->get<std::string>("type", "") == "perspective") {
+                m_cameras.push_back(GlbObject{cameras[*camera]->get<std::string>("name",
+                            m_filename + "_camera" + std::to_string(*camera)),
+                        transformation, *camera});
+            } else {
+                LOG_WARNING(logtag::Import, m_filename, ": ignoring orthographic camera ",
+                        *camera);
+            }
+        }
+
+        const auto light = node.get_optional<std::size_t>("extensions.KHR_lights_punctual.light");
+        if (light) {
+            m_lights.push_back(GlbObject{std::string(), transformation, *light});
+        }
+
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            stack.push_back(StackEntry{it->second.get_value<std::size_t>(), transformation,
+                    index});
+        }
+    }
+
+    for (auto& light : m_lights) {
+        if (light.index >= m_json_lights.size())
+            throw std::runtime_error("invalid light " + std::to_string(light.index));
+        light.name = m_json_lights[light.index]->get<std::string>("name",
+                m_filename + "_light" + std::to_string(light.index));
+    }
+}
+
+/***************************************************************************/
+
+char* GlbReader::dumpMaterial(char* ptr, const GlbMaterial& mat) const
+{
+    Material* my_mat = reinterpret_cast<Material*>(ptr);
+    ptr += sizeof(Material);
+
+    my_mat->name = ptr;
+    my_mat->diffuse_texture = mat.diffuse_tex;
+    my_mat->specular_texture = -1;
+    my_mat->exponent_texture = -1;
+    my_mat->normal_texture = mat.normal_tex;
+    my_mat->emissive_texture = mat.emissive_tex;
+    my_mat->alpha_texture = -1;
+    my_mat->ambient_texture = -1;
+
+    // metals reflect their base color, dielectrics about 4%
+    my_mat->diffuse_color = mat.base_color * (1.f - mat.metallic);
+    my_mat->specular_color = glm::mix(glm::vec3(.04f), mat.base_color, mat.metallic);
+    my_mat->ambient_color = glm::vec3(.0f);
+    my_mat->emissive_color = mat.emissive_color;
+    my_mat->transparent_color = glm::vec3(.0f);
+
+    // Blinn-Phong exponent with about the same highlight
+    const float alpha = std::max(mat.roughness * mat.roughness, .01f);
+    my_mat->specular_exponent = std::max(2.f / (alpha * alpha) - 2.f, 1.f);
+    my_mat->opacity = mat.blend ? mat.alpha : 1.f;
+
+    return dumpString(ptr, mat.name);
+}
+
+/***************************************************************************/
+
+char* GlbReader::dumpTexture(char* ptr, const std::string& tex) const
+{
+    Texture* my_tex = reinterpret_cast<Texture*>(ptr);
+    ptr += sizeof(Texture);
+    my_tex->name = ptr;
+    my_tex->data = nullptr;
+    return dumpString(ptr, tex);
+}
+
+/***************************************************************************/
+
+char* GlbReader::dumpMesh(char* ptr, const GlbMesh& mesh) const
+{
+    const ptree& attributes = getChild(*mesh.primitive, "attributes");
+    Mesh* my_mesh = reinterpret_cast<Mesh*>(ptr);
+    ptr += sizeof(Mesh);
+
+    my_mesh->name = ptr;
+    ptr = dumpString(ptr, mesh.name);
+
+    auto array = [&ptr] (const std::uint32_t count, const std::size_t element_size) -> char*
+    {
+        char* result = ptr;
+        ptr += count * element_size;
+        return result;
+    };
+    my_mesh->indices = reinterpret_cast<std::uint32_t*>(array(mesh.num_indices,
+                sizeof(std::uint32_t)));
+    my_mesh->vertices = reinterpret_cast<glm::vec3*>(array(mesh.num_vertices,
+                sizeof(glm::vec3)));
+    my_mesh->normals = reinterpret_cast<glm::vec3*>(array(mesh.num_vertices,
+                sizeof(glm::vec3)));
+    if (mesh.has_tangents) {
+        my_mesh->tangents = reinterpret_cast<glm::vec3*>(array(mesh.num_vertices,
+                    sizeof(glm::vec3)));
+        my_mesh->bitangents = reinterpret_cast<glm::vec3*>(array(mesh.num_vertices,
+                    sizeof(glm::vec3)));
+    } else {
+        my_mesh->tangents = nullptr;
+        my_mesh->bitangents = nullptr;
+    }
+    my_mesh->vertex_colors = mesh.has_vertex_colors ?
+        reinterpret_cast<glm::vec3*>(array(mesh.num_vertices, sizeof(glm::vec3))) : nullptr;
+    my_mesh->texcoords = mesh.has_texcoords ?
+        reinterpret_cast<glm::vec2*>(array(mesh.num_vertices, sizeof(glm::vec2))) : nullptr;
+
+    // added by addDerivedData(), once the triangle order is final
+    my_mesh->meshlets = nullptr;
+    my_mesh->lods = nullptr;
+    my_mesh->lod_indices = nullptr;
+    my_mesh->num_meshlets = 0;
+    my_mesh->num_lods = 0;
+    my_mesh->num_lod_indices = 0;
+    my_mesh->geometry_hash = 0;
+
+    my_mesh->material_index = mesh.material_index;
+    my_mesh->num_vertices = mesh.num_vertices;
+    my_mesh->num_indices = mesh.num_indices;
+
+    const auto indices = mesh.primitive->get_optional<std::size_t>("indices");
+    if (indices) {
+        const Accessor accessor = getAccessor(*indices);
+        if (accessor.component_type == GLTF_UNSIGNED_INT &&
+                accessor.stride == sizeof(std::uint32_t)) {
+            std::memcpy(my_mesh->indices, accessor.data,
+                    mesh.num_indices * sizeof(std::uint32_t));
+        } else {
+            for (std::uint32_t i = 0; i < mesh.num_indices; ++i) {
+                my_mesh->indices[i] = accessor.getIndex(i);
+            }
+        }
+        const auto max_index = std::max_element(my_mesh->indices,
+                my_mesh->indices + mesh.num_indices);
+        if (max_index != my_mesh->indices + mesh.num_indices && *max_index >= mesh.num_vertices)
+            throw std::runtime_error("index out of range in " + mesh.name);
+    } else {
+        for (std::uint32_t i = 0; i < mesh.num_indices; ++i) {
+            my_mesh->indices[i] = i;
+        }
+    }
+
+    copyAccessor(getAccessor(attributes.get<std::size_t>("POSITION")), my_mesh->vertices);
+    my_mesh->bbox = core::AABB();
+    for (std::uint32_t i = 0; i < mesh.num_vertices; ++i) {
+        my_mesh->bbox.expandBy(my_mesh->vertices[i]);
+    }
+
+    // every accessor of a primitive has the same count
+    auto getAttribute = [&] (const char* name) -> Accessor
+    {
+        const Accessor accessor = getAccessor(attributes.get<std::size_t>(name));
+        if (accessor.count != mesh.num_vertices)
+            throw std::runtime_error(std::string(name) + " of " + mesh.name +
+                    " doesn't match the number of vertices");
+        return accessor;
+    };
+
+    if (attributes.count("NORMAL") > 0) {
+        copyAccessor(getAttribute("NORMAL"), my_mesh->normals);
+    } else {
+        computeNormals(my_mesh);
+    }
+
+    if (mesh.has_texcoords) {
+        copyAccessor(getAttribute("TEXCOORD_0"), my_mesh->texcoords);
+        // glTF's origin is the upper left corner
+        for (std::uint32_t i = 0; i < mesh.num_vertices; ++i) {
+            my_mesh->texcoords[i].y = 1.f - my_mesh->texcoords[i].y;
+        }
+    }
+
+    if (mesh.has_tangents) {
+        if (attributes.count("TANGENT") > 0) {
+            const Accessor tangents = getAttribute("TANGENT");
+            if (tangents.num_components != 4)
+                throw std::runtime_error("tangents of " + mesh.name + " aren't float4");
+            for (std::uint32_t i = 0; i < mesh.num_vertices; ++i) {
+                const glm::vec3 t(tangents.get(i, 0), tangents.get(i, 1), tangents.get(i, 2));
+                // the flip of the texture coordinates turns the bitangent around
+                const float w = -tangents.get(i, 3);
+                my_mesh->tangents[i] = t;
+                my_mesh->bitangents[i] = glm::cross(my_mesh->normals[i], t) * w;
+            }
+        } else {
+            computeTangents(my_mesh);
+        }
+    }
+
+    if (mesh.has_vertex_colors) {
+        const Accessor colors = getAttribute("COLOR_0");
+        if (colors.num_components < 3)
+            throw std::runtime_error("vertex colors of " + mesh.name + " aren't rgb(a)");
+        for (std::uint32_t i = 0; i < mesh.num_vertices; ++i) {
+            my_mesh->vertex_colors[i] = glm::vec3(colors.get(i, 0), colors.get(i, 1),
+                    colors.get(i, 2));
+        }
+    }
+
+    return ptr;
+}
+
+/***************************************************************************/
+
+char* GlbReader::dumpNode(char* ptr, const GlbNode& node) const
+{
+    Node* my_node = reinterpret_cast<Node*>(ptr);
+    ptr += sizeof(Node);
+
+    my_node->name = ptr;
+    ptr = dumpString(ptr, node.name);
+
+    const glm::mat4& transformation = node.transformation;
+    my_node->transformation = transformation;
+    my_node->position = glm::vec3(transformation[3]);
+
+    glm::mat3 rot;
+
+    glm::vec3 axis{transformation[0]};
+    my_node->scale.x = glm::length(axis);
+    rot[0] = axis / my_node->scale.x;
+
+    axis = glm::vec3(transformation[1]);
+    my_node->scale.y = glm::length(axis);
+    rot[1] = axis / my_node->scale.y;
+
+    axis = glm::vec3(transformation[2]);
+    my_node->scale.z = glm::length(axis);
+    rot[2] = axis / my_node->scale.z;
+
+    if (glm::dot(rot[0], glm::cross(rot[1], rot[2])) < .0f) {
+        my_node->scale.x *= -1.f;
+        rot[0] = -rot[0];
+    }
+
+    my_node->rotation = glm::quat_cast(rot);
+    my_node->mesh_index = node.mesh_index;
+    my_node->parent_index = node.parent_index;
+
+    return ptr;
+}
+
+/***************************************************************************/
+
+char* GlbReader::dumpCamera(char* ptr, const GlbObject& cam) const
+{
+    Camera* my_cam = reinterpret_cast<Camera*>(ptr);
+    ptr += sizeof(Camera);
+
+    const ptree& perspective = getChild(*m_json_cameras[cam.index], "perspective");
+    const float yfov = perspective.get<float>("yfov");
+
+    // glTF cameras look down -z
+    my_cam->name = ptr;
+    my_cam->position = glm::vec3(cam.transformation[3]);
+    my_cam->direction = transformDirection(cam.transformation, glm::vec3(0.f, 0.f, -1.f));
+    my_cam->up = transformDirection(cam.transformation, glm::vec3(0.f, 1.f, 0.f));
+    my_cam->aspect_ratio = perspective.get("aspectRatio", 4.f / 3.f);
+    my_cam->hfov = glm::degrees(2.f * std::atan(std::tan(yfov / 2.f) * my_cam->aspect_ratio));
+
+    return dumpString(ptr, cam.name);
+}
+
+/***************************************************************************/
+
+char* GlbReader::dumpLight(char* ptr, const GlbObject& light) const
+{
+    Light* my_light = reinterpret_cast<Light*>(ptr);
+    ptr += sizeof(Light);
+
+    const ptree& json = *m_json_lights[light.index];
+    const std::vector<float> color = getFloats(json, "color");
+    const float intensity = json.get("intensity", 1.f);
+
+    // glTF lights shine down -z and fall off with the inverse square
+    my_light->name = ptr;
+    my_light->position = glm::vec3(light.transformation[3]);
+    my_light->direction = transformDirection(light.transformation, glm::vec3(0.f, 0.f, -1.f));
+    my_light->color = (color.size() == 3 ? glm::vec3(color[0], color[1], color[2]) :
+            glm::vec3(1.f)) * intensity;
+    my_light->angle_inner_cone = json.get("spot.innerConeAngle", 0.f);
+    my_light->angle_outer_cone = json.get("spot.outerConeAngle", glm::pi<float>() / 4.f);
+    my_light->constant_attenuation = 0.f;
+    my_light->linear_attenuation = 0.f;
+    my_light->quadratic_attenuation = 1.f;
+    my_light->max_distance = json.get("range", std::numeric_limits<float>::infinity());
+
+    const std::string type = json.get<std::string>("type", "point");
+    if (type == "directional") {
+        my_light->type = LightType::DIRECTIONAL;
+    } else if (type == "spot") {
+        my_light->type = LightType::SPOT;
+    } else {
+        my_light->type = LightType::POINT;
+    }
+
+    return dumpString(ptr, light.name);
+}
+
+/***************************************************************************/
+
+} // anonymous namespace
+
+/***************************************************************************/
+
+namespace import
+{
+
+/***************************************************************************/
+
+bool isGlbFile(const std::string& filename)
+{
+    return path(filename).extension() == ".glb";
+}
+
+/***************************************************************************/
+
+ScenePtr glbImport(const std::string& filename)
+{
+    try {
+        GlbReader reader(filename);
+        return reader.read();
+    } catch (const std::exception& e) {
+        LOG_ERROR(logtag::Import, "Failed to import ", filename, ": ", e.what());
+    }
+    return nullptr;
+}
+
+/***************************************************************************/
+
+} // namespace import
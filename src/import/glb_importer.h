@@ -0,0 +1,23 @@
+#ifndef IMPORT_GLB_IMPORTER_H
+#define IMPORT_GLB_IMPORTER_H
+
+#include <string>
+
+#include "scene.h"
+
+namespace import
+{
+
+constexpr int GLB_IMPORTER_VERSION = 1;
+
+bool isGlbFile(const std::string& filename);
+
+// Reads binary glTF 2.0 files without going through Assimp. The accessors
+// are copied from the mapped file straight into the scene. Embedded images
+// are written to the cache directory, so that they can be loaded like any
+// other texture.
+ScenePtr glbImport(const std::string& filename);
+
+} // namespace import
+
+#endif // IMPORT_GLB_IMPORTER_H
@@ -75,6 +75,24 @@ Image::Image(const std::string& filename)
 
 /////////////////////////////////////////////////////////////////////
 
+std::size_t Image::decodedSize(const std::string& filename)
+{
+    const FREE_IMAGE_FORMAT format = FreeImage_GetFileType(filename.c_str(), 0);
+    if (format == FIF_UNKNOWN || !FreeImage_FIFSupportsNoPixels(format))
+        return 0;
+
+    FIBITMAP* const header = FreeImage_Load(format, filename.c_str(), FIF_LOAD_NOPIXELS);
+    if (header == nullptr)
+        return 0;
+
+    const std::size_t size = static_cast<std::size_t>(FreeImage_GetPitch(header)) *
+        FreeImage_GetHeight(header);
+    FreeImage_Unload(header);
+    return size;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 Image::Image(const FREE_IMAGE_TYPE type_, const int width_,
         const int height_, const int bpp_)
   : m_obj{nullptr}
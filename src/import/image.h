@@ -15,6 +15,10 @@ public:
 
     explicit Image(const std::string& filename);
 
+    // Size of the decoded bitmap, read from the file header.
+    // Returns 0 if the format can't provide it without decoding.
+    static std::size_t decodedSize(const std::string& filename);
+
     Image(FREE_IMAGE_TYPE type, int width, int height,
             int bpp);
 
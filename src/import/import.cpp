@@ -1,10 +1,19 @@
-#include <fstream>
+#include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <exception>
+#include <future>
+#include <vector>
 
 #include "log/log.h"
 #include "framework/vars.h"
+#include "util/thread_pool.h"
 #include "import.h"
 #include "assimporter.h"
+#include "glb_importer.h"
+#include "cache.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
 
 #include <boost/filesystem.hpp>
 using namespace boost::filesystem;
@@ -18,107 +27,408 @@ namespace
 
 /***************************************************************************/
 
-constexpr int VERSION = Scene::VERSION + Light::VERSION + Material::VERSION +
-        Mesh::VERSION + Node::VERSION + Texture::VERSION + Camera::VERSION +
-        ASSIMPORTER_VERSION;
+// shared by all concurrently imported scene files
+util::ThreadPool& workerPool()
+{
+    static util::ThreadPool pool(static_cast<unsigned int>(std::max(vars.import_threads, 0)));
+    return pool;
+}
+
+/***************************************************************************/
+
+util::MemoryBudget& decodeBudget()
+{
+    static util::MemoryBudget budget(static_cast<std::size_t>(
+                std::max(vars.texture_decode_memory_mb, 1)) * 1024 * 1024);
+    return budget;
+}
 
 /***************************************************************************/
 
-struct FileHeader
+struct LoadedTexture
 {
-    char header[4];
-    int version;
+    std::unique_ptr<TextureData>    data;
+    double                          time; // ms
+    bool                            cached;
 };
 
 /***************************************************************************/
 
-constexpr char HEADER_STRING[5] = "aibf";
+const char* blockFormatName(const BlockFormat format)
+{
+    switch (format) {
+    case BlockFormat::BC1:
+        return "BC1";
+    case BlockFormat::BC3:
+        return "BC3";
+    case BlockFormat::BC4:
+        return "BC4";
+    case BlockFormat::BC5:
+        return "BC5";
+    case BlockFormat::None:
+    default:
+        return "uncompressed";
+    }
+}
 
 /***************************************************************************/
 
-std::unique_ptr<Scene> getCachedData(const std::string& scenefile)
+BlockFormat chooseBlockFormat(const TextureData& texture, const bool normal_map)
 {
-    std::unique_ptr<Scene> result;
+    if (!vars.texture_compression)
+        return BlockFormat::None;
+    if (texture.num_channels == 1)
+        return BlockFormat::BC4;
+    if (normal_map)
+        return BlockFormat::BC5;
+    return texture.hasTransparency() ? BlockFormat::BC3 : BlockFormat::BC1;
+}
 
-    path file = vars.cache_dir / path(scenefile);
-    if (!exists(file) || !is_regular_file(file)) {
-        return result;
-    }
+/***************************************************************************/
 
-    if (last_write_time(file) < last_write_time(scenefile)) {
-        std::remove(file.c_str());
-        return result;
-    }
-    // special case for wavefront obj's
-    if (std::strcmp(file.extension().c_str(), ".obj") == 0) {
-        path mtl_file(scenefile.substr(0, scenefile.size() - 3) + "mtl");
-        if (exists(mtl_file) && (last_write_time(file) < last_write_time(mtl_file))) {
-            std::remove(file.c_str());
-            return result;
+// the cache holds whatever was baked last
+bool matchesSettings(const TextureData& texture, const bool normal_map)
+{
+    if (!vars.texture_compression)
+        return texture.compression == BlockFormat::None;
+    if (texture.num_channels == 1)
+        return texture.compression == BlockFormat::BC4;
+    if (normal_map)
+        return texture.compression == BlockFormat::BC5;
+    return texture.compression == BlockFormat::BC1 ||
+        texture.compression == BlockFormat::BC3;
+}
+
+/***************************************************************************/
+
+LoadedTexture loadTexture(const std::string& filename, const bool normal_map)
+{
+    LoadedTexture result;
+    result.data.reset(new TextureData);
+    const auto start = std::chrono::steady_clock::now();
+
+    result.cached = loadTextureCache(filename, *result.data) &&
+        matchesSettings(*result.data, normal_map);
+    if (!result.cached) {
+        // decodes in flight may not exceed the memory budget,
+        // the mip chain needs about as much as the image itself
+        const std::size_t size = 2 * Image::decodedSize(filename);
+        auto& budget = decodeBudget();
+        budget.acquire(size);
+        try {
+            const Image image(filename);
+            *result.data = TextureData(image);
+
+            const BlockFormat format = chooseBlockFormat(*result.data, normal_map);
+            if (format != BlockFormat::None) {
+                TextureData::CompressionStats stats;
+                result.data->compress(format, vars.texture_compression_refinement, &stats);
+
+                std::uint64_t num_pixels = 0;
+                for (const auto& level : result.data->levels) {
+                    num_pixels += static_cast<std::uint64_t>(level.width) * level.height;
+                }
+                LOG_INFO(logtag::Import, "Compressed ", filename, " to ",
+                        blockFormatName(format), ": PSNR ", stats.psnr, " dB, ",
+                        stats.time, " ms, ",
+                        static_cast<double>(num_pixels) / (std::max(stats.time, 1e-3) * 1000.0),
+                        " MPixel/s");
+            }
+        } catch (...) {
+            budget.release(size);
+            throw;
         }
+        budget.release(size);
+
+        writeTextureCache(*result.data, filename);
     }
 
-    std::ifstream is(file.c_str(), std::ios::in | std::ios::binary);
-    if (!is) {
-        return result;
+    const std::chrono::duration<double, std::milli> time =
+        std::chrono::steady_clock::now() - start;
+    result.time = time.count();
+
+    return result;
+}
+
+/***************************************************************************/
+
+void optimizeMeshes(Scene* const scene)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    VertexCacheStats before{0, 0, 0};
+    VertexCacheStats after{0, 0, 0};
+    auto accumulate = [] (VertexCacheStats& total, const VertexCacheStats& stats)
+    {
+        total.num_triangles += stats.num_triangles;
+        total.num_vertices += stats.num_vertices;
+        total.num_transformed += stats.num_transformed;
+    };
+
+    for (unsigned int i = 0; i < scene->num_meshes; ++i) {
+        Mesh* mesh = scene->meshes[i];
+        accumulate(before, analyzeVertexCache(mesh->indices, mesh->num_indices,
+                    mesh->num_vertices));
+        optimizeMesh(mesh);
+        accumulate(after, analyzeVertexCache(mesh->indices, mesh->num_indices,
+                    mesh->num_vertices));
     }
 
-    is.seekg(0, std::ios::end);
-    const std::size_t size = static_cast<std::size_t>(is.tellg());
-    is.seekg(0, std::ios::beg);
+    const std::chrono::duration<double, std::milli> time =
+        std::chrono::steady_clock::now() - start;
+    LOG_INFO(logtag::Import, "Optimized ", scene->num_meshes, " meshes of ", scene->name,
+            " in ", time.count(), " ms: ACMR ", before.acmr(), " -> ", after.acmr(),
+            ", ATVR ", before.atvr(), " -> ", after.atvr());
+}
 
-    if (size < sizeof(FileHeader) + sizeof(Scene)) {
-        return result;
+/***************************************************************************/
+
+// appends 'src' to the blob, returns its offset relative to the owner
+template <typename T>
+T* copyArray(char* const base, std::size_t& offset, const std::size_t owner_offset,
+        const std::vector<T>& src)
+{
+    if (src.empty())
+        return nullptr;
+    std::memcpy(base + offset, src.data(), src.size() * sizeof(T));
+    T* result = reinterpret_cast<T*>(offset - owner_offset);
+    offset += src.size() * sizeof(T);
+    return result;
+}
+
+/***************************************************************************/
+
+// turns the relative pointers of 'array' into offsets into the moved blob
+template <typename T, typename Shift>
+void relocate(char* const base, T** const array, const std::uint32_t count, const Shift& shift)
+{
+    if (array == nullptr)
+        return;
+    T** ptrs = reinterpret_cast<T**>(base + reinterpret_cast<std::size_t>(array));
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const auto offset = reinterpret_cast<std::size_t>(ptrs[i]);
+        ptrs[i] = reinterpret_cast<T*>(offset + shift(offset));
     }
+}
 
-    FileHeader header;
-    is.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+/***************************************************************************/
+
+// built from the final triangle list of a mesh
+struct DerivedData
+{
+    std::vector<Meshlet>        meshlets;
+    std::vector<MeshLod>        lods;
+    std::vector<std::uint32_t>  lod_indices;
 
-    if (std::strncmp(header.header, HEADER_STRING, sizeof(HEADER_STRING) - 1) != 0 ||
-            header.version != VERSION)
+    std::size_t size() const noexcept
     {
-        is.close();
-        std::remove(file.c_str());
-        return result;
+        return meshlets.size() * sizeof(Meshlet) + lods.size() * sizeof(MeshLod) +
+            lod_indices.size() * sizeof(std::uint32_t);
     }
+};
 
-    char* data = new char[size - sizeof(FileHeader)];
-    result.reset(reinterpret_cast<Scene*>(data));
-    is.read(data, static_cast<long>(size - sizeof(FileHeader)));
-    is.close();
+/***************************************************************************/
 
-    if (result->size != size - sizeof(FileHeader)) {
-        result.reset();
+// Meshlets and LODs of a mesh are stored right behind its data, so they are
+// part of the mesh's cache section. The blob is rebuilt with room for them,
+// all objects behind a mesh move accordingly.
+ScenePtr addDerivedData(ScenePtr scene)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<DerivedData> derived(scene->num_meshes);
+    std::vector<std::uint64_t> geometry_hashes(scene->num_meshes);
+    std::size_t num_meshlets = 0;
+    std::size_t num_lods = 0;
+    std::size_t num_triangles = 0;
+    std::size_t num_lod_triangles = 0;
+    for (std::uint32_t i = 0; i < scene->num_meshes; ++i) {
+        geometry_hashes[i] = scene->meshes[i]->hashGeometry();
+        buildMeshlets(scene->meshes[i], derived[i].meshlets);
+        num_meshlets += derived[i].meshlets.size();
+        num_triangles += scene->meshes[i]->num_indices / 3;
+        if (vars.mesh_lods) {
+            buildLods(scene->meshes[i], derived[i].lods, derived[i].lod_indices);
+            num_lods += derived[i].lods.size();
+            num_lod_triangles += derived[i].lod_indices.size() / 3;
+        }
     }
 
-    return result;
+    // every object is followed by its data, so a mesh ends where the next object starts
+    const char* const base = reinterpret_cast<const char*>(scene.get());
+    std::vector<std::size_t> starts;
+    auto add = [&] (const void* ptr)
+    {
+        starts.push_back(static_cast<std::size_t>(static_cast<const char*>(ptr) - base));
+    };
+    for (std::uint32_t i = 0; i < scene->num_materials; ++i)
+        add(scene->materials[i]);
+    for (std::uint32_t i = 0; i < scene->num_meshes; ++i)
+        add(scene->meshes[i]);
+    for (std::uint32_t i = 0; i < scene->num_lights; ++i)
+        add(scene->lights[i]);
+    for (std::uint32_t i = 0; i < scene->num_textures; ++i)
+        add(scene->textures[i]);
+    for (std::uint32_t i = 0; i < scene->num_cameras; ++i)
+        add(scene->cameras[i]);
+    for (std::uint32_t i = 0; i < scene->num_nodes; ++i)
+        add(scene->nodes[i]);
+    starts.push_back(scene->size);
+    std::sort(starts.begin(), starts.end());
+
+    struct Insertion
+    {
+        std::size_t     mesh_offset;
+        std::size_t     offset;     // end of the mesh data
+        std::size_t     size;
+        std::uint32_t   mesh;
+    };
+    std::vector<Insertion> insertions(scene->num_meshes);
+    std::size_t size = scene->size;
+    for (std::uint32_t i = 0; i < scene->num_meshes; ++i) {
+        auto& insertion = insertions[i];
+        insertion.mesh_offset = static_cast<std::size_t>(
+                reinterpret_cast<const char*>(scene->meshes[i]) - base);
+        insertion.offset = *std::upper_bound(starts.begin(), starts.end(),
+                insertion.mesh_offset);
+        insertion.size = derived[i].size();
+        insertion.mesh = i;
+        size += insertion.size;
+    }
+    std::sort(insertions.begin(), insertions.end(),
+            [] (const Insertion& i0, const Insertion& i1) -> bool
+            {
+                return i0.offset < i1.offset;
+            });
+
+    // objects at or behind an insertion move by its size
+    auto shift = [&insertions] (const std::size_t offset) -> std::size_t
+    {
+        std::size_t result = 0;
+        for (const auto& insertion : insertions) {
+            if (insertion.offset > offset)
+                break;
+            result += insertion.size;
+        }
+        return result;
+    };
+
+    std::unique_ptr<char[]> data{new char[size]};
+    scene->makePointersRelative();
+    std::size_t src = 0;
+    std::size_t dst = 0;
+    for (const auto& insertion : insertions) {
+        std::memcpy(data.get() + dst, base + src, insertion.offset - src);
+        dst += insertion.offset - src;
+        src = insertion.offset;
+
+        // pointers relative to the mesh, see Mesh::makePointersRelative()
+        const std::size_t mesh_offset = insertion.mesh_offset + dst - src;
+        Mesh* mesh = reinterpret_cast<Mesh*>(data.get() + mesh_offset);
+        const auto& mesh_data = derived[insertion.mesh];
+        mesh->num_meshlets = static_cast<std::uint32_t>(mesh_data.meshlets.size());
+        mesh->num_lods = static_cast<std::uint32_t>(mesh_data.lods.size());
+        mesh->num_lod_indices = static_cast<std::uint32_t>(mesh_data.lod_indices.size());
+        mesh->geometry_hash = geometry_hashes[insertion.mesh];
+        mesh->meshlets = copyArray<Meshlet>(data.get(), dst, mesh_offset, mesh_data.meshlets);
+        mesh->lods = copyArray<MeshLod>(data.get(), dst, mesh_offset, mesh_data.lods);
+        mesh->lod_indices = copyArray<std::uint32_t>(data.get(), dst, mesh_offset,
+                mesh_data.lod_indices);
+    }
+    std::memcpy(data.get() + dst, base + src, scene->size - src);
+    scene->makePointersAbsolute();
+
+    Scene* result = reinterpret_cast<Scene*>(data.get());
+    result->size = static_cast<std::uint32_t>(size);
+    relocate(data.get(), result->materials, result->num_materials, shift);
+    relocate(data.get(), result->meshes, result->num_meshes, shift);
+    relocate(data.get(), result->lights, result->num_lights, shift);
+    relocate(data.get(), result->textures, result->num_textures, shift);
+    relocate(data.get(), result->cameras, result->num_cameras, shift);
+    relocate(data.get(), result->nodes, result->num_nodes, shift);
+    result->makePointersAbsolute();
+    data.release();
+
+    const std::chrono::duration<double, std::milli> time =
+        std::chrono::steady_clock::now() - start;
+    LOG_INFO(logtag::Import, "Built ", num_meshlets, " meshlets (",
+            static_cast<double>(num_triangles) /
+                static_cast<double>(std::max<std::size_t>(num_meshlets, 1)),
+            " triangles each) and ", num_lods, " LODs (", num_lod_triangles, " of ",
+            num_triangles, " triangles) for ", result->num_meshes, " meshes of ",
+            result->name, " in ", time.count(), " ms");
+
+    return ScenePtr(result);
 }
 
 /***************************************************************************/
 
-void writeDataToCache(const Scene* data, const std::string& scenefile)
+// all or nothing: returns false, if any texture fails to load
+bool loadTextures(Scene* const scene, const path& parent_dir)
 {
-    path file = vars.cache_dir / path(scenefile);
-
-    if (exists(file) == false) {
-        create_directories(file.parent_path());
-    } else if (!is_regular_file(file)) {
-        return;
+    const auto start = std::chrono::steady_clock::now();
+
+    // normal maps are compressed differently
+    std::vector<bool> normal_maps(scene->num_textures, false);
+    for (unsigned int i = 0; i < scene->num_materials; ++i) {
+        const auto* mat = scene->materials[i];
+        if (mat->hasNormalTexture())
+            normal_maps[static_cast<std::size_t>(mat->normal_texture)] = true;
     }
 
-    std::ofstream os(file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-    if (!os) {
-        return;
+    std::vector<std::string> filenames;
+    std::vector<std::future<LoadedTexture>> decodes;
+    filenames.reserve(scene->num_textures);
+    decodes.reserve(scene->num_textures);
+    for (unsigned int i = 0; i < scene->num_textures; ++i) {
+        filenames.emplace_back((parent_dir / scene->textures[i]->name).string<std::string>());
+        const std::string& filename = filenames.back();
+        const bool normal_map = normal_maps[i];
+        decodes.emplace_back(workerPool().submit([filename, normal_map] () {
+                    return loadTexture(filename, normal_map);
+                }));
     }
 
-    FileHeader header;
-    std::memcpy(header.header, HEADER_STRING, sizeof(HEADER_STRING) - 1);
-    header.version = VERSION;
+    // wait for everything before giving up, tasks may still be running
+    std::vector<LoadedTexture> textures(scene->num_textures);
+    bool success = true;
+    for (unsigned int i = 0; i < scene->num_textures; ++i) {
+        try {
+            textures[i] = decodes[i].get();
+        } catch (const std::exception& e) {
+            LOG_ERROR(logtag::Import, "Failed to load texture ", filenames[i], ": ", e.what());
+            success = false;
+        }
+    }
+    if (!success)
+        return false;
+
+    std::size_t slowest = 0;
+    unsigned int num_cached = 0;
+    for (unsigned int i = 0; i < scene->num_textures; ++i) {
+        const auto& level = textures[i].data->levels[0];
+        LOG_INFO(logtag::Import, (textures[i].cached ? "Loaded cached " : "Decoded "),
+                filenames[i], " (", level.width, 'x', level.height, ", ",
+                textures[i].data->levels.size(), " levels, ",
+                blockFormatName(textures[i].data->compression), ") in ",
+                textures[i].time, " ms");
+        if (textures[i].time > textures[slowest].time)
+            slowest = i;
+        if (textures[i].cached)
+            ++num_cached;
+        scene->textures[i]->data = textures[i].data.release();
+    }
 
-    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
-    os.write(reinterpret_cast<const char*>(data), data->size);
+    if (scene->num_textures > 0) {
+        const std::chrono::duration<double, std::milli> time =
+            std::chrono::steady_clock::now() - start;
+        LOG_INFO(logtag::Import, "Loaded ", scene->num_textures, " textures (",
+                num_cached, " cached) of ", scene->name, " in ", time.count(), " ms on ",
+                workerPool().size(), " threads, slowest: ", filenames[slowest],
+                " (", textures[slowest].time, " ms)");
+    }
 
-    os.close();
+    return true;
 }
 
 /***************************************************************************/
@@ -127,36 +437,33 @@ void writeDataToCache(const Scene* data, const std::string& scenefile)
 
 /***************************************************************************/
 
-std::unique_ptr<Scene> importSceneFile(const std::string& filename)
+ScenePtr importSceneFile(const std::string& filename)
 {
     if (!exists(filename)) {
         LOG_ERROR(logtag::Import, "File not found: ", filename);
         return nullptr;
     }
 
-    std::unique_ptr<Scene> result = getCachedData(filename);
+    ScenePtr result = loadSceneCache(filename, workerPool());
     if (!result) {
-        result = assimport(filename);
+        const auto import_start = std::chrono::steady_clock::now();
+        const bool glb = vars.glb_importer && isGlbFile(filename);
+        result = glb ? glbImport(filename) : assimport(filename);
         if (!result)
             return result;
+        const std::chrono::duration<double, std::milli> import_time =
+            std::chrono::steady_clock::now() - import_start;
+        LOG_INFO(logtag::Import, "Imported ", filename, (glb ? " natively" : " with Assimp"),
+                " in ", import_time.count(), " ms");
+
+        if (vars.mesh_optimization)
+            optimizeMeshes(result.get());
+        result = addDerivedData(std::move(result));
+        writeSceneCache(result.get(), filename, workerPool());
+    }
 
-        result->makePointersRelative();
-        writeDataToCache(result.get(), filename);
-        result->makePointersAbsolute();
-    } else {
-        result->makePointersAbsolute();
-    }
-
-    path parent_dir = path(filename).parent_path();
-    for (unsigned int i = 0; i < result->num_textures; ++i) {
-        path img_path = parent_dir / result->textures[i]->name;
-        Image* img = new Image(img_path.string<std::string>());
-        if (!(*img)) {
-            delete img;
-            result.reset();
-            break;
-        }
-        result->textures[i]->image = img;
+    if (!loadTextures(result.get(), path(filename).parent_path())) {
+        result.reset();
     }
 
     return result;
@@ -12,12 +12,13 @@
 #include "node.h"
 #include "scene.h"
 #include "texture.h"
+#include "texture_data.h"
 
 namespace import
 {
 
 
-std::unique_ptr<Scene> importSceneFile(const std::string& filename);
+ScenePtr importSceneFile(const std::string& filename);
 
 } // namespace import
 
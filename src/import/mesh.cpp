@@ -1,4 +1,5 @@
 #include "mesh.h"
+#include "util/hash.h"
 
 namespace import
 {
@@ -49,6 +50,21 @@ void Mesh::makePointersRelative()
         pos = reinterpret_cast<const char*>(texcoords);
         texcoords = reinterpret_cast<glm::vec2*>(pos - offset);
     }
+
+    if (meshlets != nullptr) {
+        pos = reinterpret_cast<const char*>(meshlets);
+        meshlets = reinterpret_cast<Meshlet*>(pos - offset);
+    }
+
+    if (lods != nullptr) {
+        pos = reinterpret_cast<const char*>(lods);
+        lods = reinterpret_cast<MeshLod*>(pos - offset);
+    }
+
+    if (lod_indices != nullptr) {
+        pos = reinterpret_cast<const char*>(lod_indices);
+        lod_indices = reinterpret_cast<std::uint32_t*>(pos - offset);
+    }
 }
 
 /****************************************************************************/
@@ -97,6 +113,50 @@ void Mesh::makePointersAbsolute()
         pos = reinterpret_cast<std::size_t>(texcoords);
         texcoords = reinterpret_cast<glm::vec2*>(offset + pos);
     }
+
+    if (meshlets != nullptr) {
+        pos = reinterpret_cast<std::size_t>(meshlets);
+        meshlets = reinterpret_cast<Meshlet*>(offset + pos);
+    }
+
+    if (lods != nullptr) {
+        pos = reinterpret_cast<std::size_t>(lods);
+        lods = reinterpret_cast<MeshLod*>(offset + pos);
+    }
+
+    if (lod_indices != nullptr) {
+        pos = reinterpret_cast<std::size_t>(lod_indices);
+        lod_indices = reinterpret_cast<std::uint32_t*>(offset + pos);
+    }
+}
+
+/****************************************************************************/
+
+// Meshlets and LODs are built from the triangles, they don't need to be hashed
+std::uint64_t Mesh::hashGeometry() const noexcept
+{
+    util::Hasher hasher;
+    hasher.update(num_vertices);
+    hasher.update(num_indices);
+    const unsigned char components[5] = {
+        hasNormals(), hasTangents(), hasBitangents(), hasTexCoords(), hasVertexColors()
+    };
+    hasher.update(components);
+
+    hasher.update(indices, num_indices * sizeof(std::uint32_t));
+    hasher.update(vertices, num_vertices * sizeof(glm::vec3));
+    if (hasNormals())
+        hasher.update(normals, num_vertices * sizeof(glm::vec3));
+    if (hasTangents())
+        hasher.update(tangents, num_vertices * sizeof(glm::vec3));
+    if (hasBitangents())
+        hasher.update(bitangents, num_vertices * sizeof(glm::vec3));
+    if (hasVertexColors())
+        hasher.update(vertex_colors, num_vertices * sizeof(glm::vec3));
+    if (hasTexCoords())
+        hasher.update(texcoords, num_vertices * sizeof(glm::vec2));
+
+    return hasher.digest();
 }
 
 /****************************************************************************/
@@ -9,13 +9,39 @@
 namespace import
 {
 
+// A cluster of up to MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES
+// triangles, see buildMeshlets(). The triangles are a contiguous range of the
+// mesh's index buffer.
+struct Meshlet
+{
+    glm::vec3       center;         // bounding sphere
+    float           radius;
+    glm::vec3       cone_axis;      // normal cone
+    float           cone_cutoff;    // sine of the cone angle, 1 if the cone is useless
+    std::uint32_t   first_index;
+    std::uint32_t   num_indices;
+};
+
+// Simplified triangle list of a mesh, see buildLods()
+struct MeshLod
+{
+    float           error;          // object space distance to the original surface
+    std::uint32_t   first_index;    // into Mesh::lod_indices
+    std::uint32_t   num_indices;
+};
+
 struct Mesh
 {
-    static constexpr int VERSION = 3;
+    static constexpr int VERSION = 6;
 
     void makePointersRelative();
     void makePointersAbsolute();
 
+    // Hash of everything that ends up in the vertex buffer, identical
+    // geometry shares one allocation in core::MeshManager. Computed by
+    // import::addDerivedData() and stored in geometry_hash.
+    std::uint64_t hashGeometry() const noexcept;
+
     const char*     name;
     std::uint32_t*  indices;
     glm::vec3*      vertices;
@@ -24,10 +50,17 @@ struct Mesh
     glm::vec3*      bitangents;
     glm::vec3*      vertex_colors;
     glm::vec2*      texcoords;
+    Meshlet*        meshlets;
+    MeshLod*        lods;           // ordered by decreasing detail
+    std::uint32_t*  lod_indices;
     core::AABB      bbox;
+    std::uint64_t   geometry_hash;
     std::uint32_t   material_index;
     std::uint32_t   num_vertices;
     std::uint32_t   num_indices;
+    std::uint32_t   num_meshlets;
+    std::uint32_t   num_lods;
+    std::uint32_t   num_lod_indices;
 
     bool hasNormals() const noexcept
     {
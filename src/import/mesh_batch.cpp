@@ -0,0 +1,115 @@
+#include <utility>
+
+#include "mesh_batch.h"
+
+namespace import
+{
+
+/***************************************************************************/
+
+std::uint32_t vertexLayout(const Mesh* mesh) noexcept
+{
+    return (mesh->hasNormals() ? 1u : 0u) |
+        (mesh->hasTangents() ? 2u : 0u) |
+        (mesh->hasBitangents() ? 4u : 0u) |
+        (mesh->hasTexCoords() ? 8u : 0u) |
+        (mesh->hasVertexColors() ? 16u : 0u);
+}
+
+/***************************************************************************/
+
+MeshBatch::MeshBatch(std::string name)
+  : m_name{std::move(name)},
+    m_layout{0},
+    m_mesh()
+{
+}
+
+/***************************************************************************/
+
+bool MeshBatch::add(const Mesh* mesh, const glm::mat4& transformation)
+{
+    if (m_parts.empty()) {
+        m_layout = vertexLayout(mesh);
+    } else if (vertexLayout(mesh) != m_layout) {
+        return false;
+    }
+    const auto first_vertex = static_cast<std::uint32_t>(m_vertices.size());
+    if (first_vertex + mesh->num_vertices > MAX_BATCH_VERTICES)
+        return false;
+
+    m_parts.push_back(Part{mesh->bbox.transformed(transformation),
+            static_cast<std::uint32_t>(m_indices.size()), mesh->num_indices});
+    for (std::uint32_t i = 0; i < mesh->num_indices; ++i) {
+        m_indices.push_back(first_vertex + mesh->indices[i]);
+    }
+
+    // directions are renormalized, the transformation may scale
+    const glm::mat3 tangent_matrix(transformation);
+    const glm::mat3 normal_matrix = glm::transpose(glm::inverse(tangent_matrix));
+    for (std::uint32_t i = 0; i < mesh->num_vertices; ++i) {
+        m_vertices.emplace_back(transformation * glm::vec4(mesh->vertices[i], 1.f));
+        if (mesh->hasNormals())
+            m_normals.push_back(glm::normalize(normal_matrix * mesh->normals[i]));
+        if (mesh->hasTangents())
+            m_tangents.push_back(glm::normalize(tangent_matrix * mesh->tangents[i]));
+        if (mesh->hasBitangents())
+            m_bitangents.push_back(glm::normalize(tangent_matrix * mesh->bitangents[i]));
+        if (mesh->hasVertexColors())
+            m_vertex_colors.push_back(mesh->vertex_colors[i]);
+        if (mesh->hasTexCoords())
+            m_texcoords.push_back(mesh->texcoords[i]);
+    }
+    if (m_parts.size() == 1)
+        m_mesh.material_index = mesh->material_index;
+
+    return true;
+}
+
+/***************************************************************************/
+
+const Mesh* MeshBatch::getMesh()
+{
+    m_mesh.name = m_name.c_str();
+    m_mesh.indices = m_indices.data();
+    m_mesh.vertices = m_vertices.data();
+    m_mesh.normals = m_normals.empty() ? nullptr : m_normals.data();
+    m_mesh.tangents = m_tangents.empty() ? nullptr : m_tangents.data();
+    m_mesh.bitangents = m_bitangents.empty() ? nullptr : m_bitangents.data();
+    m_mesh.vertex_colors = m_vertex_colors.empty() ? nullptr : m_vertex_colors.data();
+    m_mesh.texcoords = m_texcoords.empty() ? nullptr : m_texcoords.data();
+    m_mesh.meshlets = nullptr;
+    m_mesh.lods = nullptr;
+    m_mesh.lod_indices = nullptr;
+    m_mesh.num_vertices = static_cast<std::uint32_t>(m_vertices.size());
+    m_mesh.num_indices = static_cast<std::uint32_t>(m_indices.size());
+    m_mesh.num_meshlets = 0;
+    m_mesh.num_lods = 0;
+    m_mesh.num_lod_indices = 0;
+
+    m_mesh.bbox = core::AABB();
+    for (const auto& part : m_parts) {
+        m_mesh.bbox.expandBy(part.bbox);
+    }
+    m_mesh.geometry_hash = m_mesh.hashGeometry();
+
+    return &m_mesh;
+}
+
+/***************************************************************************/
+
+const std::vector<MeshBatch::Part>& MeshBatch::getParts() const
+{
+    return m_parts;
+}
+
+/***************************************************************************/
+
+std::uint32_t MeshBatch::getNumVertices() const
+{
+    return static_cast<std::uint32_t>(m_vertices.size());
+}
+
+/***************************************************************************/
+
+} // namespace import
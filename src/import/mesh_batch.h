@@ -0,0 +1,60 @@
+#ifndef IMPORT_MESH_BATCH_H
+#define IMPORT_MESH_BATCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "mesh.h"
+
+namespace import
+{
+
+// 16 bit indices
+constexpr std::uint32_t MAX_BATCH_VERTICES = 65535;
+
+// Vertex attributes of a mesh, only meshes with the same layout can be batched
+std::uint32_t vertexLayout(const Mesh* mesh) noexcept;
+
+// Merges static meshes into one, transformed into a common space (usually
+// world space). Every added mesh is a part with its own bounding box and
+// range of indices, so parts can still be culled separately. LODs and
+// meshlets are dropped.
+class MeshBatch
+{
+public:
+    struct Part
+    {
+        core::AABB      bbox;
+        std::uint32_t   first_index;
+        std::uint32_t   num_indices;
+    };
+
+    explicit MeshBatch(std::string name);
+
+    // false, if the mesh would exceed MAX_BATCH_VERTICES or has another layout
+    bool add(const Mesh* mesh, const glm::mat4& transformation);
+
+    // valid until the next add()
+    const Mesh* getMesh();
+    const std::vector<Part>& getParts() const;
+    std::uint32_t getNumVertices() const;
+
+private:
+    std::string                 m_name;
+    std::uint32_t               m_layout;
+    Mesh                        m_mesh;
+    std::vector<Part>           m_parts;
+    std::vector<std::uint32_t>  m_indices;
+    std::vector<glm::vec3>      m_vertices;
+    std::vector<glm::vec3>      m_normals;
+    std::vector<glm::vec3>      m_tangents;
+    std::vector<glm::vec3>      m_bitangents;
+    std::vector<glm::vec3>      m_vertex_colors;
+    std::vector<glm::vec2>      m_texcoords;
+};
+
+} // namespace import
+
+#endif // IMPORT_MESH_BATCH_H
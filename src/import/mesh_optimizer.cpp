@@ -0,0 +1,451 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "mesh_optimizer.h"
+#include "mesh.h"
+
+namespace import
+{
+namespace
+{
+
+/***************************************************************************/
+
+constexpr std::size_t FORSYTH_CACHE_SIZE = 32;
+constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+constexpr float FORSYTH_LAST_TRI_SCORE = .75f;
+constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.f;
+constexpr float FORSYTH_VALENCE_BOOST_POWER = .5f;
+
+/***************************************************************************/
+
+float vertexScore(const int cache_pos, const std::uint32_t remaining)
+{
+    if (remaining == 0)
+        return -1.f;
+
+    float score = 0.f;
+    if (cache_pos >= 0) {
+        if (cache_pos < 3) {
+            // the vertices of the last triangle
+            score = FORSYTH_LAST_TRI_SCORE;
+        } else {
+            const float scale = 1.f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.f - static_cast<float>(cache_pos - 3) * scale,
+                    FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+    // boost vertices with few triangles left, to get rid of lone triangles
+    score += FORSYTH_VALENCE_BOOST_SCALE *
+        std::pow(static_cast<float>(remaining), -FORSYTH_VALENCE_BOOST_POWER);
+    return score;
+}
+
+/***************************************************************************/
+
+template <typename T>
+void permute(T* const data, const std::vector<std::uint32_t>& remap)
+{
+    if (data == nullptr)
+        return;
+    const std::vector<T> copy(data, data + remap.size());
+    for (std::size_t v = 0; v < remap.size(); ++v) {
+        data[remap[v]] = copy[v];
+    }
+}
+
+/***************************************************************************/
+
+// Ritter's bounding sphere of the vertices and the normal cone of the triangles
+void computeBounds(const Mesh* const mesh, const std::vector<std::uint32_t>& vertices,
+        Meshlet& meshlet)
+{
+    const glm::vec3* const positions = mesh->vertices;
+
+    // initial sphere: the extreme points along the axis of largest extent
+    std::uint32_t pmin[3] = {vertices[0], vertices[0], vertices[0]};
+    std::uint32_t pmax[3] = {vertices[0], vertices[0], vertices[0]};
+    for (const auto v : vertices) {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (positions[v][axis] < positions[pmin[axis]][axis])
+                pmin[axis] = v;
+            if (positions[v][axis] > positions[pmax[axis]][axis])
+                pmax[axis] = v;
+        }
+    }
+    int axis = 0;
+    float max_distance = -1.f;
+    for (int a = 0; a < 3; ++a) {
+        const glm::vec3 d = positions[pmax[a]] - positions[pmin[a]];
+        if (glm::dot(d, d) > max_distance) {
+            max_distance = glm::dot(d, d);
+            axis = a;
+        }
+    }
+    glm::vec3 center = (positions[pmin[axis]] + positions[pmax[axis]]) * .5f;
+    float radius = glm::length(positions[pmax[axis]] - positions[pmin[axis]]) * .5f;
+    for (const auto v : vertices) {
+        const float d = glm::length(positions[v] - center);
+        if (d > radius) {
+            const float r = (radius + d) * .5f;
+            center += (positions[v] - center) * ((r - radius) / d);
+            radius = r;
+        }
+    }
+    meshlet.center = center;
+    meshlet.radius = radius;
+
+    const std::uint32_t* const first = mesh->indices + meshlet.first_index;
+    const std::uint32_t* const last = first + meshlet.num_indices;
+    glm::vec3 cone_axis(0.f);
+    for (const auto* tri = first; tri != last; tri += 3) {
+        const glm::vec3 n = glm::cross(positions[tri[1]] - positions[tri[0]],
+                positions[tri[2]] - positions[tri[0]]);
+        const float len = glm::length(n);
+        if (len > 0.f)
+            cone_axis += n / len;
+    }
+    const float axis_length = glm::length(cone_axis);
+    meshlet.cone_axis = axis_length > 0.f ? cone_axis / axis_length : glm::vec3(0.f, 0.f, 1.f);
+    meshlet.cone_cutoff = 1.f;
+    if (axis_length == 0.f)
+        return;
+
+    float min_dp = 1.f;
+    for (const auto* tri = first; tri != last; tri += 3) {
+        const glm::vec3 n = glm::cross(positions[tri[1]] - positions[tri[0]],
+                positions[tri[2]] - positions[tri[0]]);
+        const float len = glm::length(n);
+        if (len > 0.f)
+            min_dp = std::min(min_dp, glm::dot(n / len, meshlet.cone_axis));
+    }
+    // a cone wider than a hemisphere can't be used for culling
+    if (min_dp > 0.f)
+        meshlet.cone_cutoff = std::sqrt(1.f - min_dp * min_dp);
+}
+
+/***************************************************************************/
+
+} // anonymous namespace
+
+/***************************************************************************/
+
+float VertexCacheStats::acmr() const noexcept
+{
+    return num_triangles == 0 ? 0.f :
+        static_cast<float>(num_transformed) / static_cast<float>(num_triangles);
+}
+
+/***************************************************************************/
+
+float VertexCacheStats::atvr() const noexcept
+{
+    return num_vertices == 0 ? 0.f :
+        static_cast<float>(num_transformed) / static_cast<float>(num_vertices);
+}
+
+/***************************************************************************/
+
+VertexCacheStats analyzeVertexCache(const std::uint32_t* const indices,
+        const std::size_t num_indices, const std::size_t num_vertices,
+        const std::size_t cache_size)
+{
+    VertexCacheStats stats;
+    stats.num_triangles = num_indices / 3;
+    stats.num_vertices = num_vertices;
+    stats.num_transformed = 0;
+
+    // a vertex is cached, if it entered the FIFO less than cache_size misses ago
+    std::vector<std::size_t> timestamps(num_vertices, 0);
+    std::size_t time = cache_size + 1;
+    for (std::size_t i = 0; i < num_indices; ++i) {
+        auto& timestamp = timestamps[indices[i]];
+        if (time - timestamp > cache_size) {
+            timestamp = time++;
+            ++stats.num_transformed;
+        }
+    }
+    return stats;
+}
+
+/***************************************************************************/
+
+void optimizeVertexCache(std::uint32_t* const indices, const std::size_t num_indices,
+        const std::size_t num_vertices)
+{
+    const std::size_t num_triangles = num_indices / 3;
+    if (num_triangles == 0)
+        return;
+
+    // triangles per vertex
+    std::vector<std::uint32_t> offsets(num_vertices + 1, 0);
+    for (std::size_t i = 0; i < num_indices; ++i) {
+        ++offsets[indices[i] + 1];
+    }
+    for (std::size_t v = 0; v < num_vertices; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<std::uint32_t> remaining(num_vertices);
+    for (std::size_t v = 0; v < num_vertices; ++v) {
+        remaining[v] = offsets[v + 1] - offsets[v];
+    }
+    std::vector<std::uint32_t> adjacency(num_indices);
+    {
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < num_indices; ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int> cache_pos(num_vertices, -1);
+    std::vector<float> vertex_scores(num_vertices);
+    for (std::size_t v = 0; v < num_vertices; ++v) {
+        vertex_scores[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangle_scores(num_triangles);
+    for (std::size_t t = 0; t < num_triangles; ++t) {
+        triangle_scores[t] = vertex_scores[indices[3 * t]] +
+            vertex_scores[indices[3 * t + 1]] + vertex_scores[indices[3 * t + 2]];
+    }
+
+    std::vector<bool> emitted(num_triangles, false);
+    std::vector<std::uint32_t> result;
+    result.reserve(num_triangles * 3);
+
+    // three more entries for the vertices of the triangle being added
+    std::vector<std::uint32_t> cache;
+    std::vector<std::uint32_t> new_cache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    new_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    std::size_t next_unemitted = 0;
+    std::size_t best = std::numeric_limits<std::size_t>::max();
+    for (std::size_t n = 0; n < num_triangles; ++n) {
+        if (best == std::numeric_limits<std::size_t>::max()) {
+            // nothing in the cache is connected to an open triangle
+            while (emitted[next_unemitted])
+                ++next_unemitted;
+            best = next_unemitted;
+        }
+
+        emitted[best] = true;
+        const std::uint32_t* tri = indices + 3 * best;
+        result.insert(result.end(), tri, tri + 3);
+
+        // LRU update, the new triangle goes to the front
+        new_cache.assign(tri, tri + 3);
+        for (const auto v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                new_cache.push_back(v);
+        }
+        for (int i = 0; i < 3; ++i) {
+            const auto v = tri[i];
+            --remaining[v];
+            // remove the triangle from the vertex's open triangles
+            auto* first = adjacency.data() + offsets[v];
+            auto* last = first + remaining[v] + 1;
+            *std::find(first, last, static_cast<std::uint32_t>(best)) = *(last - 1);
+        }
+
+        for (std::size_t i = 0; i < new_cache.size(); ++i) {
+            const auto v = new_cache[i];
+            cache_pos[v] = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+            const float score = vertexScore(cache_pos[v], remaining[v]);
+            const float delta = score - vertex_scores[v];
+            vertex_scores[v] = score;
+            for (std::uint32_t j = offsets[v]; j < offsets[v] + remaining[v]; ++j) {
+                triangle_scores[adjacency[j]] += delta;
+            }
+        }
+        if (new_cache.size() > FORSYTH_CACHE_SIZE)
+            new_cache.resize(FORSYTH_CACHE_SIZE);
+        std::swap(cache, new_cache);
+
+        // next triangle: the best one that uses a cached vertex
+        best = std::numeric_limits<std::size_t>::max();
+        float best_score = -1.f;
+        for (const auto v : cache) {
+            for (std::uint32_t j = offsets[v]; j < offsets[v] + remaining[v]; ++j) {
+                const auto t = adjacency[j];
+                if (triangle_scores[t] > best_score) {
+                    best_score = triangle_scores[t];
+                    best = t;
+                }
+            }
+        }
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+}
+
+/***************************************************************************/
+
+void optimizeOverdraw(std::uint32_t* const indices, const std::size_t num_indices,
+        const glm::vec3* const positions, const std::size_t num_vertices)
+{
+    const std::size_t num_triangles = num_indices / 3;
+    if (num_triangles == 0)
+        return;
+
+    // hard boundaries: triangles that miss the cache with every vertex
+    std::vector<std::size_t> clusters;
+    {
+        constexpr std::size_t cache_size = 16;
+        std::vector<std::size_t> timestamps(num_vertices, 0);
+        std::size_t time = cache_size + 1;
+        for (std::size_t t = 0; t < num_triangles; ++t) {
+            int misses = 0;
+            for (std::size_t i = 0; i < 3; ++i) {
+                auto& timestamp = timestamps[indices[3 * t + i]];
+                if (time - timestamp > cache_size) {
+                    timestamp = time++;
+                    ++misses;
+                }
+            }
+            if (misses == 3 || t == 0)
+                clusters.push_back(t);
+        }
+    }
+    clusters.push_back(num_triangles);
+    const std::size_t num_clusters = clusters.size() - 1;
+    if (num_clusters < 2)
+        return;
+
+    glm::vec3 mesh_center(0.f);
+    float mesh_area = 0.f;
+    std::vector<glm::vec3> centers(num_clusters, glm::vec3(0.f));
+    std::vector<glm::vec3> normals(num_clusters, glm::vec3(0.f));
+    for (std::size_t c = 0; c < num_clusters; ++c) {
+        float area = 0.f;
+        for (std::size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const glm::vec3& p0 = positions[indices[3 * t]];
+            const glm::vec3& p1 = positions[indices[3 * t + 1]];
+            const glm::vec3& p2 = positions[indices[3 * t + 2]];
+            const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            const float a = glm::length(n);
+            centers[c] += (p0 + p1 + p2) * (a / 3.f);
+            normals[c] += n;
+            area += a;
+        }
+        mesh_center += centers[c];
+        mesh_area += area;
+        if (area > 0.f)
+            centers[c] /= area;
+    }
+    if (mesh_area > 0.f)
+        mesh_center /= mesh_area;
+
+    // clusters facing away from the center are drawn first
+    std::vector<float> sort_keys(num_clusters);
+    std::vector<std::size_t> order(num_clusters);
+    for (std::size_t c = 0; c < num_clusters; ++c) {
+        const float len = glm::length(normals[c]);
+        sort_keys[c] = len > 0.f ? glm::dot(centers[c] - mesh_center, normals[c] / len) : 0.f;
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(),
+            [&sort_keys] (const std::size_t c0, const std::size_t c1) -> bool
+            {
+                return sort_keys[c0] > sort_keys[c1];
+            });
+
+    std::vector<std::uint32_t> result;
+    result.reserve(num_indices);
+    for (const auto c : order) {
+        result.insert(result.end(), indices + 3 * clusters[c], indices + 3 * clusters[c + 1]);
+    }
+    std::copy(result.begin(), result.end(), indices);
+}
+
+/***************************************************************************/
+
+void optimizeVertexFetch(Mesh* const mesh)
+{
+    constexpr std::uint32_t UNUSED = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<std::uint32_t> remap(mesh->num_vertices, UNUSED);
+    std::uint32_t next = 0;
+    for (std::uint32_t i = 0; i < mesh->num_indices; ++i) {
+        auto& idx = mesh->indices[i];
+        if (remap[idx] == UNUSED)
+            remap[idx] = next++;
+        idx = remap[idx];
+    }
+    // unreferenced vertices go to the end, the mesh keeps its size
+    for (auto& r : remap) {
+        if (r == UNUSED)
+            r = next++;
+    }
+
+    permute(mesh->vertices, remap);
+    permute(mesh->normals, remap);
+    permute(mesh->tangents, remap);
+    permute(mesh->bitangents, remap);
+    permute(mesh->vertex_colors, remap);
+    permute(mesh->texcoords, remap);
+}
+
+/***************************************************************************/
+
+void optimizeMesh(Mesh* const mesh)
+{
+    optimizeVertexCache(mesh->indices, mesh->num_indices, mesh->num_vertices);
+    optimizeOverdraw(mesh->indices, mesh->num_indices, mesh->vertices, mesh->num_vertices);
+    optimizeVertexFetch(mesh);
+}
+
+/***************************************************************************/
+
+void buildMeshlets(const Mesh* const mesh, std::vector<Meshlet>& meshlets)
+{
+    constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    meshlets.clear();
+    meshlets.reserve(mesh->num_indices / (3 * MESHLET_MAX_TRIANGLES) + 1);
+
+    // the meshlet a vertex was last added to
+    std::vector<std::uint32_t> owner(mesh->num_vertices, NONE);
+    std::vector<std::uint32_t> vertices;
+    vertices.reserve(MESHLET_MAX_VERTICES);
+
+    Meshlet current;
+    current.first_index = 0;
+    current.num_indices = 0;
+    for (std::uint32_t i = 0; i + 2 < mesh->num_indices; i += 3) {
+        const std::uint32_t* tri = mesh->indices + i;
+        auto id = static_cast<std::uint32_t>(meshlets.size());
+
+        std::size_t new_vertices = 0;
+        for (int j = 0; j < 3; ++j) {
+            if (owner[tri[j]] != id)
+                ++new_vertices;
+        }
+        if (vertices.size() + new_vertices > MESHLET_MAX_VERTICES ||
+                current.num_indices == 3 * MESHLET_MAX_TRIANGLES) {
+            computeBounds(mesh, vertices, current);
+            meshlets.push_back(current);
+            current.first_index = i;
+            current.num_indices = 0;
+            vertices.clear();
+            ++id;
+        }
+
+        for (int j = 0; j < 3; ++j) {
+            if (owner[tri[j]] != id) {
+                owner[tri[j]] = id;
+                vertices.push_back(tri[j]);
+            }
+        }
+        current.num_indices += 3;
+    }
+    if (current.num_indices > 0) {
+        computeBounds(mesh, vertices, current);
+        meshlets.push_back(current);
+    }
+}
+
+/***************************************************************************/
+
+} // namespace import
@@ -0,0 +1,59 @@
+#ifndef IMPORT_MESH_OPTIMIZER_H
+#define IMPORT_MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace import
+{
+
+struct Mesh;
+struct Meshlet;
+
+constexpr int MESH_OPTIMIZER_VERSION = 2;
+
+constexpr std::uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr std::uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+struct VertexCacheStats
+{
+    std::size_t num_triangles;
+    std::size_t num_vertices;
+    std::size_t num_transformed;    // cache misses
+
+    float acmr() const noexcept;    // misses per triangle
+    float atvr() const noexcept;    // misses per vertex
+};
+
+// simulates a FIFO post-transform cache
+VertexCacheStats analyzeVertexCache(const std::uint32_t* indices, std::size_t num_indices,
+        std::size_t num_vertices, std::size_t cache_size = 16);
+
+// Forsyth, "Linear-Speed Vertex Cache Optimisation"
+void optimizeVertexCache(std::uint32_t* indices, std::size_t num_indices,
+        std::size_t num_vertices);
+
+// Reorders clusters of the (cache optimized) triangle list, so that triangles
+// on the outside are drawn first. Clusters start wherever the simulated cache
+// had to be refilled, so the ACMR stays the same.
+void optimizeOverdraw(std::uint32_t* indices, std::size_t num_indices,
+        const glm::vec3* positions, std::size_t num_vertices);
+
+// Renumbers the vertices in the order they are referenced, all vertex
+// attributes are permuted accordingly.
+void optimizeVertexFetch(Mesh* mesh);
+
+// all of the above, in that order
+void optimizeMesh(Mesh* mesh);
+
+// Splits the triangle list into meshlets without reordering it, a meshlet
+// ends when the next triangle would exceed one of the limits. Should be run
+// after optimizeMesh(), so that consecutive triangles are close together.
+void buildMeshlets(const Mesh* mesh, std::vector<Meshlet>& meshlets);
+
+} // namespace import
+
+#endif // IMPORT_MESH_OPTIMIZER_H
@@ -0,0 +1,543 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "mesh_simplifier.h"
+#include "mesh_optimizer.h"
+#include "mesh.h"
+
+namespace import
+{
+namespace
+{
+
+/***************************************************************************/
+
+// stop, once a collapse moves the surface further than this (relative to the bbox)
+constexpr float MAX_LOD_ERROR = .1f;
+
+// a LOD has to get rid of at least this many triangles of the previous one
+constexpr float MIN_LOD_REDUCTION = .1f;
+
+constexpr std::uint32_t NO_VERTEX = 0xFFFFFFFF;
+
+/***************************************************************************/
+
+// sum of squared distances to planes, weighted by the triangle areas
+struct Quadric
+{
+    double a2, b2, c2, d2;
+    double ab, ac, ad;
+    double bc, bd;
+    double cd;
+    double w;
+
+    Quadric& operator+=(const Quadric& q) noexcept
+    {
+        a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+        ab += q.ab; ac += q.ac; ad += q.ad;
+        bc += q.bc; bd += q.bd;
+        cd += q.cd;
+        w += q.w;
+        return *this;
+    }
+
+    // squared distance, averaged over the planes
+    double error(const glm::vec3& p) const noexcept
+    {
+        const double x = p.x;
+        const double y = p.y;
+        const double z = p.z;
+        const double e = a2 * x * x + b2 * y * y + c2 * z * z +
+            2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+            2.0 * (ad * x + bd * y + cd * z) + d2;
+        return w > 0.0 ? std::max(e / w, 0.0) : 0.0;
+    }
+};
+
+/***************************************************************************/
+
+Quadric planeQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+{
+    Quadric q{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+    const float len = glm::length(n);
+    if (len == 0.f)
+        return q;
+
+    const double area = .5 * static_cast<double>(len);
+    const double a = static_cast<double>(n.x / len);
+    const double b = static_cast<double>(n.y / len);
+    const double c = static_cast<double>(n.z / len);
+    const double d = -(a * static_cast<double>(p0.x) + b * static_cast<double>(p0.y) +
+            c * static_cast<double>(p0.z));
+    q.a2 = area * a * a; q.b2 = area * b * b; q.c2 = area * c * c; q.d2 = area * d * d;
+    q.ab = area * a * b; q.ac = area * a * c; q.ad = area * a * d;
+    q.bc = area * b * c; q.bd = area * b * d;
+    q.cd = area * c * d;
+    q.w = area;
+    return q;
+}
+
+/***************************************************************************/
+
+struct Collapse
+{
+    std::uint32_t   from;
+    std::uint32_t   to;
+    double          error;
+};
+
+/***************************************************************************/
+
+// The vertices sorted by position, each run of equal positions is a group.
+struct Welding
+{
+    std::vector<std::uint32_t>  welded;         // first vertex at the same position
+    std::vector<std::uint32_t>  order;
+    std::vector<std::uint32_t>  group_begin;    // in 'order', per vertex
+    std::vector<std::uint32_t>  group_end;
+};
+
+/***************************************************************************/
+
+// The triangles with every vertex replaced by the first one at the same
+// position, without the ones that become degenerate. Flat shading and
+// UV/normal seams split most vertices of a mesh, welded they don't stop
+// the simplification. Only the connectivity comes from the welded mesh,
+// see splitSeams().
+std::vector<std::uint32_t> weldByPosition(const Mesh* const mesh, Welding& welding)
+{
+    const std::uint32_t num_vertices = mesh->num_vertices;
+    auto& order = welding.order;
+    order.resize(num_vertices);
+    std::iota(order.begin(), order.end(), 0u);
+    const glm::vec3* const positions = mesh->vertices;
+    std::stable_sort(order.begin(), order.end(),
+            [positions] (const std::uint32_t v0, const std::uint32_t v1) -> bool
+            {
+                const auto& p0 = positions[v0];
+                const auto& p1 = positions[v1];
+                if (p0.x != p1.x)
+                    return p0.x < p1.x;
+                if (p0.y != p1.y)
+                    return p0.y < p1.y;
+                return p0.z < p1.z;
+            });
+    auto& welded = welding.welded;
+    welded.resize(num_vertices);
+    welding.group_begin.resize(num_vertices);
+    welding.group_end.resize(num_vertices);
+    for (std::uint32_t i = 0; i < num_vertices; ++i) {
+        const bool same = i > 0 && positions[order[i]] == positions[order[i - 1]];
+        welded[order[i]] = same ? welded[order[i - 1]] : order[i];
+        welding.group_begin[order[i]] = same ? welding.group_begin[order[i - 1]] : i;
+    }
+    for (std::uint32_t i = num_vertices; i > 0; --i) {
+        const bool same = i < num_vertices && positions[order[i - 1]] == positions[order[i]];
+        welding.group_end[order[i - 1]] = same ? welding.group_end[order[i]] : i;
+    }
+
+    std::vector<std::uint32_t> indices;
+    indices.reserve(mesh->num_indices);
+    for (std::uint32_t i = 0; i + 2 < mesh->num_indices; i += 3) {
+        const auto v0 = welded[mesh->indices[i]];
+        const auto v1 = welded[mesh->indices[i + 1]];
+        const auto v2 = welded[mesh->indices[i + 2]];
+        if (v0 == v1 || v0 == v2 || v1 == v2)
+            continue;
+        indices.push_back(v0);
+        indices.push_back(v1);
+        indices.push_back(v2);
+    }
+    return indices;
+}
+
+/***************************************************************************/
+
+// Squared distance from 'texcoord' to the closest texture coordinates of
+// the vertices at the position of 'vertex'.
+float texcoordDistance(const Mesh* const mesh, const Welding& welding,
+        const std::uint32_t vertex, const glm::vec2& texcoord)
+{
+    float result = std::numeric_limits<float>::max();
+    for (auto k = welding.group_begin[vertex]; k < welding.group_end[vertex]; ++k) {
+        const glm::vec2 d = mesh->texcoords[welding.order[k]] - texcoord;
+        result = std::min(result, glm::dot(d, d));
+    }
+    return result;
+}
+
+/***************************************************************************/
+
+// Every corner of the welded triangles takes one of the vertices at its
+// position. The first corner takes the side of a UV seam that the other
+// two are closest to, they follow it; among the vertices on that side the
+// normal closest to the triangle's wins.
+void splitSeams(const Mesh* const mesh, const Welding& welding,
+        std::uint32_t* const indices, const std::size_t num_indices)
+{
+    // texture coordinates closer than this (squared) are on the same side
+    constexpr float TEXCOORD_EPSILON = 1e-8f;
+
+    const glm::vec3* const positions = mesh->vertices;
+    // per vertex of a group
+    std::vector<float> distances;
+    for (std::size_t i = 0; i + 2 < num_indices; i += 3) {
+        std::uint32_t* const tri = indices + i;
+        glm::vec3 n = glm::cross(positions[tri[1]] - positions[tri[0]],
+                positions[tri[2]] - positions[tri[0]]);
+        const float len = glm::length(n);
+        n = len > 0.f ? n / len : n;
+
+        for (std::size_t j = 0; j < 3; ++j) {
+            const auto begin = welding.group_begin[tri[j]];
+            const auto end = welding.group_end[tri[j]];
+
+            distances.assign(end - begin, 0.f);
+            float min_distance = 0.f;
+            if (mesh->hasTexCoords()) {
+                for (auto k = begin; k < end; ++k) {
+                    const auto& texcoord = mesh->texcoords[welding.order[k]];
+                    if (j == 0) {
+                        distances[k - begin] = texcoordDistance(mesh, welding, tri[1], texcoord) +
+                            texcoordDistance(mesh, welding, tri[2], texcoord);
+                    } else {
+                        const glm::vec2 d = texcoord - mesh->texcoords[tri[0]];
+                        distances[k - begin] = glm::dot(d, d);
+                    }
+                }
+                min_distance = *std::min_element(distances.begin(), distances.end());
+            }
+
+            std::uint32_t best = tri[j];
+            float best_dot = -2.f;
+            for (auto k = begin; k < end; ++k) {
+                if (distances[k - begin] > min_distance + TEXCOORD_EPSILON)
+                    continue;
+                const auto v = welding.order[k];
+                float dot = 0.f;
+                if (mesh->hasNormals()) {
+                    const float normal_len = glm::length(mesh->normals[v]);
+                    dot = normal_len > 0.f ? glm::dot(mesh->normals[v], n) / normal_len : -1.f;
+                }
+                if (dot > best_dot) {
+                    best = v;
+                    best_dot = dot;
+                }
+            }
+            tri[j] = best;
+        }
+    }
+}
+
+/***************************************************************************/
+
+// Vertices on open borders must not move.
+std::vector<bool> findLockedVertices(const std::vector<std::uint32_t>& indices,
+        const std::uint32_t num_vertices)
+{
+    std::vector<bool> locked(num_vertices, false);
+
+    // edges without a counterpart in the opposite direction are open
+    std::vector<std::uint64_t> edges;
+    edges.reserve(indices.size());
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            const std::uint64_t v0 = indices[i + j];
+            const std::uint64_t v1 = indices[i + (j + 1) % 3];
+            edges.push_back(v0 << 32 | v1);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for (const auto edge : edges) {
+        const std::uint64_t reverse = edge << 32 | edge >> 32;
+        if (!std::binary_search(edges.begin(), edges.end(), reverse)) {
+            locked[static_cast<std::size_t>(edge >> 32)] = true;
+            locked[static_cast<std::size_t>(edge & 0xFFFFFFFF)] = true;
+        }
+    }
+
+    return locked;
+}
+
+/***************************************************************************/
+
+// Welded edges with different texture coordinates on their two sides are
+// on a UV seam. Returns the two seam neighbours of every vertex (NO_VERTEX
+// if it isn't on a seam), where seams meet or end the vertices are locked.
+std::vector<std::uint32_t> findSeams(const Mesh* const mesh, const Welding& welding,
+        std::vector<bool>& locked)
+{
+    const std::size_t num_vertices = mesh->num_vertices;
+    std::vector<std::uint32_t> seams(2 * num_vertices, NO_VERTEX);
+    if (!mesh->hasTexCoords())
+        return seams;
+
+    struct Edge
+    {
+        std::uint64_t   key;    // welded, smaller vertex first
+        glm::vec2       texcoords[2];
+    };
+    std::vector<Edge> edges;
+    edges.reserve(mesh->num_indices);
+    for (std::uint32_t i = 0; i + 2 < mesh->num_indices; i += 3) {
+        for (std::uint32_t j = 0; j < 3; ++j) {
+            auto v0 = mesh->indices[i + j];
+            auto v1 = mesh->indices[i + (j + 1) % 3];
+            if (welding.welded[v0] == welding.welded[v1])
+                continue;
+            if (welding.welded[v0] > welding.welded[v1])
+                std::swap(v0, v1);
+            edges.push_back(Edge{std::uint64_t(welding.welded[v0]) << 32 | welding.welded[v1],
+                    {mesh->texcoords[v0], mesh->texcoords[v1]}});
+        }
+    }
+    std::sort(edges.begin(), edges.end(),
+            [] (const Edge& e0, const Edge& e1) -> bool
+            {
+                return e0.key < e1.key;
+            });
+
+    std::vector<std::uint32_t> counts(num_vertices, 0);
+    for (std::size_t first = 0, last = 0; first < edges.size(); first = last) {
+        bool seam = false;
+        for (last = first + 1; last < edges.size() && edges[last].key == edges[first].key; ++last) {
+            seam = seam || edges[last].texcoords[0] != edges[first].texcoords[0] ||
+                edges[last].texcoords[1] != edges[first].texcoords[1];
+        }
+        if (!seam)
+            continue;
+        const auto v0 = static_cast<std::uint32_t>(edges[first].key >> 32);
+        const auto v1 = static_cast<std::uint32_t>(edges[first].key & 0xFFFFFFFF);
+        if (counts[v0] < 2)
+            seams[2 * v0 + counts[v0]] = v1;
+        if (counts[v1] < 2)
+            seams[2 * v1 + counts[v1]] = v0;
+        ++counts[v0];
+        ++counts[v1];
+    }
+    for (std::size_t v = 0; v < num_vertices; ++v) {
+        if (counts[v] != 0 && counts[v] != 2)
+            locked[v] = true;
+    }
+
+    return seams;
+}
+
+/***************************************************************************/
+
+// vertices on a seam only move along it
+bool followsSeam(const std::vector<std::uint32_t>& seams, const std::uint32_t from,
+        const std::uint32_t to)
+{
+    return seams[2 * from] == NO_VERTEX || seams[2 * from] == to || seams[2 * from + 1] == to;
+}
+
+/***************************************************************************/
+
+void replaceSeamNeighbour(std::vector<std::uint32_t>& seams, const std::uint32_t vertex,
+        const std::uint32_t neighbour, const std::uint32_t replacement)
+{
+    for (std::size_t i = 2 * vertex; i < 2 * vertex + 2; ++i) {
+        if (seams[i] == neighbour)
+            seams[i] = replacement;
+    }
+}
+
+/***************************************************************************/
+
+// true if moving 'from' onto 'to' turns one of the remaining triangles around
+bool flipsTriangle(const glm::vec3* const positions, const std::uint32_t* const indices,
+        const std::uint32_t* const first, const std::uint32_t* const last,
+        const std::uint32_t from, const std::uint32_t to)
+{
+    for (const auto* t = first; t != last; ++t) {
+        const std::uint32_t* tri = indices + 3 * *t;
+        if (tri[0] == to || tri[1] == to || tri[2] == to)
+            continue; // collapses
+        glm::vec3 p[3] = {positions[tri[0]], positions[tri[1]], positions[tri[2]]};
+        const glm::vec3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+        p[tri[0] == from ? 0 : (tri[1] == from ? 1 : 2)] = positions[to];
+        const glm::vec3 n1 = glm::cross(p[1] - p[0], p[2] - p[0]);
+        if (glm::dot(n0, n1) <= 0.f)
+            return true;
+    }
+    return false;
+}
+
+/***************************************************************************/
+
+// One round of independent collapses, the cheapest first. Returns false if
+// nothing could be collapsed.
+bool collapseEdges(const Mesh* const mesh, const std::vector<bool>& locked,
+        std::vector<std::uint32_t>& seams,
+        std::vector<Quadric>& quadrics, std::vector<std::uint32_t>& indices,
+        const std::size_t target_num_indices, const double max_error, double& error)
+{
+    const glm::vec3* const positions = mesh->vertices;
+    const std::size_t num_vertices = mesh->num_vertices;
+    const std::size_t num_triangles = indices.size() / 3;
+
+    // triangles per vertex
+    std::vector<std::uint32_t> offsets(num_vertices + 1, 0);
+    for (const auto v : indices) {
+        ++offsets[v + 1];
+    }
+    for (std::size_t v = 0; v < num_vertices; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<std::uint32_t> adjacency(indices.size());
+    {
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+        }
+    }
+
+    // the merged vertex has to approximate the planes of both
+    std::vector<Collapse> collapses;
+    collapses.reserve(indices.size());
+    for (std::size_t t = 0; t < num_triangles; ++t) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            const auto from = indices[3 * t + j];
+            const auto to = indices[3 * t + (j + 1) % 3];
+            if (locked[from] && locked[to])
+                continue;
+            Quadric q = quadrics[from];
+            q += quadrics[to];
+            if (!locked[from] && followsSeam(seams, from, to))
+                collapses.push_back(Collapse{from, to, q.error(positions[to])});
+            if (!locked[to] && followsSeam(seams, to, from))
+                collapses.push_back(Collapse{to, from, q.error(positions[from])});
+        }
+    }
+    std::sort(collapses.begin(), collapses.end(),
+            [] (const Collapse& c0, const Collapse& c1) -> bool
+            {
+                return c0.error < c1.error;
+            });
+
+    // every vertex takes part in one collapse at most, so the quadrics
+    // and flip tests stay valid for the whole round
+    std::vector<std::uint32_t> remap(num_vertices);
+    std::iota(remap.begin(), remap.end(), 0u);
+    std::vector<bool> touched(num_vertices, false);
+    std::size_t num_removed = 0;
+    const std::size_t max_removed = (indices.size() - target_num_indices) / 3;
+    for (const auto& c : collapses) {
+        if (c.error > max_error || num_removed >= max_removed)
+            break;
+        if (c.from == c.to || touched[c.from] || touched[c.to])
+            continue;
+
+        const std::uint32_t* first = adjacency.data() + offsets[c.from];
+        const std::uint32_t* last = adjacency.data() + offsets[c.from + 1];
+        if (flipsTriangle(positions, indices.data(), first, last, c.from, c.to))
+            continue;
+
+        remap[c.from] = c.to;
+        quadrics[c.to] += quadrics[c.from];
+        // the seam goes on from 'to', its neighbours are touched as well
+        if (seams[2 * c.from] != NO_VERTEX) {
+            const auto other = seams[2 * c.from] == c.to ? seams[2 * c.from + 1] :
+                seams[2 * c.from];
+            if (other != c.to) {
+                replaceSeamNeighbour(seams, c.to, c.from, other);
+                replaceSeamNeighbour(seams, other, c.from, c.to);
+            }
+        }
+        error = std::max(error, c.error);
+        for (const auto* t = first; t != last; ++t) {
+            const std::uint32_t* tri = indices.data() + 3 * *t;
+            if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+                ++num_removed;
+            touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+        }
+    }
+    if (num_removed == 0)
+        return false;
+
+    std::size_t num_indices = 0;
+    for (std::size_t t = 0; t < num_triangles; ++t) {
+        const auto v0 = remap[indices[3 * t]];
+        const auto v1 = remap[indices[3 * t + 1]];
+        const auto v2 = remap[indices[3 * t + 2]];
+        if (v0 == v1 || v0 == v2 || v1 == v2)
+            continue;
+        indices[num_indices++] = v0;
+        indices[num_indices++] = v1;
+        indices[num_indices++] = v2;
+    }
+    indices.resize(num_indices);
+    return true;
+}
+
+/***************************************************************************/
+
+} // anonymous namespace
+
+/***************************************************************************/
+
+void buildLods(const Mesh* const mesh, std::vector<MeshLod>& lods,
+        std::vector<std::uint32_t>& indices)
+{
+    lods.clear();
+    indices.clear();
+    if (mesh->num_indices < 3)
+        return;
+
+    Welding welding;
+    std::vector<std::uint32_t> current = weldByPosition(mesh, welding);
+    std::vector<bool> locked = findLockedVertices(current, mesh->num_vertices);
+    std::vector<std::uint32_t> seams = findSeams(mesh, welding, locked);
+
+    // the quadrics keep accumulating, so the error is relative to the original
+    std::vector<Quadric> quadrics(mesh->num_vertices,
+            Quadric{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+    for (std::size_t i = 0; i + 2 < current.size(); i += 3) {
+        const auto v0 = current[i];
+        const auto v1 = current[i + 1];
+        const auto v2 = current[i + 2];
+        const Quadric q = planeQuadric(mesh->vertices[v0], mesh->vertices[v1],
+                mesh->vertices[v2]);
+        quadrics[v0] += q;
+        quadrics[v1] += q;
+        quadrics[v2] += q;
+    }
+
+    const double diagonal = static_cast<double>(glm::length(mesh->bbox.pmax - mesh->bbox.pmin));
+    const double max_error = diagonal * diagonal *
+        static_cast<double>(MAX_LOD_ERROR) * static_cast<double>(MAX_LOD_ERROR);
+
+    // the first LOD has to be smaller than the mesh, not just the welded one
+    std::size_t previous_size = mesh->num_indices;
+    double error = 0.0;
+    while (lods.size() < MAX_MESH_LODS) {
+        const std::size_t target = previous_size / 6 * 3;
+        while (current.size() > target &&
+                collapseEdges(mesh, locked, seams, quadrics, current, target, max_error, error))
+        {
+        }
+        if (current.empty() || static_cast<float>(current.size()) >
+                (1.f - MIN_LOD_REDUCTION) * static_cast<float>(previous_size))
+            break;
+
+        MeshLod lod;
+        lod.error = static_cast<float>(std::sqrt(error));
+        lod.first_index = static_cast<std::uint32_t>(indices.size());
+        lod.num_indices = static_cast<std::uint32_t>(current.size());
+        lods.push_back(lod);
+
+        const std::size_t offset = indices.size();
+        indices.insert(indices.end(), current.begin(), current.end());
+        splitSeams(mesh, welding, indices.data() + offset, current.size());
+        optimizeVertexCache(indices.data() + offset, current.size(), mesh->num_vertices);
+        previous_size = current.size();
+    }
+}
+
+/***************************************************************************/
+
+} // namespace import
@@ -0,0 +1,30 @@
+#ifndef IMPORT_MESH_SIMPLIFIER_H
+#define IMPORT_MESH_SIMPLIFIER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace import
+{
+
+struct Mesh;
+struct MeshLod;
+
+constexpr int MESH_SIMPLIFIER_VERSION = 3;
+
+constexpr std::uint32_t MAX_MESH_LODS = 4;
+
+// Builds up to MAX_MESH_LODS simplified versions of the mesh, each one with
+// about half the triangles of the previous one. Edges are collapsed in the
+// order of their quadric error (Garland, Heckbert), vertices on open borders
+// stay where they are. The mesh is welded by position to find the edges,
+// vertices on UV seams only move along the seam. Each corner of a LOD
+// triangle then takes the vertex at its position on the triangle's side of
+// the seam whose normal fits the triangle best. The LODs share the vertices
+// of the mesh, their indices are appended to 'indices'.
+void buildLods(const Mesh* mesh, std::vector<MeshLod>& lods,
+        std::vector<std::uint32_t>& indices);
+
+} // namespace import
+
+#endif // IMPORT_MESH_SIMPLIFIER_H
@@ -5,6 +5,11 @@ namespace import
 
 /****************************************************************************/
 
+constexpr std::uint32_t Node::NO_PARENT;
+constexpr std::uint32_t Node::NO_MESH;
+
+/****************************************************************************/
+
 void Node::makePointersRelative()
 {
     const char* offset = reinterpret_cast<const char*>(this);
@@ -1,6 +1,7 @@
 #ifndef IMPORT_NODE_H
 #define IMPORT_NODE_H
 
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/mat4x4.hpp>
@@ -8,9 +9,12 @@
 namespace import
 {
 
+// Nodes are stored depth-first, a parent always comes before its children.
 struct Node
 {
-    static constexpr int VERSION = 2;
+    static constexpr int VERSION = 3;
+    static constexpr std::uint32_t NO_PARENT = 0xFFFFFFFF;
+    static constexpr std::uint32_t NO_MESH = 0xFFFFFFFF; // only groups its children
 
     void makePointersRelative();
     void makePointersAbsolute();
@@ -19,8 +23,9 @@ struct Node
     glm::vec3       position;
     glm::vec3       scale;
     glm::quat       rotation;
-    glm::mat4       transformation;
+    glm::mat4       transformation; // relative to the parent
     std::uint32_t   mesh_index;
+    std::uint32_t   parent_index;
 };
 
 } // namespace import
@@ -2,6 +2,7 @@
 #include "import.h"
 
 #include "log/log.h"
+#include "cache.h"
 #include <iostream>
 namespace import
 {
@@ -11,8 +12,25 @@ namespace import
 Scene::~Scene()
 {
     for (unsigned int i = 0; i < num_textures; ++i) {
-        delete textures[i]->image;
-        textures[i]->image = nullptr;
+        delete textures[i]->data;
+        textures[i]->data = nullptr;
+    }
+}
+
+/***************************************************************************/
+
+void SceneDeleter::operator()(Scene* const scene) const noexcept
+{
+    if (scene == nullptr)
+        return;
+
+    SceneStorage* const storage = scene->storage;
+    scene->~Scene();
+    if (storage != nullptr) {
+        // the scene lives inside the storage
+        delete storage;
+    } else {
+        delete[] reinterpret_cast<char*>(scene);
     }
 }
 
@@ -116,7 +134,9 @@ void Scene::makePointersAbsolute()
     }
     for (std::uint32_t i = 0; i < num_meshes; ++i) {
         meshes[i] = reinterpret_cast<Mesh*>(offset + reinterpret_cast<std::size_t>(meshes[i]));
-        meshes[i]->makePointersAbsolute();
+        // the mesh data of cached scenes may not be loaded yet
+        if (storage == nullptr)
+            meshes[i]->makePointersAbsolute();
     }
     for (std::uint32_t i = 0; i < num_lights; ++i) {
         lights[i] = reinterpret_cast<Light*>(offset + reinterpret_cast<std::size_t>(lights[i]));
@@ -134,5 +154,24 @@ void Scene::makePointersAbsolute()
 
 /***************************************************************************/
 
+Mesh* Scene::getMesh(const std::uint32_t idx)
+{
+    if (storage != nullptr && !storage->loadMesh(idx))
+        return nullptr;
+    Mesh* mesh = meshes[idx];
+    mesh->makePointersAbsolute();
+    return mesh;
+}
+
+/***************************************************************************/
+
+void Scene::prefetchMesh(const std::uint32_t idx)
+{
+    if (storage != nullptr)
+        storage->prefetchMesh(idx);
+}
+
+/***************************************************************************/
+
 } // namespace import
 
@@ -2,10 +2,13 @@
 #define IMPORT_SCENE_H
 
 #include <cstdint>
+#include <memory>
 
 namespace import
 {
 
+class SceneStorage;
+
 struct Material;
 struct Mesh;
 struct Light;
@@ -15,13 +18,18 @@ struct Node;
 
 struct Scene
 {
-    static constexpr int VERSION = 1;
+    static constexpr int VERSION = 2;
 
     ~Scene();
 
     void makePointersRelative();
     void makePointersAbsolute();
 
+    // Makes sure mesh 'idx' is resident. Cached scenes load their
+    // meshes lazily, so meshes[idx] must not be used directly.
+    Mesh* getMesh(std::uint32_t idx);
+    void prefetchMesh(std::uint32_t idx);
+
     const char*     name;
     std::uint32_t   size;
 
@@ -38,8 +46,18 @@ struct Scene
     Texture**       textures;
     Camera**        cameras;
     Node**          nodes;
+
+    // runtime only: set if the scene was loaded from the cache
+    SceneStorage*   storage;
 };
 
+struct SceneDeleter
+{
+    void operator()(Scene* scene) const noexcept;
+};
+
+using ScenePtr = std::unique_ptr<Scene, SceneDeleter>;
+
 } // namespace import
 
 #endif // IMPORT_SCENE_H
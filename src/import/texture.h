@@ -4,17 +4,17 @@
 namespace import
 {
 
-class Image;
+struct TextureData;
 
 struct Texture
 {
-    static constexpr int VERSION = 1;
+    static constexpr int VERSION = 2;
 
     void makePointersRelative();
     void makePointersAbsolute();
 
-    const char* name;
-    Image*      image;
+    const char*     name;
+    TextureData*    data;
 };
 
 } // namespace import
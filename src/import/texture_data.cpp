@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "texture_data.h"
+#include "image.h"
+
+namespace import
+{
+namespace
+{
+
+/***************************************************************************/
+
+std::uint64_t rowSize(const std::uint32_t width, const int num_channels)
+{
+    return (static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(num_channels) + 3) &
+        ~static_cast<std::uint64_t>(3);
+}
+
+/***************************************************************************/
+
+// 2x2 box filter, odd edges are clamped
+void downsample(const char* const src, const std::uint32_t src_width,
+        const std::uint32_t src_height, char* const dst, const std::uint32_t dst_width,
+        const std::uint32_t dst_height, const int num_channels)
+{
+    const auto src_pitch = rowSize(src_width, num_channels);
+    const auto dst_pitch = rowSize(dst_width, num_channels);
+    const auto c = static_cast<std::uint32_t>(num_channels);
+
+    for (std::uint32_t y = 0; y < dst_height; ++y) {
+        const auto* row0 = reinterpret_cast<const unsigned char*>(src + 2 * y * src_pitch);
+        const auto* row1 = reinterpret_cast<const unsigned char*>(src +
+                std::min(2 * y + 1, src_height - 1) * src_pitch);
+        auto* out = reinterpret_cast<unsigned char*>(dst + y * dst_pitch);
+        for (std::uint32_t x = 0; x < dst_width; ++x) {
+            const std::uint32_t x0 = 2 * x * c;
+            const std::uint32_t x1 = std::min(2 * x + 1, src_width - 1) * c;
+            for (std::uint32_t i = 0; i < c; ++i) {
+                const unsigned int sum = row0[x0 + i] + row0[x1 + i] +
+                    row1[x0 + i] + row1[x1 + i];
+                out[x * c + i] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+/***************************************************************************/
+
+std::vector<std::uint8_t> toRGBA(const char* const src, const std::uint32_t width,
+        const std::uint32_t height, const GLenum format, const int num_channels)
+{
+    const bool bgr = format == GL_BGR || format == GL_BGRA;
+    const auto pitch = rowSize(width, num_channels);
+    const auto c = static_cast<std::size_t>(num_channels);
+
+    std::vector<std::uint8_t> rgba(static_cast<std::size_t>(width) * height * 4, 0);
+    for (std::uint32_t y = 0; y < height; ++y) {
+        const auto* row = reinterpret_cast<const std::uint8_t*>(src + y * pitch);
+        auto* out = rgba.data() + static_cast<std::size_t>(y) * width * 4;
+        for (std::uint32_t x = 0; x < width; ++x, row += c, out += 4) {
+            if (c == 1) {
+                out[0] = row[0];
+            } else {
+                out[0] = row[bgr ? 2 : 0];
+                out[1] = row[1];
+                out[2] = row[bgr ? 0 : 2];
+            }
+            out[3] = c == 4 ? row[3] : 255;
+        }
+    }
+    return rgba;
+}
+
+/***************************************************************************/
+
+int numCompressedChannels(const BlockFormat format)
+{
+    switch (format) {
+    case BlockFormat::BC1:
+        return 3;
+    case BlockFormat::BC3:
+        return 4;
+    case BlockFormat::BC4:
+        return 1;
+    case BlockFormat::BC5:
+        return 2;
+    case BlockFormat::None:
+    default:
+        return 0;
+    }
+}
+
+/***************************************************************************/
+
+double computePSNR(const std::vector<std::uint8_t>& a, const std::vector<std::uint8_t>& b,
+        const int num_channels)
+{
+    double error = 0.0;
+    for (std::size_t i = 0; i < a.size(); i += 4) {
+        for (std::size_t c = 0; c < static_cast<std::size_t>(num_channels); ++c) {
+            const double d = static_cast<double>(a[i + c]) - static_cast<double>(b[i + c]);
+            error += d * d;
+        }
+    }
+    if (error == 0.0)
+        return std::numeric_limits<double>::infinity();
+    const double mse = error / static_cast<double>(a.size() / 4 *
+            static_cast<std::size_t>(num_channels));
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+/***************************************************************************/
+
+} // anonymous namespace
+
+/***************************************************************************/
+
+TextureData::TextureData() noexcept
+  : compression{BlockFormat::None},
+    internal_format{GL_NONE},
+    format{GL_NONE},
+    type{GL_NONE},
+    num_channels{0}
+{
+}
+
+/***************************************************************************/
+
+TextureData::TextureData(const Image& image)
+  : TextureData()
+{
+    // anything that isn't 8 bits per channel ends up as RGBA8 on the GPU anyway
+    const bool is_8bit = image.type() == FIT_BITMAP &&
+        ((image.bpp() == 8 && (image.color_type() == FIC_MINISBLACK ||
+                               image.color_type() == FIC_MINISWHITE)) ||
+         (image.bpp() == 24 && image.color_type() == FIC_RGB) ||
+         (image.bpp() == 32 && image.color_type() == FIC_RGBALPHA));
+    const Image converted = is_8bit ? Image() : image.convert_to_32bits();
+    const Image& src = is_8bit ? image : converted;
+
+    num_channels = src.numChannels();
+    format = src.gl_format();
+    type = GL_UNSIGNED_BYTE;
+    if (num_channels == 1)
+        internal_format = GL_R8;
+    else if (num_channels == 3)
+        internal_format = GL_RGB8;
+    else
+        internal_format = GL_RGBA8;
+
+    const auto num_levels = static_cast<std::size_t>(src.maxNumMipMaps());
+    levels.resize(num_levels);
+    std::uint64_t size = 0;
+    for (std::size_t i = 0; i < num_levels; ++i) {
+        auto& level = levels[i];
+        level.width = std::max(src.width() >> i, 1u);
+        level.height = std::max(src.height() >> i, 1u);
+        level.offset = size;
+        level.size = rowSize(level.width, num_channels) * level.height;
+        size += level.size;
+    }
+    data.resize(size);
+
+    // FreeImage pads its scanlines to 4 bytes as well
+    const auto row_size = rowSize(levels[0].width, num_channels);
+    for (std::uint32_t y = 0; y < levels[0].height; ++y) {
+        std::memcpy(data.data() + y * row_size, src.scanline(static_cast<int>(y)), row_size);
+    }
+
+    for (std::size_t i = 1; i < num_levels; ++i) {
+        const auto& prev = levels[i - 1];
+        const auto& level = levels[i];
+        downsample(data.data() + prev.offset, prev.width, prev.height,
+                data.data() + level.offset, level.width, level.height, num_channels);
+    }
+}
+
+/***************************************************************************/
+
+bool TextureData::hasTransparency() const
+{
+    if (num_channels != 4 || compression != BlockFormat::None)
+        return false;
+
+    const auto& level = levels[0];
+    const auto pitch = rowSize(level.width, num_channels);
+    for (std::uint32_t y = 0; y < level.height; ++y) {
+        const auto* row = reinterpret_cast<const std::uint8_t*>(data.data() + y * pitch);
+        for (std::uint32_t x = 0; x < level.width; ++x) {
+            if (row[4 * x + 3] != 255)
+                return true;
+        }
+    }
+    return false;
+}
+
+/***************************************************************************/
+
+void TextureData::compress(const BlockFormat block_format, const int refinement,
+        CompressionStats* const stats)
+{
+    if (block_format == BlockFormat::None || compression != BlockFormat::None)
+        return;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<Level> compressed_levels(levels.size());
+    std::uint64_t size = 0;
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        compressed_levels[i].width = levels[i].width;
+        compressed_levels[i].height = levels[i].height;
+        compressed_levels[i].offset = size;
+        compressed_levels[i].size = compressedSize(block_format, levels[i].width,
+                levels[i].height);
+        size += compressed_levels[i].size;
+    }
+
+    std::vector<char> compressed_data(size);
+    std::vector<std::uint8_t> base;
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        const auto& level = levels[i];
+        auto rgba = toRGBA(data.data() + level.offset, level.width, level.height,
+                format, num_channels);
+        compressImage(block_format, rgba.data(), level.width, level.height, refinement,
+                reinterpret_cast<std::uint8_t*>(compressed_data.data() +
+                    compressed_levels[i].offset));
+        if (i == 0)
+            base = std::move(rgba);
+    }
+
+    const std::chrono::duration<double, std::milli> time =
+        std::chrono::steady_clock::now() - start;
+
+    if (stats != nullptr) {
+        // round trip of the base level
+        const auto& level = compressed_levels[0];
+        std::vector<std::uint8_t> decoded(base.size());
+        decompressImage(block_format,
+                reinterpret_cast<const std::uint8_t*>(compressed_data.data()),
+                level.width, level.height, decoded.data());
+        stats->psnr = computePSNR(base, decoded, numCompressedChannels(block_format));
+        stats->time = time.count();
+    }
+
+    compression = block_format;
+    internal_format = glInternalFormat(block_format);
+    format = internal_format;
+    type = GL_NONE;
+    levels = std::move(compressed_levels);
+    data = std::move(compressed_data);
+}
+
+/***************************************************************************/
+
+} // namespace import
@@ -0,0 +1,58 @@
+#ifndef IMPORT_TEXTURE_DATA_H
+#define IMPORT_TEXTURE_DATA_H
+
+#include <cstdint>
+#include <vector>
+
+#include "gl/gl_sys.h"
+#include "block_compression.h"
+
+namespace import
+{
+
+class Image;
+
+// Decoded texels of a texture including the full mip chain, ready to be
+// uploaded level by level. Rows are padded to 4 bytes (GL_UNPACK_ALIGNMENT),
+// compressed levels are stored as consecutive 4x4 blocks.
+struct TextureData
+{
+    static constexpr int VERSION = 2;
+
+    struct CompressionStats
+    {
+        double  psnr;   // dB, level 0
+        double  time;   // ms
+    };
+
+    struct Level
+    {
+        std::uint32_t   width;
+        std::uint32_t   height;
+        std::uint64_t   offset;
+        std::uint64_t   size;
+    };
+
+    TextureData() noexcept;
+
+    // converts the image to 8 bits per channel and builds the mip chain
+    explicit TextureData(const Image& image);
+
+    // true if level 0 has a texel with alpha < 1
+    bool hasTransparency() const;
+
+    // compresses all levels, the texture must not be compressed already
+    void compress(BlockFormat format, int refinement, CompressionStats* stats = nullptr);
+
+    BlockFormat         compression;
+    GLenum              internal_format;
+    GLenum              format;
+    GLenum              type;
+    int                 num_channels;
+    std::vector<Level>  levels;
+    std::vector<char>   data;
+};
+
+} // namespace import
+
+#endif // IMPORT_TEXTURE_DATA_H
@@ -12,7 +12,6 @@
 #include "import/import.h"
 #include "gl/gl_sys.h"
 
-#include "core/loader.h"
 #include "core/managers.h"
 
 #include "grapro.h"
@@ -49,8 +48,8 @@ int main(int argc, const char** argv)
     try {
         // INIT CORE
         core::initializeManagers();
-        core::loadScenefiles(vars.scene_files);
 
+        // loads the scene files in the background
         GraPro* win = new GraPro(main_window);
 
         while (!glfwWindowShouldClose(*win)) {
@@ -166,7 +166,7 @@ void RendererImplBM::createVoxelList(const bool debug_output)
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, core::bindings::VOXEL, m_voxelBuffer);
 
     // render
-    renderGeometry(m_voxel_prog);
+    renderGeometry(m_voxel_prog, voxelLodError());
 
     // get number of voxel fragments
     glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, m_atomicCounterBuffer);
@@ -122,7 +122,7 @@ void RendererImplPK::createVoxelList(const bool debug_output)
     glDisable(GL_CULL_FACE);
     glDepthFunc(GL_ALWAYS);
 
-    renderGeometry(m_voxel_prog);
+    renderGeometry(m_voxel_prog, voxelLodError());
 
     // TODO move to shader
     glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, m_atomicCounterBuffer);
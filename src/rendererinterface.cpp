@@ -14,6 +14,22 @@
 
 #include "framework/vars.h"
 
+namespace
+{
+
+std::size_t indexSize(const GLenum type)
+{
+    if (type == GL_UNSIGNED_BYTE)
+        return sizeof(GLubyte);
+    if (type == GL_UNSIGNED_SHORT)
+        return sizeof(GLushort);
+    return sizeof(GLuint);
+}
+
+} // anonymous namespace
+
+/****************************************************************************/
+
 RendererInterface::RendererInterface(core::TimerArray& timer_array, unsigned int treeLevels)
   : m_numVoxelFrag{0u},
     m_rebuildTree{true},
@@ -55,14 +71,12 @@ void RendererInterface::setGeometry(std::vector<const core::Instance*> geometry)
     m_drawlist.clear();
     m_drawlist.reserve(m_geometry.size());
     for (const auto* g : m_geometry) {
-        const auto* mesh = g->getMesh();
-        const auto prog = m_programs[mesh->components()()];
-        GLuint vao {core::res::meshes->getVAO(mesh)};
-        m_drawlist.emplace_back(g, prog, vao, mesh->mode(),
-                mesh->count(), mesh->type(),
-                mesh->indices(), mesh->basevertex());
+        addDrawCmd(g);
         m_scene_bbox.expandBy(g->getBoundingBox());
     }
+    // nothing loaded yet
+    if (m_geometry.empty())
+        return;
 
     // make every side of the bounding box equally long
     const auto maxExtend = m_scene_bbox.maxExtend();
@@ -99,6 +113,27 @@ void RendererInterface::setGeometry(std::vector<const core::Instance*> geometry)
 
 /****************************************************************************/
 
+// unsorted, the bounding box waits for setGeometry()
+void RendererInterface::addGeometry(const std::vector<const core::Instance*>& geometry)
+{
+    m_geometry.insert(m_geometry.end(), geometry.begin(), geometry.end());
+    for (const auto* g : geometry) {
+        addDrawCmd(g);
+    }
+}
+
+/****************************************************************************/
+
+void RendererInterface::addDrawCmd(const core::Instance* g)
+{
+    const auto* mesh = g->getMesh();
+    const auto prog = m_programs[mesh->components()()];
+    GLuint vao {core::res::meshes->getVAO(mesh)};
+    m_drawlist.emplace_back(g, prog, vao, mesh->mode(), mesh->type());
+}
+
+/****************************************************************************/
+
 void RendererInterface::initBBoxes()
 {
     // indices
@@ -367,7 +402,7 @@ void RendererInterface::createVoxelBBoxes(const unsigned int num)
 
 /****************************************************************************/
 
-void RendererInterface::renderGeometry(const GLuint prog) const
+void RendererInterface::renderGeometry(const GLuint prog, const float max_lod_error) const
 {
     core::res::materials->bind();
     core::res::instances->bind();
@@ -383,6 +418,10 @@ void RendererInterface::renderGeometry(const GLuint prog) const
         // Frustum Culling
         if (!cam->inFrustum(cmd.instance->getBoundingBox()))
             continue;
+        // paged out, see MeshManager::update()
+        const auto* mesh = cmd.instance->getMesh();
+        if (!mesh->isResident())
+            continue;
 
         // bind textures
         const auto* mat = cmd.instance->getMaterial();
@@ -443,8 +482,50 @@ void RendererInterface::renderGeometry(const GLuint prog) const
             }
         }
 
-        glDrawElementsInstancedBaseVertexBaseInstance(cmd.mode, cmd.count, cmd.type,
-                cmd.indices, 1, 0, cmd.instance->getIndex());
+        // static batch: cull the parts, contiguous visible ones are drawn at once
+        if (!mesh->parts().empty()) {
+            const auto indices = reinterpret_cast<std::size_t>(mesh->indices());
+            const auto index_size = indexSize(cmd.type);
+            auto draw = [&] (const GLuint first, const GLsizei count) {
+                glDrawElementsInstancedBaseVertexBaseInstance(cmd.mode, count, cmd.type,
+                        reinterpret_cast<GLvoid*>(indices + first * index_size), 1, 0,
+                        cmd.instance->getIndex());
+            };
+            GLuint first {0};
+            GLsizei count {0};
+            for (const auto& part : mesh->parts()) {
+                if (!cam->inFrustum(part.bbox))
+                    continue;
+                if (count > 0 && first + static_cast<GLuint>(count) == part.first_index) {
+                    count += part.count;
+                    continue;
+                }
+                if (count > 0)
+                    draw(first, count);
+                first = part.first_index;
+                count = part.count;
+            }
+            if (count > 0)
+                draw(first, count);
+            continue;
+        }
+
+        // coarsest LOD within the error bound, which is given in world space
+        GLsizei count {mesh->count()};
+        GLvoid* indices {mesh->indices()};
+        if (max_lod_error > 0.f) {
+            const auto& scale = cmd.instance->getScale();
+            const auto error = max_lod_error / std::max(scale.x, std::max(scale.y, scale.z));
+            for (const auto& lod : mesh->lods()) {
+                if (lod.error > error)
+                    break;
+                count = lod.count;
+                indices = lod.indices;
+            }
+        }
+
+        glDrawElementsInstancedBaseVertexBaseInstance(cmd.mode, count, cmd.type,
+                indices, 1, 0, cmd.instance->getIndex());
     }
 }
 
@@ -464,6 +545,15 @@ void RendererInterface::resizeFBO() const
 
 /****************************************************************************/
 
+float RendererInterface::voxelLodError() const
+{
+    const auto num_voxels = static_cast<float>(std::pow(2, m_treeLevels - 1));
+    const auto voxel_size = (m_scene_bbox.pmax.x - m_scene_bbox.pmin.x) / num_voxels;
+    return vars.voxel_lod_error * voxel_size;
+}
+
+/****************************************************************************/
+
 unsigned int RendererInterface::calculateMaxNodes() const
 {
     auto maxNodes = 1u;
@@ -49,7 +49,10 @@ public:
 
     virtual void render(const Options & options) = 0;
 
+    // sorts the draw list and fits the voxelization to the scene
     void setGeometry(std::vector<const core::Instance*> geometry);
+    // appends to the draw list while the scene is loading, see setGeometry()
+    void addGeometry(const std::vector<const core::Instance*>& geometry);
     void markTreeInvalid() { m_rebuildTree = true; }
 
     const core::AABB& getSceneBBox() const { return this->m_scene_bbox; }
@@ -60,7 +63,8 @@ protected:
     virtual void createVoxelList(bool debug_output = false) = 0;
     virtual void buildVoxelTree(bool debug_output = false) = 0;
 
-    void renderGeometry(GLuint prog) const;
+    // max_lod_error > 0: draw the coarsest LOD within that (world space) error
+    void renderGeometry(GLuint prog, float max_lod_error = 0.f) const;
     void renderBoundingBoxes() const;
     void renderVoxelBoundingBoxes() const;
     void renderVoxelColors() const;
@@ -72,6 +76,7 @@ protected:
     void createVoxelBBoxes(unsigned int num);
     void resizeFBO() const;
     unsigned int calculateMaxNodes() const;
+    float voxelLodError() const;
     void recreateBuffer(gl::Buffer & buf, size_t size) const;
 
     using ProgramMap = std::unordered_map<unsigned char, core::Program>;
@@ -147,6 +152,7 @@ protected:
 
 private:
 
+    void addDrawCmd(const core::Instance* g);
     void initBBoxes();
     void initVertexPulling();
     void initVoxelization();
@@ -163,16 +169,12 @@ private:
 struct RendererInterface::DrawCmd
 {
     DrawCmd(const core::Instance* instance_, core::Program prog_,
-            GLuint vao_, GLenum mode_, GLsizei count_, GLenum type_,
-            GLvoid* indices_, GLint basevertex_)
+            GLuint vao_, GLenum mode_, GLenum type_)
       : instance{instance_},
         prog{prog_},
         vao{vao_},
         mode{mode_},
-        count{count_},
-        type{type_},
-        indices{indices_},
-        basevertex{basevertex_}
+        type{type_}
     {
     }
 
@@ -180,10 +182,7 @@ struct RendererInterface::DrawCmd
     core::Program           prog;
     GLuint                  vao;
     GLenum                  mode;
-    GLsizei                 count;
     GLenum                  type;
-    GLvoid*                 indices;
-    GLint                   basevertex;
 };
 
 /****************************************************************************/
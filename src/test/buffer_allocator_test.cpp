@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include "core/buffer_allocator.h"
+#include "tests.h"
+
+namespace test
+{
+
+namespace
+{
+
+using core::BufferAllocator;
+// offset -> size of the allocations
+using Reference = std::map<std::size_t, std::size_t>;
+
+constexpr std::size_t BUFFER_SIZE = 1 << 20;
+constexpr int NUM_OPERATIONS = 200000;
+
+//////////////////////////////////////////////////////////////////////////
+
+// everything between the allocations is free, the allocator merges it
+template <typename F>
+void forEachGap(const Reference& reference, const std::size_t size, F f)
+{
+    std::size_t begin = 0;
+    for (const auto& allocation : reference) {
+        if (allocation.first > begin)
+            f(begin, allocation.first);
+        begin = allocation.first + allocation.second;
+    }
+    if (size > begin)
+        f(begin, size);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool checkAlloc(const Reference& reference, const std::size_t offset, const std::size_t size,
+        const std::size_t alignment)
+{
+    CHECK(offset % alignment == 0);
+    CHECK(offset + size <= BUFFER_SIZE);
+    const auto next = reference.lower_bound(offset);
+    CHECK(next == reference.end() || offset + size <= next->first);
+    if (next != reference.begin()) {
+        const auto prev = std::prev(next);
+        CHECK(prev->first + prev->second <= offset);
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool checkStatistics(const BufferAllocator& allocator, const Reference& reference)
+{
+    std::size_t free_size = 0;
+    std::size_t largest = 0;
+    forEachGap(reference, BUFFER_SIZE, [&] (const std::size_t begin, const std::size_t end) {
+            free_size += end - begin;
+            largest = std::max(largest, end - begin);
+        });
+    CHECK(allocator.getFreeSize() == free_size);
+    CHECK(allocator.getLargestFreeBlock() == largest);
+    if (!reference.empty()) {
+        const auto& last = *reference.rbegin();
+        CHECK(allocator.getHighWaterMark() >= last.first + last.second);
+    }
+    CHECK(allocator.getFragmentation() >= 0.f && allocator.getFragmentation() < 1.f);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// random allocs and frees against the reference map
+bool fuzz()
+{
+    BufferAllocator allocator(BUFFER_SIZE);
+    Reference reference;
+    std::mt19937 rng(7);
+    const std::size_t alignments[] = {1, 2, 4, 12, 16, 256, 4096};
+
+    for (int i = 0; i < NUM_OPERATIONS; ++i) {
+        const bool alloc = reference.empty() || rng() % 100 < 55;
+        if (alloc) {
+            // mostly small, a few large ones
+            const std::size_t size = rng() % 16 == 0 ? 1 + rng() % (BUFFER_SIZE / 8) :
+                rng() % 4096;
+            const std::size_t alignment = alignments[rng() % 7];
+            const auto offset = allocator.alloc(size, alignment);
+            const auto used = std::max(size, std::size_t(1));
+            if (offset == BufferAllocator::INVALID_OFFSET) {
+                // good fit, but never with plenty of space
+                bool fits = false;
+                forEachGap(reference, BUFFER_SIZE,
+                        [&] (const std::size_t begin, const std::size_t end) {
+                            fits = fits || end - begin >= 2 * (used + alignment);
+                        });
+                CHECK(!fits);
+            } else {
+                if (!checkAlloc(reference, offset, used, alignment))
+                    return false;
+                reference.emplace(offset, used);
+            }
+        } else {
+            auto it = reference.begin();
+            std::advance(it, static_cast<long>(rng() % reference.size()));
+            allocator.free(it->first);
+            reference.erase(it);
+        }
+        if (i % 64 == 0 && !checkStatistics(allocator, reference))
+            return false;
+    }
+
+    // merged back into one block
+    for (const auto& allocation : reference) {
+        allocator.free(allocation.first);
+    }
+    reference.clear();
+    CHECK(allocator.getFreeSize() == BUFFER_SIZE);
+    CHECK(allocator.getLargestFreeBlock() == BUFFER_SIZE);
+    CHECK(allocator.getFragmentation() == 0.f);
+    CHECK(allocator.alloc(BUFFER_SIZE) == 0);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool edgeCases()
+{
+    BufferAllocator allocator(1024);
+    CHECK(allocator.alloc(2048) == BufferAllocator::INVALID_OFFSET);
+
+    const auto a = allocator.alloc(100);
+    const auto b = allocator.alloc(100, 64);
+    CHECK(a == 0);
+    CHECK(b == 128);
+    CHECK(allocator.getFreeSize() == 824);
+    CHECK(allocator.getHighWaterMark() == 228);
+
+    // unknown offsets are reported and ignored
+    allocator.free(1);
+    CHECK(allocator.getFreeSize() == 824);
+
+    allocator.clear();
+    CHECK(allocator.getFreeSize() == 1024);
+    CHECK(allocator.getHighWaterMark() == 0);
+    CHECK(allocator.alloc(1024) == 0);
+    CHECK(allocator.alloc(1) == BufferAllocator::INVALID_OFFSET);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
+
+bool testBufferAllocator()
+{
+    return edgeCases() && fuzz();
+}
+
+} // namespace test
@@ -0,0 +1,171 @@
+#include <random>
+#include <vector>
+
+#include "core/frame_ring.h"
+#include "tests.h"
+
+namespace test
+{
+
+namespace
+{
+
+using core::FrameRing;
+
+constexpr unsigned int NUM_REGIONS = 3;
+constexpr std::size_t NUM_ELEMENTS = 1000;
+constexpr int NUM_FRAMES = 500;
+
+//////////////////////////////////////////////////////////////////////////
+
+// records the calls, a region is "busy" from fence() to wait()
+class FakeFences
+  : public FrameRing::Backend
+{
+public:
+    FakeFences()
+      : busy(NUM_REGIONS, false),
+        num_fences{0},
+        num_waits{0},
+        error{false}
+    {
+    }
+
+    virtual void fence(const unsigned int region) override
+    {
+        error = error || region >= NUM_REGIONS || busy[region];
+        busy[region] = true;
+        ++num_fences;
+    }
+
+    virtual void wait(const unsigned int region) override
+    {
+        error = error || region >= NUM_REGIONS || !busy[region];
+        busy[region] = false;
+        ++num_waits;
+    }
+
+    std::vector<bool>   busy;
+    int                 num_fences;
+    int                 num_waits;
+    bool                error;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+bool checkRanges(const std::vector<FrameRing::Range>& ranges,
+        const std::vector<std::pair<std::size_t, std::size_t>>& expected)
+{
+    CHECK(ranges.size() == expected.size());
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+        CHECK(ranges[i].begin == expected[i].first);
+        CHECK(ranges[i].end == expected[i].second);
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// a region gets the changes of the last NUM_REGIONS frames, it was written
+// that long ago
+bool scripted()
+{
+    FakeFences fences;
+    FrameRing ring(NUM_REGIONS, fences);
+    CHECK(ring.getNumRegions() == NUM_REGIONS);
+    CHECK(ring.getCurrent() == 0);
+
+    ring.markDirty(5);
+    ring.markDirty(6);
+    if (!checkRanges(ring.advance(), {{5, 7}}))
+        return false;
+    CHECK(ring.getCurrent() == 1);
+
+    ring.markDirty(10, 12);
+    if (!checkRanges(ring.advance(), {{5, 7}, {10, 12}}))
+        return false;
+    CHECK(fences.num_waits == 0);
+
+    // back to region 0, still fenced
+    ring.markDirty(6);
+    if (!checkRanges(ring.advance(), {{5, 7}, {10, 12}}))
+        return false;
+    CHECK(ring.getCurrent() == 0);
+    CHECK(fences.num_waits == 1);
+
+    // the frames without changes push the old ones out
+    if (!checkRanges(ring.advance(), {{6, 7}, {10, 12}}))
+        return false;
+    if (!checkRanges(ring.advance(), {{6, 7}}))
+        return false;
+    if (!checkRanges(ring.advance(), {}))
+        return false;
+
+    CHECK(fences.num_fences == 6);
+    CHECK(fences.num_waits == 4);
+    CHECK(!fences.error);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool gaps()
+{
+    FakeFences fences;
+    FrameRing ring(1, fences, 2);
+    ring.markDirty(0);
+    ring.markDirty(3);     // 2 unchanged elements in between
+    ring.markDirty(7);     // 3
+    return checkRanges(ring.advance(), {{0, 4}, {7, 8}});
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// Random changes: copying the ranges into the current region has to
+// bring it up to date, without ever writing a region that is still fenced.
+bool randomFrames(const std::size_t max_gap)
+{
+    FakeFences fences;
+    FrameRing ring(NUM_REGIONS, fences, max_gap);
+    std::vector<int> values(NUM_ELEMENTS, 0);
+    std::vector<std::vector<int>> regions(NUM_REGIONS, values);
+    std::mt19937 rng(11);
+
+    for (int frame = 1; frame <= NUM_FRAMES; ++frame) {
+        const auto num_changes = rng() % 20;
+        for (unsigned int i = 0; i < num_changes; ++i) {
+            const auto element = static_cast<std::uint32_t>(rng() % NUM_ELEMENTS);
+            values[element] = frame;
+            ring.markDirty(element);
+        }
+
+        const auto& ranges = ring.advance();
+        const auto region = ring.getCurrent();
+        CHECK(!fences.busy[region]);
+        std::size_t end = 0;
+        for (const auto& range : ranges) {
+            CHECK(range.begin < range.end && range.end <= NUM_ELEMENTS);
+            CHECK(range.begin >= end);
+            end = range.end;
+            for (std::size_t e = range.begin; e < range.end; ++e) {
+                regions[region][e] = values[e];
+            }
+        }
+        CHECK(regions[region] == values);
+    }
+    CHECK(!fences.error);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
+
+bool testFrameRing()
+{
+    return scripted() && gaps() && randomFrames(0) && randomFrames(4);
+}
+
+} // namespace test
@@ -0,0 +1,254 @@
+#include <vector>
+
+#include "core/geometry_pager.h"
+#include "tests.h"
+
+namespace test
+{
+
+namespace
+{
+
+using core::GeometryPager;
+using Id = GeometryPager::Id;
+
+constexpr std::size_t PAGE_SIZE = 256;
+constexpr std::size_t NO_BUDGET = 1000;
+
+//////////////////////////////////////////////////////////////////////////
+
+// records the calls instead of copying anything
+class FakeUploads
+  : public GeometryPager::Backend
+{
+public:
+    virtual void upload(const Id id, const std::size_t first_page) override
+    {
+        uploads.push_back(id);
+        (void)first_page;
+    }
+
+    virtual void evict(const Id id) override
+    {
+        evictions.push_back(id);
+    }
+
+    void clear()
+    {
+        uploads.clear();
+        evictions.clear();
+    }
+
+    std::vector<Id> uploads;
+    std::vector<Id> evictions;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+Id add(GeometryPager& pager, const std::size_t num_pages)
+{
+    return pager.addResource(num_pages * PAGE_SIZE);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool uploadOrder()
+{
+    FakeUploads uploads;
+    GeometryPager pager(100, PAGE_SIZE, uploads);
+    const auto far = add(pager, 1);
+    const auto hidden = add(pager, 1);
+    const auto near = add(pager, 1);
+    const auto mid = add(pager, 1);
+
+    pager.request(far, 30.f, true);
+    pager.request(hidden, 1.f, false);
+    pager.request(near, 50.f, true);
+    pager.request(mid, 20.f, true);
+    // the smallest distance counts
+    pager.request(near, 10.f, true);
+    CHECK(pager.update(NO_BUDGET));
+    CHECK((uploads.uploads == std::vector<Id>{near, mid, far, hidden}));
+    CHECK(uploads.evictions.empty());
+
+    // nothing left to do
+    pager.request(near, 10.f, true);
+    CHECK(!pager.update(NO_BUDGET));
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool leastRecentlyVisible()
+{
+    FakeUploads uploads;
+    GeometryPager pager(4, PAGE_SIZE, uploads);
+    Id ids[6];
+    for (auto& id : ids) {
+        id = add(pager, 1);
+    }
+
+    // frame 1: 0-3 fill the pool, then 0 and 1 go out of view one by one
+    for (Id i = 0; i < 4; ++i) {
+        pager.request(ids[i], 1.f, true);
+    }
+    pager.update(NO_BUDGET);
+    for (Id i = 1; i < 4; ++i) {
+        pager.request(ids[i], 1.f, true);
+    }
+    pager.update(NO_BUDGET);
+    pager.request(ids[2], 1.f, true);
+    pager.request(ids[3], 1.f, true);
+    pager.update(NO_BUDGET);
+    uploads.clear();
+
+    pager.request(ids[2], 1.f, true);
+    pager.request(ids[3], 1.f, true);
+    pager.request(ids[4], 1.f, true);
+    CHECK(pager.update(NO_BUDGET));
+    CHECK((uploads.evictions == std::vector<Id>{ids[0]}));
+    CHECK((uploads.uploads == std::vector<Id>{ids[4]}));
+
+    pager.request(ids[5], 1.f, true);
+    pager.request(ids[4], 1.f, true);
+    CHECK(pager.update(NO_BUDGET));
+    CHECK((uploads.evictions == std::vector<Id>{ids[0], ids[1]}));
+    CHECK(pager.isResident(ids[2]) && pager.isResident(ids[3]));
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool budget()
+{
+    FakeUploads uploads;
+    GeometryPager pager(8, PAGE_SIZE, uploads);
+    Id ids[3];
+    for (auto& id : ids) {
+        id = add(pager, 2);
+        pager.request(id, 1.f, true);
+    }
+    CHECK(pager.update(5));
+    CHECK(uploads.uploads.size() == 2);
+    for (const auto id : ids) {
+        pager.request(id, 1.f, true);
+    }
+    CHECK(pager.update(5));
+    CHECK(uploads.uploads.size() == 3);
+
+    // at least one resource, even if it's larger than the budget
+    FakeUploads more_uploads;
+    GeometryPager large(8, PAGE_SIZE, more_uploads);
+    const auto id = add(large, 8);
+    large.request(id, 1.f, true);
+    CHECK(large.update(5));
+    CHECK(large.isResident(id));
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// evicted pages count, the second resource has to wait a frame
+bool evictionBudget()
+{
+    FakeUploads uploads;
+    GeometryPager pager(4, PAGE_SIZE, uploads);
+    const auto stale0 = add(pager, 2);
+    const auto stale1 = add(pager, 2);
+    CHECK(pager.load(stale0) && pager.load(stale1));
+    const auto id0 = add(pager, 2);
+    const auto id1 = add(pager, 2);
+    uploads.clear();
+
+    pager.request(id0, 1.f, true);
+    pager.request(id1, 2.f, true);
+    CHECK(pager.update(4));
+    CHECK((uploads.uploads == std::vector<Id>{id0}));
+    CHECK(uploads.evictions.size() == 1);
+
+    pager.request(id0, 1.f, true);
+    pager.request(id1, 2.f, true);
+    CHECK(pager.update(4));
+    CHECK(pager.isResident(id0) && pager.isResident(id1));
+    CHECK(uploads.evictions.size() == 2);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool invisibleUseFreePages()
+{
+    FakeUploads uploads;
+    GeometryPager pager(3, PAGE_SIZE, uploads);
+    const auto stale = add(pager, 2);
+    CHECK(pager.load(stale));
+    const auto hidden0 = add(pager, 2);
+    const auto hidden1 = add(pager, 1);
+    uploads.clear();
+
+    pager.request(hidden0, 1.f, false);
+    pager.request(hidden1, 2.f, false);
+    CHECK(pager.update(NO_BUDGET));
+    CHECK(!pager.isResident(hidden0) && pager.isResident(hidden1));
+    CHECK(pager.isResident(stale));
+    CHECK(uploads.evictions.empty());
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// pages: 0 visible, 1-4 stale, 5 visible, 6-9 stale
+bool fragmentation()
+{
+    FakeUploads uploads;
+    GeometryPager pager(10, PAGE_SIZE, uploads);
+    const auto visible0 = add(pager, 1);
+    const auto stale0 = add(pager, 4);
+    const auto visible1 = add(pager, 1);
+    const auto stale1 = add(pager, 4);
+    for (const auto id : {visible0, stale0, visible1, stale1}) {
+        CHECK(pager.load(id));
+    }
+    CHECK(pager.getFirstPage(visible0) == 0);
+    CHECK(pager.getFirstPage(stale0) == 1);
+    CHECK(pager.getFirstPage(visible1) == 5);
+    CHECK(pager.getFirstPage(stale1) == 6);
+    uploads.clear();
+
+    // no run of 6 pages without a visible resource, nothing is evicted
+    const auto large = add(pager, 6);
+    pager.request(visible0, 1.f, true);
+    pager.request(visible1, 1.f, true);
+    pager.request(large, 1.f, true);
+    CHECK(!pager.update(NO_BUDGET));
+    CHECK(!pager.isResident(large));
+    CHECK(pager.isResident(stale0) && pager.isResident(stale1));
+    CHECK(uploads.uploads.empty() && uploads.evictions.empty());
+
+    // with 5 out of view pages 1-9 are a run
+    pager.request(visible0, 1.f, true);
+    pager.request(large, 1.f, true);
+    CHECK(pager.update(NO_BUDGET));
+    CHECK(pager.isResident(large) && pager.isResident(visible0));
+    CHECK(uploads.evictions.size() == 3);
+    CHECK(pager.getFirstPage(large) == 1);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
+
+bool testGeometryPager()
+{
+    return uploadOrder() && leastRecentlyVisible() && budget() && evictionBudget() &&
+        invisibleUseFreePages() && fragmentation();
+}
+
+} // namespace test
@@ -0,0 +1,52 @@
+#include <iostream>
+#include <memory>
+
+#include "log/log.h"
+#include "log/ostream_sink.h"
+#include "log/relay.h"
+
+#include "tests.h"
+
+namespace test
+{
+
+//////////////////////////////////////////////////////////////////////////
+
+void fail(const char* file, const int line, const char* expr)
+{
+    std::cerr << file << ":" << line << ": CHECK(" << expr << ") failed" << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // namespace test
+
+int main()
+{
+    logging::Relay::initialize();
+    std::shared_ptr<logging::Sink> sink = std::make_shared<logging::OStreamSink>(std::cerr);
+    logging::Relay::get().registerSink(sink);
+
+    struct
+    {
+        const char* name;
+        bool (*run)();
+    } const tests[] = {
+        {"BufferAllocator", test::testBufferAllocator},
+        {"FrameRing", test::testFrameRing},
+        {"GeometryPager", test::testGeometryPager},
+        {"TransformStore", test::testTransformStore}
+    };
+
+    int num_failed = 0;
+    for (const auto& t : tests) {
+        const bool success = t.run();
+        std::cout << (success ? "passed: " : "FAILED: ") << t.name << std::endl;
+        if (!success)
+            ++num_failed;
+    }
+
+    logging::Relay::shutdown();
+
+    return num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#ifndef TEST_TESTS_H
+#define TEST_TESTS_H
+
+// Checks for the parts that don't need OpenGL, see main.cpp. A failed
+// CHECK() reports itself and returns false from the test.
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            ::test::fail(__FILE__, __LINE__, #expr); \
+            return false; \
+        } \
+    } while (false)
+
+namespace test
+{
+
+void fail(const char* file, int line, const char* expr);
+
+bool testBufferAllocator();
+bool testFrameRing();
+bool testGeometryPager();
+bool testTransformStore();
+
+} // namespace test
+
+#endif // TEST_TESTS_H
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "core/transform_store.h"
+#include "tests.h"
+
+namespace test
+{
+
+namespace
+{
+
+using core::AABB;
+using core::TransformId;
+using core::TransformStore;
+
+constexpr float EPSILON = 1e-4f;
+
+//////////////////////////////////////////////////////////////////////////
+
+bool near(const glm::vec3& a, const glm::vec3& b)
+{
+    const glm::vec3 d = glm::abs(a - b);
+    return d.x <= EPSILON * std::max(1.f, std::abs(b.x)) &&
+        d.y <= EPSILON * std::max(1.f, std::abs(b.y)) &&
+        d.z <= EPSILON * std::max(1.f, std::abs(b.z));
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool near(const glm::mat4& a, const glm::mat4& b)
+{
+    for (int c = 0; c < 4; ++c) {
+        if (!near(glm::vec3(a[c]), glm::vec3(b[c])) ||
+                std::abs(a[c][3] - b[c][3]) > EPSILON)
+            return false;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+glm::vec3 randomVec3(std::mt19937& rng, const float max)
+{
+    std::uniform_real_distribution<float> dist(-max, max);
+    return glm::vec3(dist(rng), dist(rng), dist(rng));
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// random position, orientation and scale (some negative)
+void randomize(TransformStore& store, const TransformId id, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    store.setPosition(id, randomVec3(rng, 10.f));
+    store.setOrientation(id, glm::normalize(glm::quat(dist(rng), dist(rng), dist(rng), dist(rng))));
+    store.setScale(id, randomVec3(rng, 3.f));
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// the world matrix is parent * local, the world bounds hold exactly the
+// eight transformed corners of the object bounds
+bool checkWorld(const TransformStore& store, const TransformId id, const glm::mat4& parent,
+        const AABB& bbox)
+{
+    const glm::mat4 world = parent * store.getLocalTransformation(id);
+    CHECK(near(store.getWorld(id), world));
+
+    AABB expected;
+    for (int corner = 0; corner < 8; ++corner) {
+        const glm::vec3 p((corner & 1) != 0 ? bbox.pmax.x : bbox.pmin.x,
+                (corner & 2) != 0 ? bbox.pmax.y : bbox.pmin.y,
+                (corner & 4) != 0 ? bbox.pmax.z : bbox.pmin.z);
+        expected.expandBy(glm::vec3(world * glm::vec4(p, 1.f)));
+    }
+    const AABB& bounds = store.getWorldBounds(id);
+    CHECK(near(bounds.pmin, expected.pmin));
+    CHECK(near(bounds.pmax, expected.pmax));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// object bounds of the ids, the store doesn't give them back
+struct Transforms
+{
+    TransformStore      store;
+    std::vector<AABB>   bounds;
+
+    void randomize(const TransformId id, std::mt19937& rng)
+    {
+        test::randomize(store, id, rng);
+        AABB bbox(randomVec3(rng, 10.f));
+        bbox.expandBy(randomVec3(rng, 10.f));
+        store.setBounds(id, bbox);
+        bounds.resize(std::max(bounds.size(), std::size_t(id) + 1));
+        bounds[id] = bbox;
+    }
+
+    TransformId add(std::mt19937& rng)
+    {
+        const TransformId id = store.add();
+        randomize(id, rng);
+        return id;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+bool composeAll(const std::size_t count)
+{
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(count));
+    Transforms t;
+    for (std::size_t i = 0; i < count; ++i) {
+        t.add(rng);
+    }
+    CHECK(t.store.size() == count);
+    t.store.composeAll();
+    for (TransformId id = 0; id < count; ++id) {
+        if (!checkWorld(t.store, id, glm::mat4(1.f), t.bounds[id]))
+            return false;
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// a shuffled subset, with a shared parent, their own parents and none
+bool composeParents(const std::size_t count)
+{
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(100 + count));
+    Transforms t;
+    std::vector<TransformId> ids;
+    for (std::size_t i = 0; i < 2 * count; ++i) {
+        ids.push_back(t.add(rng));
+    }
+    std::shuffle(ids.begin(), ids.end(), rng);
+    ids.resize(count);
+
+    TransformStore parent_store;
+    std::vector<glm::mat4> own_parents(count);
+    for (auto& parent : own_parents) {
+        const TransformId id = parent_store.add();
+        randomize(parent_store, id, rng);
+        parent = parent_store.getLocalTransformation(id);
+    }
+    const glm::mat4 shared = own_parents[0];
+
+    const glm::mat4 identity(1.f);
+    std::vector<const glm::mat4*> parents(count);
+    for (int round = 0; round < 3; ++round) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (round == 0)
+                parents[i] = &shared;
+            else if (round == 1)
+                parents[i] = &own_parents[i];
+            else
+                parents[i] = i % 3 == 0 ? nullptr : &own_parents[i];
+        }
+        t.store.compose(ids.data(), count, parents.data());
+        for (std::size_t i = 0; i < count; ++i) {
+            const glm::mat4& parent = parents[i] != nullptr ? *parents[i] : identity;
+            if (!checkWorld(t.store, ids[i], parent, t.bounds[ids[i]]))
+                return false;
+        }
+    }
+
+    // without parents
+    t.store.compose(ids.data(), count);
+    for (const auto id : ids) {
+        if (!checkWorld(t.store, id, identity, t.bounds[id]))
+            return false;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// removed ids come back with the defaults and compose like new ones
+bool reuse()
+{
+    std::mt19937 rng(7);
+    Transforms t;
+    for (int i = 0; i < 6; ++i) {
+        t.add(rng);
+    }
+    t.store.remove(1);
+    t.store.remove(4);
+    const TransformId id0 = t.store.add();
+    CHECK(id0 == 4);
+    CHECK(t.store.getPosition(id0) == glm::vec3(0.f));
+    CHECK(t.store.getScale(id0) == glm::vec3(1.f));
+    CHECK(t.store.getOrientation(id0) == glm::quat(1.f, 0.f, 0.f, 0.f));
+    CHECK(t.store.getWorld(id0) == glm::mat4(1.f));
+
+    t.randomize(id0, rng);
+    const TransformId id1 = t.add(rng);
+    CHECK(id1 == 1);
+    CHECK(t.store.size() == 6);
+
+    t.store.composeAll();
+    for (TransformId id = 0; id < 6; ++id) {
+        if (!checkWorld(t.store, id, glm::mat4(1.f), t.bounds[id]))
+            return false;
+    }
+    const TransformId ids[] = {id1, id0, 5};
+    const glm::mat4 parent = t.store.getLocalTransformation(0);
+    const glm::mat4* const parents[] = {&parent, &parent, nullptr};
+    t.store.compose(ids, 3, parents);
+    CHECK(checkWorld(t.store, id1, parent, t.bounds[id1]));
+    CHECK(checkWorld(t.store, id0, parent, t.bounds[id0]));
+    CHECK(checkWorld(t.store, 5, glm::mat4(1.f), t.bounds[5]));
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
+
+bool testTransformStore()
+{
+    for (const std::size_t count : {1, 3, 4, 5, 7, 13}) {
+        if (!composeAll(count) || !composeParents(count))
+            return false;
+    }
+    return reuse();
+}
+
+} // namespace test
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <sys/stat.h>
+
+#include "hash.h"
+
+/***************************************************************************/
+
+namespace
+{
+
+constexpr std::uint64_t PRIME1 = 11400714785074694791ull;
+constexpr std::uint64_t PRIME2 = 14029467366897019727ull;
+constexpr std::uint64_t PRIME3 = 1609587929392839161ull;
+constexpr std::uint64_t PRIME4 = 9650029242287828579ull;
+constexpr std::uint64_t PRIME5 = 2870177450012600261ull;
+
+/***************************************************************************/
+
+inline std::uint64_t rotl(const std::uint64_t x, const int r) noexcept
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+/***************************************************************************/
+
+inline std::uint64_t read64(const unsigned char* p) noexcept
+{
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/***************************************************************************/
+
+inline std::uint32_t read32(const unsigned char* p) noexcept
+{
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/***************************************************************************/
+
+inline std::uint64_t round(const std::uint64_t acc, const std::uint64_t input) noexcept
+{
+    return rotl(acc + input * PRIME2, 31) * PRIME1;
+}
+
+/***************************************************************************/
+
+inline std::uint64_t mergeRound(const std::uint64_t acc, const std::uint64_t val) noexcept
+{
+    return (acc ^ round(0, val)) * PRIME1 + PRIME4;
+}
+
+/***************************************************************************/
+
+// consumes all complete 32 byte stripes, returns the number of bytes used
+std::size_t consume(std::uint64_t* const acc, const unsigned char* p,
+        const std::size_t size) noexcept
+{
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        acc[0] = round(acc[0], read64(p + i));
+        acc[1] = round(acc[1], read64(p + i + 8));
+        acc[2] = round(acc[2], read64(p + i + 16));
+        acc[3] = round(acc[3], read64(p + i + 24));
+    }
+    return i;
+}
+
+} // anonymous namespace
+
+/***************************************************************************/
+
+namespace util
+{
+
+/***************************************************************************/
+
+Hasher::Hasher(const std::uint64_t seed) noexcept
+  : m_acc{seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1},
+    m_buffered{0},
+    m_total{0},
+    m_seed{seed}
+{
+}
+
+/***************************************************************************/
+
+void Hasher::update(const void* const data, std::size_t size) noexcept
+{
+    const auto* p = static_cast<const unsigned char*>(data);
+    m_total += size;
+
+    if (m_buffered > 0) {
+        const std::size_t n = std::min(size, sizeof(m_buffer) - m_buffered);
+        std::memcpy(m_buffer + m_buffered, p, n);
+        m_buffered += n;
+        p += n;
+        size -= n;
+        if (m_buffered < sizeof(m_buffer))
+            return;
+        consume(m_acc, m_buffer, sizeof(m_buffer));
+        m_buffered = 0;
+    }
+
+    const std::size_t used = consume(m_acc, p, size);
+    if (used < size) {
+        std::memcpy(m_buffer, p + used, size - used);
+        m_buffered = size - used;
+    }
+}
+
+/***************************************************************************/
+
+void Hasher::update(const std::string& s) noexcept
+{
+    const std::uint64_t length = s.size();
+    update(&length, sizeof(length));
+    update(s.data(), s.size());
+}
+
+/***************************************************************************/
+
+std::uint64_t Hasher::digest() const noexcept
+{
+    std::uint64_t h;
+    if (m_total >= 32) {
+        h = rotl(m_acc[0], 1) + rotl(m_acc[1], 7) + rotl(m_acc[2], 12) + rotl(m_acc[3], 18);
+        for (int i = 0; i < 4; ++i) {
+            h = mergeRound(h, m_acc[i]);
+        }
+    } else {
+        h = m_seed + PRIME5;
+    }
+    h += m_total;
+
+    const unsigned char* p = m_buffer;
+    const unsigned char* const end = m_buffer + m_buffered;
+    for (; p + 8 <= end; p += 8) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * PRIME1 + PRIME4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<std::uint64_t>(read32(p)) * PRIME1;
+        h = rotl(h, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= static_cast<std::uint64_t>(*p) * PRIME5;
+        h = rotl(h, 11) * PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+/***************************************************************************/
+
+std::uint64_t hash64(const void* const data, const std::size_t size,
+        const std::uint64_t seed) noexcept
+{
+    Hasher hasher(seed);
+    hasher.update(data, size);
+    return hasher.digest();
+}
+
+/***************************************************************************/
+
+bool hashFile(const std::string& filename, Hasher& hasher)
+{
+    std::ifstream is(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!is)
+        return false;
+
+    std::vector<char> buffer(1024 * 1024);
+    while (is) {
+        is.read(buffer.data(), static_cast<long>(buffer.size()));
+        hasher.update(buffer.data(), static_cast<std::size_t>(is.gcount()));
+    }
+    return is.eof();
+}
+
+/***************************************************************************/
+
+bool hashFileStamp(const std::string& filename, Hasher& hasher)
+{
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0)
+        return false;
+    hasher.update(static_cast<std::int64_t>(st.st_size));
+    hasher.update(static_cast<std::int64_t>(st.st_mtim.tv_sec));
+    hasher.update(static_cast<std::int64_t>(st.st_mtim.tv_nsec));
+    return true;
+}
+
+/***************************************************************************/
+
+} // namespace util
@@ -0,0 +1,54 @@
+#ifndef UTIL_HASH_H
+#define UTIL_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace util
+{
+
+/*
+ * 64 bit non-cryptographic hash (XXH64). Unlike std::hash, the result only
+ * depends on the bytes, so it can be stored in files and compared across
+ * builds and machines.
+ */
+class Hasher
+{
+public:
+    explicit Hasher(std::uint64_t seed = 0) noexcept;
+
+    void update(const void* data, std::size_t size) noexcept;
+
+    // length prefixed, so that consecutive strings can't run into each other
+    void update(const std::string& s) noexcept;
+
+    template <typename T>
+    void update(const T& value) noexcept
+    {
+        static_assert(std::is_pod<T>::value, "only plain data can be hashed");
+        update(&value, sizeof(T));
+    }
+
+    std::uint64_t digest() const noexcept;
+
+private:
+    std::uint64_t   m_acc[4];
+    unsigned char   m_buffer[32];
+    std::size_t     m_buffered;
+    std::uint64_t   m_total;
+    std::uint64_t   m_seed;
+};
+
+std::uint64_t hash64(const void* data, std::size_t size, std::uint64_t seed = 0) noexcept;
+
+// adds the contents of the file, false if it can't be read
+bool hashFile(const std::string& filename, Hasher& hasher);
+
+// adds the size and modification time of the file, false if it doesn't exist
+bool hashFileStamp(const std::string& filename, Hasher& hasher);
+
+} // namespace util
+
+#endif // UTIL_HASH_H
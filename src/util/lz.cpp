@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "lz.h"
+
+/***************************************************************************/
+
+namespace
+{
+
+constexpr std::size_t MIN_MATCH = 4;
+constexpr std::size_t MAX_OFFSET = 65535;
+
+// the decoder relies on the last sequence being literals only
+constexpr std::size_t LAST_LITERALS = 5;
+constexpr std::size_t MATCH_LIMIT = 12;
+
+constexpr int HASH_BITS = 16;
+
+/***************************************************************************/
+
+inline std::uint32_t read32(const unsigned char* p) noexcept
+{
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/***************************************************************************/
+
+inline std::uint32_t hash(const std::uint32_t v) noexcept
+{
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/***************************************************************************/
+
+inline unsigned char* writeLength(unsigned char* op, std::size_t length) noexcept
+{
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<unsigned char>(length);
+    return op;
+}
+
+/***************************************************************************/
+
+unsigned char* writeSequence(unsigned char* op, const unsigned char* literals,
+        const std::size_t num_literals, const std::size_t offset,
+        const std::size_t match_length) noexcept
+{
+    unsigned char* token = op++;
+    *token = static_cast<unsigned char>(std::min<std::size_t>(num_literals, 15) << 4);
+    if (num_literals >= 15)
+        op = writeLength(op, num_literals - 15);
+    if (num_literals > 0)
+        std::memcpy(op, literals, num_literals);
+    op += num_literals;
+
+    if (match_length == 0)
+        return op;
+
+    *op++ = static_cast<unsigned char>(offset & 0xFF);
+    *op++ = static_cast<unsigned char>(offset >> 8);
+    const std::size_t length = match_length - MIN_MATCH;
+    *token = static_cast<unsigned char>(*token | std::min<std::size_t>(length, 15));
+    if (length >= 15)
+        op = writeLength(op, length - 15);
+    return op;
+}
+
+/***************************************************************************/
+
+inline bool readLength(const unsigned char*& ip, const unsigned char* const iend,
+        std::size_t& length) noexcept
+{
+    unsigned char b;
+    do {
+        if (ip == iend)
+            return false;
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+} // anonymous namespace
+
+/***************************************************************************/
+
+namespace util
+{
+
+/***************************************************************************/
+
+std::size_t lzCompressBound(const std::size_t size) noexcept
+{
+    return size + size / 255 + 16;
+}
+
+/***************************************************************************/
+
+std::size_t lzCompress(const char* const src, const std::size_t size, char* const dst)
+{
+    const auto* const base = reinterpret_cast<const unsigned char*>(src);
+    auto* op = reinterpret_cast<unsigned char*>(dst);
+
+    std::size_t anchor = 0;
+    if (size > MATCH_LIMIT) {
+        // positions + 1, 0 is empty
+        std::vector<std::uint32_t> table(std::size_t(1) << HASH_BITS, 0);
+        const std::size_t match_limit = size - MATCH_LIMIT;
+        const std::size_t end_of_match = size - LAST_LITERALS;
+
+        std::size_t ip = 0;
+        while (ip < match_limit) {
+            const std::uint32_t v = read32(base + ip);
+            auto& entry = table[hash(v)];
+            const std::size_t candidate = entry;
+            entry = static_cast<std::uint32_t>(ip + 1);
+
+            if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET ||
+                    read32(base + candidate - 1) != v) {
+                // skip faster through data that doesn't compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            const std::size_t match = candidate - 1;
+            std::size_t length = MIN_MATCH;
+            while (ip + length < end_of_match && base[match + length] == base[ip + length])
+                ++length;
+
+            op = writeSequence(op, base + anchor, ip - anchor, ip - match, length);
+            ip += length;
+            anchor = ip;
+            if (ip < match_limit) {
+                table[hash(read32(base + ip - 2))] = static_cast<std::uint32_t>(ip - 1);
+            }
+        }
+    }
+    op = writeSequence(op, base + anchor, size - anchor, 0, 0);
+
+    return static_cast<std::size_t>(op - reinterpret_cast<unsigned char*>(dst));
+}
+
+/***************************************************************************/
+
+bool lzDecompress(const char* const src, const std::size_t src_size, char* const dst,
+        const std::size_t dst_size) noexcept
+{
+    const auto* ip = reinterpret_cast<const unsigned char*>(src);
+    const auto* const iend = ip + src_size;
+    auto* const obegin = reinterpret_cast<unsigned char*>(dst);
+    auto* op = obegin;
+    auto* const oend = op + dst_size;
+
+    while (ip != iend) {
+        const unsigned char token = *ip++;
+
+        std::size_t num_literals = token >> 4;
+        if (num_literals == 15 && !readLength(ip, iend, num_literals))
+            return false;
+        if (num_literals > static_cast<std::size_t>(iend - ip) ||
+                num_literals > static_cast<std::size_t>(oend - op))
+            return false;
+        if (num_literals > 0)
+            std::memcpy(op, ip, num_literals);
+        ip += num_literals;
+        op += num_literals;
+
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return false;
+        const std::size_t offset = static_cast<std::size_t>(ip[0]) |
+            static_cast<std::size_t>(ip[1]) << 8;
+        ip += 2;
+        if (offset == 0 || offset > static_cast<std::size_t>(op - obegin))
+            return false;
+
+        std::size_t length = token & 15;
+        if (length == 15 && !readLength(ip, iend, length))
+            return false;
+        length += MIN_MATCH;
+        if (length > static_cast<std::size_t>(oend - op))
+            return false;
+
+        const unsigned char* match = op - offset;
+        if (offset >= length) {
+            std::memcpy(op, match, length);
+            op += length;
+        } else {
+            // overlapping, repeats the last 'offset' bytes
+            for (std::size_t i = 0; i < length; ++i)
+                *op++ = *match++;
+        }
+    }
+
+    return op == oend;
+}
+
+/***************************************************************************/
+
+} // namespace util
@@ -0,0 +1,36 @@
+#ifndef UTIL_LZ_H
+#define UTIL_LZ_H
+
+#include <cstddef>
+
+namespace util
+{
+
+/*
+ * Byte oriented LZ77 codec in the spirit of LZ4: a stream of sequences,
+ * each one a run of literals followed by a match of at least 4 bytes
+ * within the last 64 KiB. Trades ratio for decoding speed; blocks are
+ * independent, so large buffers can be split and decoded in parallel.
+ *
+ *   token           literal length (high nibble), match length - 4 (low nibble)
+ *   [255...]        extra literal length, if the nibble is 15
+ *   literals
+ *   offset          little endian uint16
+ *   [255...]        extra match length, if the nibble is 15
+ *
+ * The last sequence has no match.
+ */
+
+// worst case size of the compressed block
+std::size_t lzCompressBound(std::size_t size) noexcept;
+
+// returns the compressed size, 'dst' must hold lzCompressBound(size) bytes
+std::size_t lzCompress(const char* src, std::size_t size, char* dst);
+
+// false if 'src' is corrupt or doesn't decompress to exactly 'dst_size' bytes
+bool lzDecompress(const char* src, std::size_t src_size, char* dst,
+        std::size_t dst_size) noexcept;
+
+} // namespace util
+
+#endif // UTIL_LZ_H
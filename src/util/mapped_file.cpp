@@ -0,0 +1,180 @@
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+
+/***************************************************************************/
+
+namespace
+{
+
+int toMadvise(const util::MappedFile::Advice advice) noexcept
+{
+    switch (advice) {
+    case util::MappedFile::Advice::Sequential:
+        return MADV_SEQUENTIAL;
+    case util::MappedFile::Advice::Random:
+        return MADV_RANDOM;
+    case util::MappedFile::Advice::WillNeed:
+        return MADV_WILLNEED;
+    case util::MappedFile::Advice::DontNeed:
+        return MADV_DONTNEED;
+    case util::MappedFile::Advice::Normal:
+    default:
+        return MADV_NORMAL;
+    }
+}
+
+} // anonymous namespace
+
+/***************************************************************************/
+
+namespace util
+{
+
+/***************************************************************************/
+
+MappedFile::MappedFile() noexcept
+  : m_data{nullptr},
+    m_size{0}
+{
+}
+
+/***************************************************************************/
+
+MappedFile::MappedFile(const std::string& filename, const bool copy_on_write)
+  : m_data{nullptr},
+    m_size{0}
+{
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        const auto size = static_cast<std::size_t>(st.st_size);
+        const int prot = copy_on_write ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* ptr = ::mmap(nullptr, size, prot, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED) {
+            m_data = ptr;
+            m_size = size;
+        }
+    }
+    // the mapping stays valid after closing the descriptor
+    ::close(fd);
+}
+
+/***************************************************************************/
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+  : m_data{other.m_data},
+    m_size{other.m_size}
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+}
+
+/***************************************************************************/
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr) {
+        ::munmap(m_data, m_size);
+        m_data = nullptr;
+    }
+}
+
+/***************************************************************************/
+
+MappedFile& MappedFile::operator=(MappedFile&& other) & noexcept
+{
+    swap(other);
+    return *this;
+}
+
+/***************************************************************************/
+
+void MappedFile::swap(MappedFile& other) noexcept
+{
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+}
+
+/***************************************************************************/
+
+MappedFile::operator bool() const noexcept
+{
+    return m_data != nullptr;
+}
+
+/***************************************************************************/
+
+bool MappedFile::operator!() const noexcept
+{
+    return m_data == nullptr;
+}
+
+/***************************************************************************/
+
+char* MappedFile::data() noexcept
+{
+    return static_cast<char*>(m_data);
+}
+
+/***************************************************************************/
+
+const char* MappedFile::data() const noexcept
+{
+    return static_cast<const char*>(m_data);
+}
+
+/***************************************************************************/
+
+std::size_t MappedFile::size() const noexcept
+{
+    return m_size;
+}
+
+/***************************************************************************/
+
+void MappedFile::advise(const Advice advice) const noexcept
+{
+    advise(0, m_size, advice);
+}
+
+/***************************************************************************/
+
+void MappedFile::advise(std::size_t offset, std::size_t length,
+        const Advice advice) const noexcept
+{
+    if (m_data == nullptr || offset >= m_size)
+        return;
+
+    // madvise wants a page aligned address
+    const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t aligned = offset - (offset % page_size);
+    length += offset - aligned;
+    if (aligned + length > m_size)
+        length = m_size - aligned;
+
+    ::madvise(static_cast<char*>(m_data) + aligned, length, toMadvise(advice));
+}
+
+/***************************************************************************/
+
+void dropFromPageCache(const std::string& filename) noexcept
+{
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+/***************************************************************************/
+
+} // namespace util
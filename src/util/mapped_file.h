@@ -0,0 +1,67 @@
+#ifndef UTIL_MAPPED_FILE_H
+#define UTIL_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace util
+{
+
+/*
+ * Read-only view of a file, backed by the page cache. With
+ * 'copy_on_write' the mapping can be written to; modified pages
+ * become private to this process and are never written back.
+ */
+class MappedFile
+{
+public:
+    enum class Advice
+    {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed,
+        DontNeed
+    };
+
+    MappedFile() noexcept;
+
+    explicit MappedFile(const std::string& filename, bool copy_on_write = false);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+
+    ~MappedFile();
+
+    MappedFile& operator=(MappedFile&& other) & noexcept;
+
+    void swap(MappedFile& other) noexcept;
+
+    explicit operator bool() const noexcept;
+
+    bool operator!() const noexcept;
+
+    char* data() noexcept;
+
+    const char* data() const noexcept;
+
+    std::size_t size() const noexcept;
+
+    void advise(Advice advice) const noexcept;
+
+    void advise(std::size_t offset, std::size_t length, Advice advice) const noexcept;
+
+private:
+    void*           m_data;
+    std::size_t     m_size;
+};
+
+// Evicts the (clean) pages of a file from the page cache, so that the next
+// read comes from the disk. For measuring cold loads.
+void dropFromPageCache(const std::string& filename) noexcept;
+
+} // namespace util
+
+#endif // UTIL_MAPPED_FILE_H
@@ -0,0 +1,101 @@
+#include <algorithm>
+
+#include "thread_pool.h"
+
+namespace util
+{
+
+/***************************************************************************/
+
+ThreadPool::ThreadPool(unsigned int num_threads)
+  : m_stop{false}
+{
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    m_threads.reserve(num_threads);
+    for (unsigned int i = 0; i < num_threads; ++i) {
+        m_threads.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+/***************************************************************************/
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+/***************************************************************************/
+
+unsigned int ThreadPool::size() const noexcept
+{
+    return static_cast<unsigned int>(m_threads.size());
+}
+
+/***************************************************************************/
+
+void ThreadPool::run()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] () { return m_stop || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
+
+/***************************************************************************/
+
+MemoryBudget::MemoryBudget(const std::size_t capacity)
+  : m_capacity{capacity},
+    m_used{0}
+{
+}
+
+/***************************************************************************/
+
+void MemoryBudget::acquire(const std::size_t bytes)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this, bytes] ()
+            {
+                return m_used == 0 || m_used + bytes <= m_capacity;
+            });
+    m_used += bytes;
+}
+
+/***************************************************************************/
+
+void MemoryBudget::release(const std::size_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_used -= bytes;
+    }
+    m_cond.notify_all();
+}
+
+/***************************************************************************/
+
+std::size_t MemoryBudget::capacity() const noexcept
+{
+    return m_capacity;
+}
+
+/***************************************************************************/
+
+} // namespace util
@@ -0,0 +1,77 @@
+#ifndef UTIL_THREAD_POOL_H
+#define UTIL_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace util
+{
+
+class ThreadPool
+{
+public:
+    // 0 threads: one per hardware thread
+    explicit ThreadPool(unsigned int num_threads = 0);
+
+    // finishes all queued tasks
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    std::future<typename std::result_of<F()>::type> submit(F&& func)
+    {
+        using R = typename std::result_of<F()>::type;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(func));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.emplace([task] () { (*task)(); });
+        }
+        m_cond.notify_one();
+        return result;
+    }
+
+    unsigned int size() const noexcept;
+
+private:
+    void run();
+
+    std::vector<std::thread>            m_threads;
+    std::queue<std::function<void()>>   m_tasks;
+    std::mutex                          m_mutex;
+    std::condition_variable             m_cond;
+    bool                                m_stop;
+};
+
+/****************************************************************************/
+
+// Limits the amount of memory used by concurrent tasks. A request larger
+// than the whole budget is granted once nothing else is reserved.
+class MemoryBudget
+{
+public:
+    explicit MemoryBudget(std::size_t capacity);
+
+    void acquire(std::size_t bytes);
+    void release(std::size_t bytes);
+
+    std::size_t capacity() const noexcept;
+
+private:
+    std::size_t                 m_capacity;
+    std::size_t                 m_used;
+    std::mutex                  m_mutex;
+    std::condition_variable     m_cond;
+};
+
+} // namespace util
+
+#endif // UTIL_THREAD_POOL_H